@@ -0,0 +1,552 @@
+"""
+################################################################################
+#                                   LICENSE                                    #
+################################################################################
+#   This file is part of barnsley_fern.                                        #
+#                                                                              #
+#   barnsley_fern is free software: you can redistribute it and/or modify it   #
+#   under the terms of the GNU General Public License as published by          #
+#   the Free Software Foundation, either version 3 of the License, or          #
+#   (at your option) any later version.                                        #
+#                                                                              #
+#   barnsley_fern is distributed in the hope that it will be useful,           #
+#   but WITHOUT ANY WARRANTY; without even the implied warranty of             #
+#   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the              #
+#   GNU General Public License for more details.                               #
+#                                                                              #
+#   You should have received a copy of the GNU General Public License          #
+#   along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.    #
+################################################################################
+#   Purpose:                                                                   #
+#       Builds every implementation with the toolchains that are installed,    #
+#       times them, checks that they all draw the same fern, and prints the    #
+#       results as the table in README.md. Usage:                              #
+#           python3 benchmark.py [--runs N] [--warmup N] [--update-readme]     #
+################################################################################
+#   Author:     Ryan Maguire                                                   #
+#   Date:       October 18, 2026.                                              #
+################################################################################
+"""
+
+# Command line options.
+import argparse
+
+# Saving the results for later comparison.
+import json
+
+# Paths, environment variables, and the machine description.
+import os
+import platform
+
+# Finding compilers and interpreters, and making scratch directories.
+import shutil
+import tempfile
+
+# Summaries of the timings.
+import statistics
+
+# Running the builds and the programs.
+import subprocess
+import sys
+
+# Timing the runs, and time stamps for the JSON records.
+import time
+
+# Location of this file, the root of the repository.
+ROOT = os.path.dirname(os.path.abspath(__file__))
+
+# Every implementation draws this file in its working directory.
+OUTPUT = "barnsley_fern.ppm"
+
+# Largest mean absolute difference, per channel out of 255, allowed between
+# the reference image and an image drawn with a different random generator.
+TOLERANCE = 4.0
+
+# The C sources, the C++ sources, and the Go sources.
+C_MAIN = os.path.join(ROOT, "c", "barnsley_fern.c")
+CPP_MAIN = os.path.join(ROOT, "cpp", "barnsley_fern.cpp")
+GO_FILES = [
+    os.path.join(ROOT, "go", name) for name in (
+        "bf.go", "bf_color.go", "bf_fern.go", "bf_ppm.go", "bf_setup.go",
+        "barnsley_fern.go"
+    )
+]
+
+# The implementations, in the order of the README table. "build" is a list
+# of arguments with {exe} standing for the output file, or None for the
+# interpreted ones. "view" groups the programs that frame the fern the same
+# way, the C code places it a little higher (y shift 0.94 instead of 1.0),
+# and only images in the same group are compared. "rng" groups the programs
+# that use the same generator with the same seed, these must draw
+# byte-for-byte identical images.
+IMPLEMENTATIONS = [
+    {
+        "language": "C", "implementation": "gcc", "tool": "gcc",
+        "build": ["gcc", "-O3", C_MAIN, "-o", "{exe}", "-lm"],
+        "version": ["gcc", "--version"], "view": "c", "rng": "libc"
+    },
+    {
+        "language": "C", "implementation": "clang", "tool": "clang",
+        "build": ["clang", "-O3", C_MAIN, "-o", "{exe}", "-lm"],
+        "version": ["clang", "--version"], "view": "c", "rng": "libc"
+    },
+    {
+        "language": "C++", "implementation": "g++", "tool": "g++",
+        "build": ["g++", "-O3", "-pthread", CPP_MAIN, "-o", "{exe}"],
+        "version": ["g++", "--version"], "view": "common",
+        "rng": "libc"
+    },
+    {
+        "language": "C++", "implementation": "clang++", "tool": "clang++",
+        "build": ["clang++", "-O3", "-pthread", CPP_MAIN, "-o", "{exe}"],
+        "version": ["clang++", "--version"], "view": "common",
+        "rng": "libc"
+    },
+    {
+        "language": "C", "implementation": "pcc", "tool": "pcc",
+        "build": ["pcc", "-O", C_MAIN, "-o", "{exe}", "-lm"],
+        "version": ["pcc", "--version"], "view": "c", "rng": "libc"
+    },
+    {
+        "language": "C", "implementation": "tcc", "tool": "tcc",
+        "build": ["tcc", C_MAIN, "-o", "{exe}", "-lm"],
+        "version": ["tcc", "-v"], "view": "c", "rng": "libc"
+    },
+    {
+        "language": "Python", "implementation": "Pypy", "tool": "pypy3",
+        "build": None,
+        "run": ["pypy3", os.path.join(ROOT, "python", "barnsley_fern.py")],
+        "version": ["pypy3", "--version"], "view": "common", "rng": None
+    },
+    {
+        "language": "Go", "implementation": "golang", "tool": "go",
+        "build": ["go", "build", "-o", "{exe}"] + GO_FILES,
+        "version": ["go", "version"], "view": "common", "rng": None
+    },
+    {
+        "language": "Go", "implementation": "gccgo", "tool": "gccgo",
+        "build": ["gccgo", "-O3"] + GO_FILES + ["-o", "{exe}"],
+        "version": ["gccgo", "--version"], "view": "common", "rng": None
+    },
+    {
+        "language": "Python", "implementation": "CPython", "tool": "python3",
+        "build": None,
+        "run": ["python3", os.path.join(ROOT, "python", "barnsley_fern.py")],
+        "version": ["python3", "--version"], "view": "common",
+        "rng": None
+    }
+]
+
+def first_line(command):
+    """
+        Function:
+            first_line
+        Purpose:
+            Runs a command and returns the first non-empty line it prints,
+            used for the version strings.
+        Arguments:
+            command (list):
+                The command and its arguments.
+        Outputs:
+            line (str):
+                The line, or "unknown" if the command failed.
+    """
+
+    try:
+        result = subprocess.run(
+            command, stdout = subprocess.PIPE, stderr = subprocess.STDOUT,
+            universal_newlines = True, check = False
+        )
+
+    except OSError:
+        return "unknown"
+
+    for line in result.stdout.splitlines():
+        if line.strip():
+            return line.strip()
+
+    return "unknown"
+
+def machine():
+    """
+        Function:
+            machine
+        Purpose:
+            Describes the CPU and operating system, for the README.
+        Arguments:
+            None.
+        Outputs:
+            description (str):
+                For example "AMD Ryzen 9 7950X 16-Core Processor on Debian
+                GNU/Linux 12 (bookworm)".
+    """
+
+    cpu = platform.processor() or platform.machine()
+    system = platform.system()
+
+    # On Linux the processor string is not very useful, use /proc instead.
+    try:
+        with open("/proc/cpuinfo") as cpuinfo:
+            for line in cpuinfo:
+                if line.startswith("model name"):
+                    cpu = line.split(":", 1)[1].strip()
+                    break
+
+    except OSError:
+        pass
+
+    try:
+        with open("/etc/os-release") as release:
+            for line in release:
+                if line.startswith("PRETTY_NAME="):
+                    system = line.split("=", 1)[1].strip().strip('"')
+                    break
+
+    except OSError:
+        pass
+
+    return "%s on %s" % (cpu, system)
+
+def read_ppm(name):
+    """
+        Function:
+            read_ppm
+        Purpose:
+            Reads a P3 (text) or P6 (binary) PPM file with a maximum of 255.
+        Arguments:
+            name (str):
+                The file name.
+        Outputs:
+            image (tuple):
+                The width, the height, and the pixel values as bytes.
+    """
+
+    with open(name, "rb") as ppm_file:
+        data = ppm_file.read()
+
+    # The header is four tokens, the magic number, width, height, and max.
+    tokens = []
+    index = 0
+
+    while len(tokens) < 4:
+        while data[index:index + 1].isspace():
+            index += 1
+
+        start = index
+
+        while not data[index:index + 1].isspace():
+            index += 1
+
+        tokens.append(data[start:index])
+
+    width, height = int(tokens[1]), int(tokens[2])
+
+    # P6 has exactly one whitespace character between the header and data.
+    if tokens[0] == b"P6":
+        pixels = data[index + 1:index + 1 + 3*width*height]
+    else:
+        pixels = bytes(int(value) for value in data[index:].split())
+
+    return width, height, pixels
+
+def compare(reference, name):
+    """
+        Function:
+            compare
+        Purpose:
+            Measures how far an image is from the reference image.
+        Arguments:
+            reference (tuple):
+                The reference image, as returned by read_ppm.
+            name (str):
+                The file name of the other image.
+        Outputs:
+            difference (float):
+                The mean absolute difference per channel, 0 for identical
+                images and infinity if the sizes differ.
+    """
+
+    width, height, pixels = read_ppm(name)
+
+    if (width, height) != reference[:2] or len(pixels) != len(reference[2]):
+        return float("inf")
+
+    if pixels == reference[2]:
+        return 0.0
+
+    total = sum(abs(a - b) for a, b in zip(pixels, reference[2]))
+    return total / len(pixels)
+
+def benchmark(entry, args, scratch):
+    """
+        Function:
+            benchmark
+        Purpose:
+            Builds one implementation, then times it.
+        Arguments:
+            entry (dict):
+                The implementation, from IMPLEMENTATIONS.
+            args (argparse.Namespace):
+                The command line options.
+            scratch (str):
+                A directory for the executables and the output images.
+        Outputs:
+            result (dict):
+                The timings, or None if the implementation was skipped.
+    """
+
+    name = "%s (%s)" % (entry["language"], entry["implementation"])
+
+    if shutil.which(entry["tool"]) is None:
+        print("Skipping %s, %s was not found." % (name, entry["tool"]),
+              file = sys.stderr)
+        return None
+
+    # Each implementation gets its own directory for its image.
+    work = os.path.join(scratch, entry["implementation"])
+    os.makedirs(work)
+
+    if entry["build"] is None:
+        command = entry["run"]
+    else:
+        exe = os.path.join(work, "main")
+        build = [arg.replace("{exe}", exe) for arg in entry["build"]]
+        result = subprocess.run(build, cwd = work, check = False)
+
+        if result.returncode != 0:
+            print("Skipping %s, the build failed." % name, file = sys.stderr)
+            return None
+
+        command = [exe]
+
+    times = []
+
+    for run in range(args.warmup + args.runs):
+        start = time.perf_counter()
+        result = subprocess.run(command, cwd = work, check = False)
+        elapsed = time.perf_counter() - start
+
+        if result.returncode != 0:
+            print("Skipping %s, it exited with %d." % (name, result.returncode),
+                  file = sys.stderr)
+            return None
+
+        # The first few runs warm the caches and are not counted.
+        if run >= args.warmup:
+            times.append(elapsed)
+
+    median = statistics.median(times)
+
+    return {
+        "language": entry["language"],
+        "implementation": entry["implementation"],
+        "version": first_line(entry["version"]),
+        "view": entry["view"],
+        "rng": entry["rng"],
+        "times": times,
+        "median": median,
+        "min": min(times),
+        "max": max(times),
+        "mad": statistics.median(abs(t - median) for t in times),
+        "image": os.path.join(work, OUTPUT)
+    }
+
+def check_images(results):
+    """
+        Function:
+            check_images
+        Purpose:
+            Compares every image with the first one of the same view.
+            Programs sharing a random number generator must match exactly,
+            the others only have to be close, since the points are different
+            but the fern is the same.
+        Arguments:
+            results (list):
+                The results from benchmark, updated with "match" entries.
+        Outputs:
+            success (bool):
+                True if every image passed.
+    """
+
+    success = True
+    references = {}
+
+    for result in results:
+
+        # The first image of each view is the reference for the others.
+        if result["view"] not in references:
+            references[result["view"]] = (read_ppm(result["image"]), result)
+
+        reference, first = references[result["view"]]
+        difference = compare(reference, result["image"])
+        exact = (result["rng"] is not None and result["rng"] == first["rng"])
+
+        if difference == 0.0:
+            result["match"] = "identical"
+        elif not exact and difference <= TOLERANCE:
+            result["match"] = "close (%.3f)" % difference
+        else:
+            result["match"] = "MISMATCH (%.3f)" % difference
+            success = False
+
+    return success
+
+def table(results):
+    """
+        Function:
+            table
+        Purpose:
+            Formats the results as the markdown table in README.md.
+        Arguments:
+            results (list):
+                The results from benchmark.
+        Outputs:
+            text (str):
+                The table, fastest first.
+    """
+
+    rows = [("Language", "Implementation", "Time (s)", "Spread (s)", "Version")]
+
+    for result in sorted(results, key = lambda r: r["median"]):
+        rows.append((
+            result["language"], result["implementation"],
+            "%.3f" % result["median"], "%.3f" % result["mad"],
+            result["version"]
+        ))
+
+    widths = [max(len(row[n]) for row in rows) for n in range(len(rows[0]))]
+    lines = []
+
+    for index, row in enumerate(rows):
+        cells = []
+
+        for n, cell in enumerate(row):
+
+            # Numbers are right aligned, everything else left aligned.
+            if index > 0 and n in (2, 3):
+                cells.append(cell.rjust(widths[n]))
+            else:
+                cells.append(cell.ljust(widths[n]))
+
+        lines.append("| " + " | ".join(cells) + " |")
+
+        if index == 0:
+            lines.append("| " + " | ".join("-"*w for w in widths) + " |")
+
+    return "\n".join(lines) + "\n"
+
+def update_readme(text):
+    """
+        Function:
+            update_readme
+        Purpose:
+            Replaces the Benchmarks section of README.md.
+        Arguments:
+            text (str):
+                The new body of the section.
+        Outputs:
+            None.
+    """
+
+    name = os.path.join(ROOT, "README.md")
+
+    with open(name) as readme:
+        contents = readme.read()
+
+    start = contents.index("# Benchmarks")
+    start = contents.index("\n", start) + 1
+    end = contents.index("\n# ", start) + 1
+
+    with open(name, "w") as readme:
+        readme.write(contents[:start] + text + contents[end:])
+
+def main():
+    """
+        Function:
+            main
+        Purpose:
+            Parses the command line and runs the benchmarks.
+        Arguments:
+            None.
+        Outputs:
+            status (int):
+                Zero on success, one if an image did not match.
+    """
+
+    parser = argparse.ArgumentParser(description = __doc__.split("Usage")[0])
+    parser.add_argument("--runs", type = int, default = 5,
+                        help = "timed runs per implementation")
+    parser.add_argument("--warmup", type = int, default = 1,
+                        help = "untimed runs before the timed ones")
+    parser.add_argument("--only", nargs = "+", metavar = "NAME",
+                        help = "implementations to run, like gcc or CPython")
+    parser.add_argument("--json", default = "benchmarks.jsonl",
+                        help = "file the results are appended to, one line "
+                               "per run of this script")
+    parser.add_argument("--update-readme", action = "store_true",
+                        help = "replace the table in README.md")
+    args = parser.parse_args()
+
+    entries = [
+        entry for entry in IMPLEMENTATIONS
+        if args.only is None or entry["implementation"] in args.only
+    ]
+
+    scratch = tempfile.mkdtemp(prefix = "barnsley_fern_")
+
+    try:
+        results = []
+
+        for entry in entries:
+            result = benchmark(entry, args, scratch)
+
+            if result is not None:
+                results.append(result)
+
+        if not results:
+            print("Nothing was benchmarked.", file = sys.stderr)
+            return 1
+
+        success = check_images(results)
+
+    finally:
+        shutil.rmtree(scratch, ignore_errors = True)
+
+    host = machine()
+    text = (
+        "These benchmarks were run on %s.\n"
+        "Times are the median of %d runs after %d warm-up run(s), and the "
+        "spread is\nthe median absolute deviation. Regenerate this table "
+        "with\n`python3 benchmark.py --update-readme`.\n\n"
+        % (host, args.runs, args.warmup)
+    ) + table(results) + "\n"
+
+    print(text, end = "")
+
+    for result in results:
+        print("%-10s %s" % (result["implementation"], result["match"]))
+        del result["image"]
+
+    record = {
+        "time": time.strftime("%Y-%m-%dT%H:%M:%S%z"),
+        "machine": host,
+        "runs": args.runs,
+        "warmup": args.warmup,
+        "results": results
+    }
+
+    with open(args.json, "a") as history:
+        history.write(json.dumps(record) + "\n")
+
+    if not success:
+        print("Some images did not match, README.md was not updated.",
+              file = sys.stderr)
+        return 1
+
+    if args.update_readme:
+        update_readme(text)
+
+    return 0
+
+if __name__ == "__main__":
+    sys.exit(main())
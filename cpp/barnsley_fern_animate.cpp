@@ -0,0 +1,69 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Animates the Barnsley fern as its growth factor sweeps from 0.7 to 0.9.   *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  atof, atoi, and atol given here.                                          */
+#include <cstdlib>
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Function for animating the Barnsley Fern.                                 *
+ *  Usage:                                                                    *
+ *      barnsley_fern_animate [frames] [pattern] [points per pixel] [decay]   *
+ *  The pattern is a printf-style file name, "frame_%05u.png" by default,     *
+ *  with exactly one %u conversion and no other.                              *
+ *  A pattern of "-" streams PPM frames to stdout instead, for example:       *
+ *      barnsley_fern_animate 240 - | ffmpeg -f image2pipe -i - fern.mp4      *
+ *  Giving a decay, say 0.75, carries the points and a fraction of the image  *
+ *  over from one frame to the next. Quick previews can then use far fewer    *
+ *  points per pixel, like 4 instead of 16.                                   */
+int main(int argc, char **argv)
+{
+    const unsigned int frames = (argc > 1 ? std::atoi(argv[1]) : 120U);
+    const char *pattern = (argc > 2 ? argv[2] : "frame_%05u.png");
+    const long points = (argc > 3 ? std::atol(argv[3]) : 16L);
+    const double decay = (argc > 4 ? std::atof(argv[4]) : 0.0);
+
+    bf::animation anim(bf::ifs::barnsley(0.7), bf::ifs::barnsley(0.9), frames);
+    bool success;
+
+    if (decay > 0.0 && decay < 1.0)
+    {
+        anim.coherent = true;
+        anim.decay = decay;
+    }
+
+    if (points > 0L)
+        anim.iterations = static_cast<std::uint64_t>(points) *
+                          anim.v.number_of_pixels();
+
+    if (pattern[0] == '-' && pattern[1] == '\0')
+        success = bf::animate_stream(bf::colorer::greenscale, anim, 1,
+                                     bf::stream::ppm);
+    else
+        success = bf::animate(bf::colorer::greenscale, anim, pattern);
+
+    return (success ? 0 : 1);
+}
+/*  End of main.                                                              */
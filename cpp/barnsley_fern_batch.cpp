@@ -0,0 +1,80 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Renders every job in a manifest, sharing histograms between jobs.         *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  std::fprintf given here.                                                  */
+#include <cstdio>
+
+/*  std::atoi given here.                                                     */
+#include <cstdlib>
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Function for rendering a batch of ferns.                                  *
+ *  Usage:                                                                    *
+ *      barnsley_fern_batch [manifest] [threads] [strategy]                   *
+ *  The manifest defaults to stdin, see bf_batch.hpp for the format. Zero     *
+ *  threads, the default, uses all of them. The strategy is auto, private,    *
+ *  shared, or cached, see bf_shared.hpp.                                     */
+int main(int argc, char **argv)
+{
+    const char *name = (argc > 1 ? argv[1] : "-");
+    const int threads = (argc > 2 ? std::atoi(argv[2]) : 0);
+    bf::histogram_strategy strategy = bf::strategy_auto;
+    bf::batch jobs;
+    bf::stopwatch timer;
+    std::size_t failures;
+
+    if (threads < 0)
+    {
+        std::fprintf(stderr, "ERROR: the number of threads is negative.\n");
+        return 1;
+    }
+
+    if (argc > 3 && !bf::parse_strategy(argv[3], strategy))
+    {
+        std::fprintf(stderr, "ERROR: unknown strategy %s.\n", argv[3]);
+        return 1;
+    }
+
+    if (!jobs.load(name))
+        return 1;
+
+    failures = jobs.run(static_cast<unsigned int>(threads), strategy);
+
+    std::fprintf(stderr, "%lu jobs from %lu histograms in %.3f seconds.\n",
+                 static_cast<unsigned long>(jobs.number_of_jobs()),
+                 static_cast<unsigned long>(jobs.groups.size()),
+                 timer.lap());
+
+    if (failures > 0U)
+    {
+        std::fprintf(stderr, "ERROR: %lu jobs failed.\n",
+                     static_cast<unsigned long>(failures));
+        return 1;
+    }
+
+    return 0;
+}
+/*  End of main.                                                              */
@@ -0,0 +1,464 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Microbenchmarks for the stages of the renderer.                           *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  atoi given here.                                                          */
+#include <cstdlib>
+
+/*  std::remove, for deleting the PPM files the write benchmarks make.        */
+#include <cstdio>
+
+/*  Standard engines, compared against std::rand and bf::rng.                 */
+#include <random>
+
+/*  std::vector for the buffers.                                              */
+#include <vector>
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Timing harness and JSON output.                                           */
+#include "bf/bf_bench.hpp"
+
+/*  Number of points computed by one call of the create_fern benchmarks.      */
+static const unsigned int points_per_call = 1U << 20;
+
+/*  Wraps a <random> engine so that create_fern can use it.                   */
+template <typename Tengine>
+struct std_engine {
+    Tengine engine;
+    std::uniform_real_distribution<double> distribution;
+
+    std_engine(void) : engine(1U), distribution(0.0, 100.0)
+    {
+        return;
+    }
+
+    inline double percent(void)
+    {
+        return distribution(engine);
+    }
+};
+
+/*  Times create_fern on the generic IFS code with a given generator.         */
+template <typename Trng>
+static bf::bench::result
+bench_create_fern(const char *name, Trng &gen, const bf::bench::options &opts)
+{
+    const bf::ifs fern = bf::ifs::barnsley();
+    const bf::view v;
+    std::vector<std::uint32_t> counts(v.number_of_pixels());
+    double x_val = fern.xstart;
+    double y_val = fern.ystart;
+
+    return bf::bench::measure(name, "point", points_per_call, [&](void)
+    {
+        bf::create_fern(&counts[0], fern, v, points_per_call,
+                        x_val, y_val, gen);
+        bf::bench::keep(counts[0]);
+    }, opts);
+}
+
+/*  Times the chaos game with the point in Tpoint and pixels in Tpixel.       */
+template <typename Tpoint, typename Tpixel>
+static bf::bench::result
+bench_precision(const char *name, const bf::bench::options &opts)
+{
+    const bf::ifs fern = bf::ifs::barnsley();
+    const bf::view v;
+    std::vector<std::uint32_t> counts(v.number_of_pixels());
+    bf::plain_counter counter(&counts[0]);
+    bf::rng gen(1U);
+    Tpoint x_val = static_cast<Tpoint>(fern.xstart);
+    Tpoint y_val = static_cast<Tpoint>(fern.ystart);
+
+    return bf::bench::measure(name, "point", points_per_call, [&](void)
+    {
+        bf::count_points_real<Tpoint, Tpixel>(counter, fern, v,
+                                              points_per_call,
+                                              x_val, y_val, gen);
+        bf::bench::keep(counts[0]);
+    }, opts);
+}
+
+/*  Times the chaos game in fixed-point pixel coordinates.                    */
+static bf::bench::result
+bench_fixed(const char *name, const bf::bench::options &opts)
+{
+    const bf::ifs fern = bf::ifs::barnsley();
+    const bf::view v;
+    std::vector<std::uint32_t> counts(v.number_of_pixels());
+    bf::plain_counter counter(&counts[0]);
+    bf::rng gen(1U);
+    double x_val = fern.xstart;
+    double y_val = fern.ystart;
+
+    return bf::bench::measure(name, "point", points_per_call, [&](void)
+    {
+        bf::count_points_fixed(counter, fern, v, points_per_call,
+                               x_val, y_val, gen);
+        bf::bench::keep(counts[0]);
+    }, opts);
+}
+
+/*  Times the chaos game drawing a word of maps per random number.            */
+static bf::bench::result
+bench_composed(const char *name, const bf::bench::options &opts)
+{
+    const bf::ifs fern = bf::ifs::barnsley();
+    const bf::view v;
+    const bf::composed_ifs words(fern, bf::composed_length(fern));
+    std::vector<std::uint32_t> counts(v.number_of_pixels());
+    bf::plain_counter counter(&counts[0]);
+    bf::rng gen(1U);
+    double x_val = fern.xstart;
+    double y_val = fern.ystart;
+
+    return bf::bench::measure(name, "point", points_per_call, [&](void)
+    {
+        bf::count_points_composed(counter, words, v, points_per_call,
+                                  x_val, y_val, gen);
+        bf::bench::keep(counts[0]);
+    }, opts);
+}
+
+/*  Times the chaos game picking maps from slices of a random number.         */
+static bf::bench::result
+bench_sliced(const char *name, unsigned int bits,
+             const bf::bench::options &opts)
+{
+    const bf::ifs fern = bf::ifs::barnsley();
+    const bf::view v;
+    const bf::sliced_ifs maps(fern, bits);
+    std::vector<std::uint32_t> counts(v.number_of_pixels());
+    bf::plain_counter counter(&counts[0]);
+    bf::rng gen(1U);
+    double x_val = fern.xstart;
+    double y_val = fern.ystart;
+
+    return bf::bench::measure(name, "point", points_per_call, [&](void)
+    {
+        bf::count_points_sliced(counter, maps, v, points_per_call,
+                                x_val, y_val, gen);
+        bf::bench::keep(counts[0]);
+    }, opts);
+}
+
+/*  Times the chaos game counting through one of the shared counters.         */
+template <typename Tcounter>
+static bf::bench::result
+bench_counter(const char *name, const bf::bench::options &opts)
+{
+    const bf::ifs fern = bf::ifs::barnsley();
+    const bf::view v;
+    std::vector<std::uint32_t> counts(v.number_of_pixels());
+    Tcounter counter(&counts[0]);
+    bf::rng gen(1U);
+    bf::no_probe probe;
+    double x_val = fern.xstart;
+    double y_val = fern.ystart;
+
+    return bf::bench::measure(name, "point", points_per_call, [&](void)
+    {
+        bf::count_points(counter, fern, v, points_per_call,
+                         x_val, y_val, gen, probe);
+        counter.flush();
+        bf::bench::keep(counts[0]);
+    }, opts);
+}
+
+/*  Times scattering precomputed pixel indices into a square histogram.       */
+static bf::bench::result
+bench_scatter(unsigned int size, const std::vector<double> &points,
+              const bf::bench::options &opts)
+{
+    const bf::view v(size, size);
+    std::vector<std::uint32_t> counts(v.number_of_pixels());
+    std::vector<std::size_t> indices;
+    std::size_t n, index;
+    char name[64];
+
+    /*  Turn the points into indices first, so only the scatter is timed.     */
+    for (n = 0U; n < points.size(); n += 2U)
+        if (v.point_to_pixel(points[n], points[n + 1U], index))
+            indices.push_back(index);
+
+    std::sprintf(name, "scatter/%ux%u", size, size);
+
+    return bf::bench::measure(name, "point",
+                              static_cast<double>(indices.size()), [&](void)
+    {
+        std::size_t k;
+
+        for (k = 0U; k < indices.size(); ++k)
+            ++counts[indices[k]];
+
+        bf::bench::keep(counts[0]);
+    }, opts);
+}
+
+/*  Times a colorer on values spread over [0, 1].                             */
+template <typename Tcolorer>
+static bf::bench::result
+bench_colorer(const char *name, Tcolorer color,
+              const std::vector<double> &values,
+              const bf::bench::options &opts)
+{
+    std::vector<unsigned char> rgb(3U * values.size());
+
+    return bf::bench::measure(name, "pixel",
+                              static_cast<double>(values.size()), [&](void)
+    {
+        std::size_t n;
+
+        for (n = 0U; n < values.size(); ++n)
+        {
+            const bf::color c = color(values[n]);
+            rgb[3U*n] = c.red;
+            rgb[3U*n + 1U] = c.green;
+            rgb[3U*n + 2U] = c.blue;
+        }
+
+        bf::bench::keep(rgb[0]);
+    }, opts);
+}
+
+/*  Benchmarks every stage of the renderer.                                   *
+ *  Usage:                                                                    *
+ *      barnsley_fern_bench [json file] [repetitions]                         *
+ *  The table goes to stdout, the JSON to barnsley_fern_bench.json unless     *
+ *  another name is given. "-" writes the JSON to stdout instead.             */
+int main(int argc, char **argv)
+{
+    const char *json_name = (argc > 1 ? argv[1] : "barnsley_fern_bench.json");
+    const char *ppm_name = "barnsley_fern_bench.ppm";
+    const unsigned int xsize = bf::setup::xsize;
+    const unsigned int ysize = bf::setup::ysize;
+    const std::size_t pixels = bf::setup::number_of_pixels;
+
+    bf::bench::options opts;
+    std::vector<bf::bench::result> results;
+    std::vector<double> points, values;
+    std::vector<unsigned char> rgb(3U * pixels);
+    std::FILE *fp;
+    std::size_t n;
+
+    if (argc > 2 && std::atoi(argv[2]) > 0)
+        opts.repetitions = static_cast<unsigned int>(std::atoi(argv[2]));
+
+    /*  A sample of points on the attractor, in the order the chaos game      *
+     *  visits them, so memory access patterns are realistic.                 */
+    {
+        const bf::ifs fern = bf::ifs::barnsley();
+        bf::rng gen(1U);
+        double x_val = fern.xstart, y_val = fern.ystart;
+
+        for (n = 0U; n < (1U << 22); ++n)
+        {
+            fern.transform[fern.select(gen.percent())].transform(x_val, y_val);
+            points.push_back(x_val);
+            points.push_back(y_val);
+        }
+    }
+
+    /*  The hand-written loop that bf::run uses, with std::rand.              */
+    {
+        std::vector<double> data(pixels);
+        double x_val = bf::setup::xstart, y_val = bf::setup::ystart;
+
+        results.push_back(bf::bench::measure(
+            "create_fern/setup/stdlib", "point", points_per_call, [&](void)
+            {
+                bf::create_fern(&data[0], points_per_call, x_val, y_val);
+                bf::bench::keep(data[0]);
+            }, opts
+        ));
+    }
+
+    /*  The generic IFS loop, with each of the generators.                    */
+    {
+        const bf::ifs fern = bf::ifs::barnsley();
+        const bf::view v;
+        std::vector<std::uint32_t> counts(v.number_of_pixels());
+        double x_val = fern.xstart, y_val = fern.ystart;
+
+        results.push_back(bf::bench::measure(
+            "create_fern/ifs/stdlib", "point", points_per_call, [&](void)
+            {
+                bf::create_fern(&counts[0], fern, v, points_per_call,
+                                x_val, y_val);
+                bf::bench::keep(counts[0]);
+            }, opts
+        ));
+    }
+
+    {
+        bf::rng xoshiro(1U);
+        std_engine<std::minstd_rand> minstd;
+        std_engine<std::mt19937> mt32;
+        std_engine<std::mt19937_64> mt64;
+
+        results.push_back(
+            bench_create_fern("create_fern/ifs/xoshiro256", xoshiro, opts)
+        );
+
+        results.push_back(
+            bench_create_fern("create_fern/ifs/minstd_rand", minstd, opts)
+        );
+
+        results.push_back(
+            bench_create_fern("create_fern/ifs/mt19937", mt32, opts)
+        );
+
+        results.push_back(
+            bench_create_fern("create_fern/ifs/mt19937_64", mt64, opts)
+        );
+    }
+
+    /*  The same loop with the point in single, mixed, and fixed precision.   */
+    results.push_back(
+        bench_precision<float, float>("create_fern/float", opts)
+    );
+
+    results.push_back(
+        bench_precision<float, double>("create_fern/mixed", opts)
+    );
+
+    results.push_back(bench_fixed("create_fern/fixed", opts));
+
+    /*  Fewer random numbers: several maps per draw, from an alias table.     */
+    results.push_back(bench_composed("create_fern/composed", opts));
+    results.push_back(bench_sliced("create_fern/sliced8", 8U, opts));
+    results.push_back(bench_sliced("create_fern/sliced16", 16U, opts));
+
+    /*  One thread's cost of counting into a histogram shared by threads.     */
+    results.push_back(
+        bench_counter<bf::atomic_counter>("count/shared", opts)
+    );
+
+    results.push_back(
+        bench_counter<bf::cached_counter>("count/cached", opts)
+    );
+
+    /*  Point to pixel, the unchecked version in setup and bf::view's.        */
+    {
+        const bf::view v;
+        const double count = static_cast<double>(points.size() / 2U);
+
+        results.push_back(bf::bench::measure(
+            "point_to_pixel/setup", "point", count, [&](void)
+            {
+                unsigned int sum = 0U;
+
+                for (n = 0U; n < points.size(); n += 2U)
+                    sum += bf::setup::point_to_pixel(points[n],
+                                                     points[n + 1U]);
+
+                bf::bench::keep(sum);
+            }, opts
+        ));
+
+        results.push_back(bf::bench::measure(
+            "point_to_pixel/view", "point", count, [&](void)
+            {
+                std::size_t sum = 0U, index = 0U;
+
+                for (n = 0U; n < points.size(); n += 2U)
+                    if (v.point_to_pixel(points[n], points[n + 1U], index))
+                        sum += index;
+
+                bf::bench::keep(sum);
+            }, opts
+        ));
+    }
+
+    /*  Scatter into histograms from cache-sized to far larger than cache.    */
+    results.push_back(bench_scatter(256U, points, opts));
+    results.push_back(bench_scatter(1024U, points, opts));
+    results.push_back(bench_scatter(4096U, points, opts));
+
+    /*  Colorers, on an even spread of inputs like a real image has.          */
+    for (n = 0U; n < pixels; ++n)
+        values.push_back(static_cast<double>(n) / static_cast<double>(pixels));
+
+    results.push_back(
+        bench_colorer("colorer/grayscale", bf::colorer::grayscale, values, opts)
+    );
+
+    results.push_back(
+        bench_colorer("colorer/greenscale", bf::colorer::greenscale, values,
+                      opts)
+    );
+
+    /*  PPM output, both the per-pixel writes bf::run does and one fwrite.    */
+    for (n = 0U; n < rgb.size(); ++n)
+        rgb[n] = static_cast<unsigned char>(n * 2654435761U >> 24);
+
+    results.push_back(bf::bench::measure(
+        "ppm/write_pixels", "byte", static_cast<double>(rgb.size()), [&](void)
+        {
+            struct bf::ppm PPM = bf::ppm(ppm_name);
+            std::size_t k;
+
+            PPM.init(xsize, ysize, 6);
+
+            for (k = 0U; k < pixels; ++k)
+                bf::color(rgb[3U*k], rgb[3U*k + 1U], rgb[3U*k + 2U]).write(PPM);
+
+            PPM.close();
+        }, opts
+    ));
+
+    results.push_back(bf::bench::measure(
+        "ppm/write_buffer", "byte", static_cast<double>(rgb.size()), [&](void)
+        {
+            struct bf::ppm PPM = bf::ppm(ppm_name);
+            PPM.write(&rgb[0], xsize, ysize);
+            PPM.close();
+        }, opts
+    ));
+
+    std::remove(ppm_name);
+
+    bf::bench::print(stdout, results);
+
+    if (json_name[0] == '-' && json_name[1] == '\0')
+        bf::bench::write_json(stdout, results, opts);
+
+    else
+    {
+        fp = std::fopen(json_name, "w");
+
+        if (!fp)
+        {
+            std::puts("ERROR: Could not open the JSON file.");
+            return 1;
+        }
+
+        bf::bench::write_json(fp, results, opts);
+        std::fclose(fp);
+    }
+
+    return 0;
+}
+/*  End of main.                                                              */
@@ -0,0 +1,131 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Sends a request to barnsley_fern_server and saves the reply.              *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  std::fprintf, std::fopen, and std::fwrite given here.                     */
+#include <cstdio>
+
+/*  std::strlen and std::memcpy given here.                                   */
+#include <cstring>
+
+/*  std::string, the request.                                                 */
+#include <string>
+
+/*  socket, connect, and the sockaddr_un struct.                              */
+#include <sys/socket.h>
+#include <sys/un.h>
+
+/*  read, write, and close.                                                   */
+#include <unistd.h>
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Function for requesting a render from the server.                         *
+ *  Usage:                                                                    *
+ *      barnsley_fern_client socket request [output file]                     *
+ *  The request is a line like "growth=0.85 color=greenscale format=png",     *
+ *  or "quit" to stop the server. The file is written to the output, or       *
+ *  to stdout if none is given, and the status line goes to stderr.           */
+int main(int argc, char **argv)
+{
+    struct sockaddr_un address;
+    std::string request;
+    std::FILE *out;
+    char buffer[65536];
+    char status[256];
+    std::size_t length = 0U;
+    ssize_t got;
+    int fd;
+
+    if (argc < 3)
+    {
+        std::fprintf(stderr, "Usage: %s socket request [output]\n", argv[0]);
+        return 1;
+    }
+
+    if (std::strlen(argv[1]) >= sizeof(address.sun_path))
+    {
+        std::fprintf(stderr, "ERROR: socket path is too long.\n");
+        return 1;
+    }
+
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, argv[1], std::strlen(argv[1]) + 1U);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd < 0 || connect(fd, reinterpret_cast<struct sockaddr *>(&address),
+                          sizeof(address)) != 0)
+    {
+        std::perror("ERROR: connect");
+        return 1;
+    }
+
+    request = std::string(argv[2]) + "\n";
+
+    if (!bf::write_all(fd, request.data(), request.size()))
+    {
+        std::fprintf(stderr, "ERROR: could not send the request.\n");
+        close(fd);
+        return 1;
+    }
+
+    /*  The status line, one byte at a time so no file data is read.          */
+    while (length + 1U < sizeof(status))
+    {
+        if (read(fd, status + length, 1U) <= 0 || status[length] == '\n')
+            break;
+
+        ++length;
+    }
+
+    status[length] = '\0';
+    std::fprintf(stderr, "%s\n", status);
+
+    if (std::strncmp(status, "OK", 2U) != 0)
+    {
+        close(fd);
+        return 1;
+    }
+
+    out = (argc > 3 ? std::fopen(argv[3], "wb") : stdout);
+
+    if (!out)
+    {
+        std::perror("ERROR: fopen");
+        close(fd);
+        return 1;
+    }
+
+    while ((got = read(fd, buffer, sizeof(buffer))) > 0)
+        std::fwrite(buffer, 1U, static_cast<std::size_t>(got), out);
+
+    if (out != stdout)
+        std::fclose(out);
+
+    close(fd);
+    return 0;
+}
+/*  End of main.                                                              */
@@ -0,0 +1,58 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Draws the Barnsley fern from few points, smoothed by density estimation.  *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  std::fprintf given here.                                                  */
+#include <cstdio>
+
+/*  std::atoi given here.                                                     */
+#include <cstdlib>
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Function for drawing the fern smoothed by density estimation.             *
+ *  Usage:                                                                    *
+ *      barnsley_fern_estimate [points] [name]                                *
+ *  points is the number of points per pixel, 8 by default. Sparse parts of   *
+ *  the fern are blurred and dense parts are kept sharp, so a few points per  *
+ *  pixel give an image close to that of barnsley_fern. The image goes to     *
+ *  name, barnsley_fern_estimate.ppm by default, or PNG if it ends in .png.   */
+int main(int argc, char **argv)
+{
+    const int points = (argc > 1 ? std::atoi(argv[1]) : 8);
+    const char *name = (argc > 2 ? argv[2] : "barnsley_fern_estimate.ppm");
+
+    if (points <= 0)
+    {
+        std::fprintf(stderr, "ERROR: the points per pixel must be positive.\n");
+        return 1;
+    }
+
+    if (!bf::run_estimated(bf::colorer::grayscale, name,
+                           static_cast<unsigned int>(points)))
+        return 1;
+
+    return 0;
+}
+/*  End of main.                                                              */
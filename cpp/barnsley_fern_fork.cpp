@@ -0,0 +1,56 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Renders the fern with forked worker processes and shared memory.          *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  std::fprintf given here.                                                  */
+#include <cstdio>
+
+/*  std::atoi given here.                                                     */
+#include <cstdlib>
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Function for rendering the fern with worker processes.                    *
+ *  Usage:                                                                    *
+ *      barnsley_fern_fork [workers] [name]                                   *
+ *  Zero workers, the default, uses one per hardware thread. The file name    *
+ *  defaults to barnsley_fern_fork.ppm, see save_image for other formats.     */
+int main(int argc, char **argv)
+{
+    const int workers = (argc > 1 ? std::atoi(argv[1]) : 0);
+    const char *name = (argc > 2 ? argv[2] : "barnsley_fern_fork.ppm");
+
+    if (workers < 0)
+    {
+        std::fprintf(stderr, "ERROR: the number of workers is negative.\n");
+        return 1;
+    }
+
+    if (!bf::run_processes(bf::colorer::grayscale, name,
+                           static_cast<unsigned int>(workers)))
+        return 1;
+
+    return 0;
+}
+/*  End of main.                                                              */
@@ -0,0 +1,53 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Tone maps a saved histogram by log-density and writes a float PFM.        *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Function for tone mapping a histogram from barnsley_fern_histogram.       *
+ *  Usage:                                                                    *
+ *      barnsley_fern_hdr [histogram] [exposure] [gamma]                      *
+ *  The exposure is in stops and defaults to 0, the gamma defaults to 0.4.    */
+int main(int argc, char **argv)
+{
+    const char *name = (argc > 1 ? argv[1] : "barnsley_fern.hist");
+    bf::log_density params;
+    bf::histogram hist;
+    bool success;
+
+    if (argc > 2)
+        params.exposure = std::atof(argv[2]);
+
+    if (argc > 3)
+        params.gamma = std::atof(argv[3]);
+
+    if (!hist.load(name))
+        return 1;
+
+    success = bf::recolor(bf::colorer::greenscale, hist, params,
+                          "barnsley_fern_hdr.ppm");
+    success = bf::save_density(hist, "barnsley_fern.pfm") && success;
+    return (success ? 0 : 1);
+}
+/*  End of main.                                                              */
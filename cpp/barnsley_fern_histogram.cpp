@@ -0,0 +1,52 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Renders a Barnley fern once and saves the histogram of hits.              *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Function for rendering the Barnsley Fern to a histogram file. Color it    *
+ *  with barnsley_fern_recolor, as many times as desired. Optional arguments  *
+ *  are the seed and the output file name, so that several renders can be     *
+ *  run with different seeds and combined with barnsley_fern_merge.           */
+int main(int argc, char **argv)
+{
+    /*  Same number of points as bf::run, and seed 1 by default.              */
+    const unsigned long seed =
+        (argc > 1 ? std::strtoul(argv[1], NULL, 10) : 1UL);
+
+    const char *name = (argc > 2 ? argv[2] : "barnsley_fern.hist");
+
+    bf::histogram hist(bf::ifs::barnsley(), bf::view());
+
+    hist.render(bf::setup::total, seed);
+
+    if (!hist.save(name))
+    {
+        std::printf("ERROR: could not write %s.\n", name);
+        return 1;
+    }
+
+    return 0;
+}
+/*  End of main.                                                              */
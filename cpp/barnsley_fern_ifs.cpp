@@ -0,0 +1,65 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Renders an iterated function system read from a text file.                *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  std::printf given here.                                                   */
+#include <cstdio>
+
+/*  std::strtoull given here.                                                 */
+#include <cstdlib>
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Function for drawing a fern defined in a file.                            *
+ *  Usage:                                                                    *
+ *      barnsley_fern_ifs file [name] [seed]                                  *
+ *  The file has the maps, size, frame, points per pixel, and colorer, see    *
+ *  bf_definition.hpp, and "-" reads it from stdin. The image is written to   *
+ *  name, barnsley_fern_ifs.ppm by default, or PNG if it ends in .png.        */
+int main(int argc, char **argv)
+{
+    const char *name = (argc > 2 ? argv[2] : "barnsley_fern_ifs.ppm");
+    const std::uint64_t seed = (argc > 3 ? std::strtoull(argv[3], NULL, 10)
+                                         : 1U);
+    bf::ifs_definition def;
+
+    if (argc < 2)
+    {
+        std::fprintf(stderr, "Usage: %s file [name] [seed]\n", argv[0]);
+        return 1;
+    }
+
+    if (!def.load(argv[1]))
+        return 1;
+
+    std::printf("%u maps, %ux%u, %.0f points.\n", def.fern.number_of_maps,
+                def.v.xsize, def.v.ysize,
+                static_cast<double>(def.iterations()));
+
+    if (!bf::run_definition(def, name, seed))
+        return 1;
+
+    return 0;
+}
+/*  End of main.                                                              */
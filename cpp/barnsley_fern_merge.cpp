@@ -0,0 +1,47 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Sums histogram files from several renders into one.                       *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Function for merging histograms. Usage:                                   *
+ *      barnsley_fern_merge out.hist in_1.hist in_2.hist ...                  */
+int main(int argc, char **argv)
+{
+    /*  Number of input files, everything after the output name.              */
+    const unsigned int count =
+        (argc > 2 ? static_cast<unsigned int>(argc - 2) : 0U);
+
+    if (count == 0U)
+    {
+        std::puts("Usage: barnsley_fern_merge out.hist in.hist [in.hist ...]");
+        return 1;
+    }
+
+    if (!bf::merge_files(argv + 2, count, argv[1]))
+        return 1;
+
+    return 0;
+}
+/*  End of main.                                                              */
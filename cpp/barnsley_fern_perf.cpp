@@ -0,0 +1,45 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Creates a Barnsley fern and reports hardware counters for each stage.     *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Function for drawing the Barnsley Fern with hardware counters.            *
+ *  Usage:                                                                    *
+ *      barnsley_fern_perf [file name]                                        *
+ *  The counters go to stderr, the image to barnsley_fern.ppm by default.     *
+ *  Linux only, and perf_event_paranoid must be at most 2.                    */
+int main(int argc, char **argv)
+{
+    const char *name = (argc > 1 ? argv[1] : "barnsley_fern.ppm");
+    const bf::view v;
+    bf::render_stats stats;
+    bf::perf_profile profile;
+    bool success;
+
+    success = bf::run(bf::colorer::grayscale, name, stats, &profile);
+    profile.report(stderr, stats.iterations, v.number_of_pixels());
+    return (success ? 0 : 1);
+}
+/*  End of main.                                                              */
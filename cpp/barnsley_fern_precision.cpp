@@ -0,0 +1,93 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Checks the float, mixed, and fixed-point kernels against the double one.  *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  std::printf given here.                                                   */
+#include <cstdio>
+
+/*  std::atoi and std::strtod given here.                                     */
+#include <cstdlib>
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Prints how a lower precision kernel compares with the double one.         */
+static void
+print_report(const char *name, const bf::precision_report &report)
+{
+    std::printf("%-6s %lu pixels differ, by at most %u, %lu points moved.\n"
+                "       %lu colors differ, by at most %u levels: %s.\n", name,
+                static_cast<unsigned long>(report.pixels_differing),
+                report.max_difference,
+                static_cast<unsigned long>(report.total_difference / 2U),
+                static_cast<unsigned long>(report.colors_differing),
+                report.max_color_difference,
+                report.indistinguishable() ? "indistinguishable" :
+                                             "use double");
+}
+
+/*  Function for checking whether float is accurate enough.                   *
+ *  Usage:                                                                    *
+ *      barnsley_fern_precision [size] [points] [seed]                        *
+ *  Renders a size x size fern, 1024 by default, with the given number of     *
+ *  points per pixel, 64 by default, with the double kernel and with the      *
+ *  float, mixed, and fixed-point ones, and says whether the images differ.   */
+int main(int argc, char **argv)
+{
+    const int size = (argc > 1 ? std::atoi(argv[1]) : 1024);
+    const double points = (argc > 2 ? std::strtod(argv[2], NULL) : 64.0);
+    const int seed = (argc > 3 ? std::atoi(argv[3]) : 1);
+    const unsigned int side = static_cast<unsigned int>(size > 0 ? size : 1);
+    const bf::view v(side, side);
+    const bf::ifs fern = bf::ifs::barnsley();
+    std::uint64_t iterations;
+    double scale_factor;
+
+    if (size <= 0 || !(points > 0.0))
+    {
+        std::fprintf(stderr, "ERROR: the size and points must be positive.\n");
+        return 1;
+    }
+
+    iterations = static_cast<std::uint64_t>(
+        points * static_cast<double>(v.number_of_pixels())
+    );
+
+    scale_factor = static_cast<double>(bf::setup::max_iters) / (256.0 * points);
+
+    print_report("float", bf::validate_precision<float, float>(
+        fern, v, iterations, static_cast<std::uint64_t>(seed), scale_factor
+    ));
+
+    print_report("mixed", bf::validate_precision<float, double>(
+        fern, v, iterations, static_cast<std::uint64_t>(seed), scale_factor
+    ));
+
+    print_report("fixed", bf::validate_kernel(
+        bf::fixed_kernel(), fern, v, iterations,
+        static_cast<std::uint64_t>(seed), scale_factor
+    ));
+
+    return 0;
+}
+/*  End of main.                                                              */
@@ -0,0 +1,42 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Colors a saved histogram without running the chaos game again.            *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Function for coloring the histogram from barnsley_fern_histogram.         */
+int main(void)
+{
+    bf::histogram hist;
+    bool success;
+
+    if (!hist.load("barnsley_fern.hist"))
+        return 1;
+
+    success = bf::recolor(bf::colorer::grayscale, hist, "barnsley_fern.ppm");
+    success = bf::recolor(bf::colorer::greenscale, hist,
+                          "barnsley_fern_green.ppm") && success;
+    return (success ? 0 : 1);
+}
+/*  End of main.                                                              */
@@ -0,0 +1,64 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Serves renders over a Unix domain socket, caching the results on disk.    *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  std::atoi given here.                                                     */
+#include <cstdlib>
+
+/*  mkdir, for creating the cache directory.                                  */
+#include <sys/stat.h>
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Function for running the render server.                                   *
+ *  Usage:                                                                    *
+ *      barnsley_fern_server [socket] [cache directory] [threads]             *
+ *  The defaults are barnsley_fern.sock, barnsley_fern_cache, and all of      *
+ *  the threads. See bf_server.hpp for the protocol, and                      *
+ *  barnsley_fern_client for sending requests.                                */
+int main(int argc, char **argv)
+{
+    const char *socket_path = (argc > 1 ? argv[1] : "barnsley_fern.sock");
+    const char *cache_dir = (argc > 2 ? argv[2] : "barnsley_fern_cache");
+    const int threads = (argc > 3 ? std::atoi(argv[3]) : 0);
+
+    if (threads < 0)
+    {
+        std::fprintf(stderr, "ERROR: the number of threads is negative.\n");
+        return 1;
+    }
+
+    /*  It is fine if the directory is already there.                         */
+    mkdir(cache_dir, 0755);
+
+    bf::server daemon(socket_path, cache_dir,
+                      static_cast<unsigned int>(threads));
+
+    if (!daemon.open())
+        return 1;
+
+    daemon.serve();
+    return 0;
+}
+/*  End of main.                                                              */
@@ -0,0 +1,86 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Renders a large fern with a sparse histogram and reports its memory.      *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  std::printf given here.                                                   */
+#include <cstdio>
+
+/*  std::atoi and std::strtod given here.                                     */
+#include <cstdlib>
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Function for rendering a large fern with a sparse histogram.              *
+ *  Usage:                                                                    *
+ *      barnsley_fern_sparse [size] [points] [name]                           *
+ *  The image is size x size pixels, 1024 by default, with the given number   *
+ *  of points per pixel, 64 by default, written to name, which defaults to    *
+ *  barnsley_fern_sparse.ppm. The memory used is compared to a dense one.     */
+int main(int argc, char **argv)
+{
+    const int size = (argc > 1 ? std::atoi(argv[1]) : 1024);
+    const double points = (argc > 2 ? std::strtod(argv[2], NULL) : 64.0);
+    const char *name = (argc > 3 ? argv[3] : "barnsley_fern_sparse.ppm");
+    const bf::ifs fern = bf::ifs::barnsley();
+    double x_val = fern.xstart;
+    double y_val = fern.ystart;
+    bf::sparse_histogram hist;
+    std::uint64_t iterations;
+    bf::rng gen(1U);
+
+    if (size <= 0 || !(points > 0.0))
+    {
+        std::fprintf(stderr, "ERROR: the size and points must be positive.\n");
+        return 1;
+    }
+
+    hist.reset(bf::view(static_cast<unsigned int>(size),
+                        static_cast<unsigned int>(size)));
+
+    iterations = static_cast<std::uint64_t>(
+        points * static_cast<double>(hist.v.number_of_pixels())
+    );
+
+    hist.render(fern, iterations, x_val, y_val, gen);
+
+    if (hist.failed)
+    {
+        std::fprintf(stderr, "ERROR: out of memory.\n");
+        return 1;
+    }
+
+    std::printf("%lu of %lu tiles, %.1f MiB instead of %.1f MiB.\n",
+                static_cast<unsigned long>(hist.tiles_used),
+                static_cast<unsigned long>(hist.directory.size()),
+                static_cast<double>(hist.bytes()) / 1048576.0,
+                static_cast<double>(hist.v.number_of_pixels()) / 262144.0);
+
+    if (!bf::write_sparse(bf::colorer::greenscale, hist, name,
+                          static_cast<double>(bf::setup::max_iters) /
+                          (256.0 * points)))
+        return 1;
+
+    return 0;
+}
+/*  End of main.                                                              */
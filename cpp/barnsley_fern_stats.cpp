@@ -0,0 +1,52 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Creates a Barnley fern and reports statistics about the render.           *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  strcmp given here.                                                        */
+#include <cstring>
+
+/*  All required tools are provided here.                                     */
+#include "bf/bf.hpp"
+
+/*  Function for drawing the Barnsley Fern with instrumentation.              *
+ *  Usage:                                                                    *
+ *      barnsley_fern_stats [json | logfmt] [file name]                       *
+ *  The statistics go to stderr, logfmt by default. The image is written to   *
+ *  barnsley_fern.ppm unless another name is given.                           */
+int main(int argc, char **argv)
+{
+    const bool json = (argc > 1 && std::strcmp(argv[1], "json") == 0);
+    const char *name = (argc > 2 ? argv[2] : "barnsley_fern.ppm");
+    bf::render_stats stats;
+    bool success;
+
+    success = bf::run(bf::colorer::grayscale, name, stats);
+
+    if (json)
+        stats.write_json(stderr);
+    else
+        stats.write_logfmt(stderr);
+
+    return (success ? 0 : 1);
+}
+/*  End of main.                                                              */
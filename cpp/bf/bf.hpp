@@ -27,21 +27,96 @@
 #ifndef BF_HPP
 #define BF_HPP
 
+/*  snprintf, for numbering the frames of an animation.                       */
+#include <stdio.h>
+
 /*  calloc and free are given here.                                           */
 #include <stdlib.h>
 
+/*  strlen and strcmp, for checking file extensions, and strchr.              */
+#include <string.h>
+
+/*  Animations that sweep the IFS parameters.                                 */
+#include "bf_animation.hpp"
+
+/*  Batch runner for manifests of render jobs.                                */
+#include "bf_batch.hpp"
+
 /*  Basic color struct for working with colors in RGB format.                 */
 #include "bf_color.hpp"
 
 /*  Main function for generating the Barnsley fern provided here.             */
 #include "bf_fern.hpp"
 
+/*  Histograms of hit counts, saving and loading them, and tone mapping.      */
+#include "bf_histogram.hpp"
+
+/*  save_image and save_density, for writing image files.                     */
+#include "bf_image.hpp"
+
+/*  Summing histograms from several renders.                                  */
+#include "bf_merge.hpp"
+
+/*  PFM struct for writing floating point images.                             */
+#include "bf_pfm.hpp"
+
+/*  Hardware performance counters for profiling the stages of a render.       */
+#include "bf_perf.hpp"
+
+/*  PNG struct with a multi-threaded encoder.                                 */
+#include "bf_png.hpp"
+
 /*  PPM struct defined here with basic functions and utilities.               */
 #include "bf_ppm.hpp"
 
+/*  Kernels in single and mixed precision, and checks of their accuracy.      */
+#include "bf_precision.hpp"
+
+/*  Kernel in fixed-point pixel coordinates, checked like the ones above.     */
+#include "bf_fixed.hpp"
+
+/*  Chaos game drawing several maps per random number from an alias table.    */
+#include "bf_composed.hpp"
+
+/*  Chaos game picking several maps from slices of one random number.         */
+#include "bf_sliced.hpp"
+
+/*  IFS definitions read from text files.                                     */
+#include "bf_definition.hpp"
+
+/*  Histograms split by map, for coloring by transform.                       */
+#include "bf_channels.hpp"
+
+/*  Adaptive density estimation, smoothing sparse histograms.                 */
+#include "bf_estimate.hpp"
+
+/*  Rendering with forked worker processes and shared memory.                 */
+#include "bf_process.hpp"
+
+/*  Renderer that keeps its buffers for repeated renders.                     */
+#include "bf_renderer.hpp"
+
 /*  Setup parameters for the PPM.                                             */
 #include "bf_setup.hpp"
 
+/*  Histograms shared between threads, with atomic adds.                      */
+#include "bf_shared.hpp"
+
+/*  Sparse histograms, tiles allocated on the first hit.                      */
+#include "bf_sparse.hpp"
+
+/*  Render server on a Unix domain socket, with a cache on disk.              */
+#include "bf_server.hpp"
+
+/*  Opt-in instrumentation, phase timings and counters.                       */
+#include "bf_stats.hpp"
+
+/*  Histogram statistics and the log-density tone mapper.                     */
+#include "bf_tonemap.hpp"
+
+/*  Frame streaming to pipes for video encoders.                              */
+#include "bf_stream.hpp"
+
 /*  Namespace for the mini-project. "Barnsley Fractal."                       */
 namespace bf {
 
@@ -114,6 +189,842 @@ namespace bf {
         PPM.close();
     }
     /*  End of main.                                                          */
+
+    /*  Function for drawing the Barnsley Fern as a compressed PNG file.      */
+    template <typename Tcolorer>
+    inline void run_png(Tcolorer color, const char *name)
+    {
+        /*  Integers for looping over pixels in the fern.                     */
+        unsigned int x, y;
+
+        /*  Scale factor for the intensity of the color.                      */
+        const double scale_factor = 1.0 / 256.0;
+
+        /*  Buffer for the Barnsley fern, same layout as in bf::run.          */
+        double * const data = static_cast<double *>(
+            std::calloc(setup::number_of_pixels, sizeof(*data))
+        );
+
+        /*  PNG is compressed as a whole, so the colors are stored in memory  *
+         *  first. This holds the RGB values, three bytes per pixel.          */
+        unsigned char * const rgb = static_cast<unsigned char *>(
+            std::malloc(3U * static_cast<std::size_t>(setup::number_of_pixels))
+        );
+
+        /*  Open the file and give it write permissions.                      */
+        struct png PNG = png(name);
+
+        /*  fopen returns NULL on failure. Check for this.                    */
+        if (!PNG.fp)
+        {
+            /*  free does nothing with NULL pointers, no need to check.       */
+            std::free(data);
+            std::free(rgb);
+            return;
+        }
+
+        /*  calloc and malloc return NULL on failure. Check for this.         */
+        if (!data || !rgb)
+        {
+            std::puts("malloc failed and returned NULL. Aborting.");
+            std::free(data);
+            std::free(rgb);
+
+            /*  Close the file since fopen was successful.                    */
+            PNG.close();
+            return;
+        }
+
+        /*  Create the Barnsley fern and store the values in the data buffer. */
+        create_fern(data);
+
+        /*  Loop over the y pixels and color the image.                       */
+        for (y = 0U; y < setup::ysize; ++y)
+        {
+            /*  Loop over x pixels.                                           */
+            for (x = 0U; x < setup::xsize; ++x)
+            {
+                /*  Compute the color the pixel is going to be.               */
+                const unsigned int index = x + y*setup::xsize;
+                const double val = 1.0 - scale_factor*data[index];
+                const bf::color c = color(val);
+
+                rgb[3U*index] = c.red;
+                rgb[3U*index + 1U] = c.green;
+                rgb[3U*index + 2U] = c.blue;
+            }
+            /*  End of x for-loop.                                            */
+        }
+        /*  End of y for-loop.                                                */
+
+        /*  Compress the image and write it to the file.                      */
+        PNG.write(rgb);
+
+        /*  Free the memory allocated for the data and the image.             */
+        std::free(data);
+        std::free(rgb);
+
+        /*  Close the file and return.                                        */
+        PNG.close();
+    }
+    /*  End of run_png.                                                       */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      run_stream                                                        *
+     *  Purpose:                                                              *
+     *      Streams an animation of the fern filling in to a file descriptor. *
+     *  Arguments:                                                            *
+     *      color (Tcolorer):                                                 *
+     *          The colorer, like bf::colorer::grayscale.                     *
+     *      fd (int):                                                         *
+     *          The file descriptor to write to, 1 for stdout.                *
+     *      type (bf::stream::format):                                        *
+     *          Either bf::stream::raw or bf::stream::ppm.                    *
+     *      frames (unsigned int):                                            *
+     *          The number of frames. Zero is an error, and more frames than  *
+     *          setup::total are cut down to one point per frame.             *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Method:                                                               *
+     *      The iterations of bf::run are split evenly over the frames. The   *
+     *      intensity is scaled by the fraction of the iterations done so     *
+     *      far, so the brightness stays steady and the last frame matches    *
+     *      the output of bf::run. Frame n is written by the stream's thread  *
+     *      while frame n + 1 is being computed here.                         *
+     **************************************************************************/
+    template <typename Tcolorer>
+    inline void
+    run_stream(Tcolorer color, int fd, stream::format type,
+               unsigned int frames)
+    {
+        /*  Integers for looping over pixels and frames.                      */
+        unsigned int n, index;
+
+        /*  Number of points added for each frame.                            */
+        unsigned int step;
+
+        /*  The current point, carried from one frame to the next.            */
+        double x_val = setup::xstart;
+        double y_val = setup::ystart;
+
+        /*  Buffer for the Barnsley fern, same layout as in bf::run.          */
+        double * const data = static_cast<double *>(
+            std::calloc(setup::number_of_pixels, sizeof(*data))
+        );
+
+        /*  calloc returns NULL on failure. Check for this.                   */
+        if (!data)
+        {
+            std::fputs("calloc failed and returned NULL. Aborting.\n", stderr);
+            return;
+        }
+
+        /*  With no frames there is nothing to divide the points between.     */
+        if (frames == 0U)
+        {
+            std::fputs("ERROR: run_stream needs at least one frame.\n", stderr);
+            std::free(data);
+            return;
+        }
+
+        /*  More frames than points would leave every frame with none.        */
+        if (frames > setup::total)
+            frames = setup::total;
+
+        step = setup::total / frames;
+
+        /*  The stream is declared after the check so that it is only started *
+         *  if there is something to write.                                   */
+        {
+            stream out(fd, type);
+
+            for (n = 1U; n <= frames; ++n)
+            {
+                /*  The last frame picks up the remainder of the division.    */
+                const unsigned int count = (n == frames ?
+                                            setup::total - (frames-1U)*step :
+                                            step);
+
+                /*  Scale factor for the intensity, 1/256 on the last frame.  */
+                const double scale_factor = static_cast<double>(frames) /
+                                            (256.0 * static_cast<double>(n));
+
+                unsigned char *rgb;
+
+                create_fern(data, count, x_val, y_val);
+
+                /*  Wait for a free buffer. NULL means the reader is gone.    */
+                rgb = out.acquire();
+
+                if (!rgb)
+                    break;
+
+                for (index = 0U; index < setup::number_of_pixels; ++index)
+                {
+                    const double val = 1.0 - scale_factor*data[index];
+                    const bf::color c = color(val);
+
+                    rgb[3U*index] = c.red;
+                    rgb[3U*index + 1U] = c.green;
+                    rgb[3U*index + 2U] = c.blue;
+                }
+
+                out.submit();
+            }
+
+            /*  Write out whatever is still queued.                           */
+            out.close();
+        }
+
+        std::free(data);
+    }
+    /*  End of run_stream.                                                    */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      run                                                               *
+     *  Purpose:                                                              *
+     *      Same as bf::run, but measures the render as it goes.              *
+     *  Arguments:                                                            *
+     *      color (Tcolorer):                                                 *
+     *          The colorer, like bf::colorer::grayscale.                     *
+     *      name (const char *):                                              *
+     *          The output file name, see save_image.                         *
+     *      stats (bf::render_stats &):                                       *
+     *          The measurements, filled in on return.                        *
+     *      profile (bf::perf_profile *):                                     *
+     *          Optional hardware counters for each stage, may be NULL.       *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if memory ran out or the file could not be written.     *
+     *  Notes:                                                                *
+     *      The points come from std::rand in the same order, so the image is *
+     *      identical to the one bf::run draws. The coloring and the writing  *
+     *      are split into two passes so they can be timed separately.        *
+     **************************************************************************/
+    template <typename Tcolorer>
+    inline bool
+    run(Tcolorer color, const char *name, render_stats &stats,
+        perf_profile *profile = NULL)
+    {
+        const ifs fern = ifs::barnsley();
+        const view v;
+        stdlib_rng gen;
+        stopwatch timer;
+        bool success;
+
+        /*  The allocations are the first stage, start counting here.         */
+        if (profile)
+            profile->start();
+
+        double x_val = fern.xstart;
+        double y_val = fern.ystart;
+        histogram hist(fern, v);
+        unsigned char * const rgb = static_cast<unsigned char *>(
+            malloc(3U * v.number_of_pixels())
+        );
+
+        stats = render_stats();
+        stats.number_of_maps = fern.number_of_maps;
+        stats.alloc_time = timer.lap();
+
+        if (profile)
+            profile->stop(perf_profile::alloc);
+
+        /*  malloc returns NULL on failure. Check for this.                   */
+        if (!rgb || !hist.counts)
+        {
+            std::puts("ERROR: run could not allocate buffers. Aborting.");
+            free(rgb);
+            return false;
+        }
+
+        /*  The timer is reset after each stop, so the time spent reading     *
+         *  the counters is not charged to the next stage.                    */
+        if (profile)
+        {
+            profile->start();
+            timer.lap();
+        }
+
+        create_fern(hist.counts, fern, v, setup::total, x_val, y_val,
+                    gen, stats.probe);
+        stats.iterations = setup::total;
+        stats.chaos_time = timer.lap();
+
+        if (profile)
+        {
+            profile->stop(perf_profile::chaos);
+            profile->start();
+            timer.lap();
+        }
+
+        tone_map(color, hist, rgb);
+        stats.tone_map_time = timer.lap();
+
+        if (profile)
+        {
+            profile->stop(perf_profile::tone_map);
+            profile->start();
+            timer.lap();
+        }
+
+        success = save_image(rgb, v.xsize, v.ysize, name);
+        stats.write_time = timer.lap();
+
+        if (profile)
+            profile->stop(perf_profile::write);
+
+        stats.count_pixels(hist.counts, hist.number_of_pixels());
+        stats.peak_memory = peak_memory();
+
+        free(rgb);
+        return success;
+    }
+    /*  End of run.                                                           */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      recolor                                                           *
+     *  Purpose:                                                              *
+     *      Colors a histogram and writes the image to a file.                *
+     *  Arguments:                                                            *
+     *      color (Tcolorer):                                                 *
+     *          The colorer, like bf::colorer::grayscale.                     *
+     *      hist (const bf::histogram &):                                     *
+     *          The histogram, rendered or loaded from a file.                *
+     *      name (const char *):                                              *
+     *          The output file name, see save_image.                         *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if memory ran out or the file could not be written.     *
+     **************************************************************************/
+    template <typename Tcolorer>
+    inline bool
+    recolor(Tcolorer color, const histogram &hist, const char *name)
+    {
+        unsigned char * const rgb = static_cast<unsigned char *>(
+            malloc(3U * hist.number_of_pixels())
+        );
+        bool success;
+
+        /*  malloc returns NULL on failure. Check for this.                   */
+        if (!rgb || !hist.counts)
+        {
+            std::puts("ERROR: recolor has no data. Aborting.");
+            free(rgb);
+            return false;
+        }
+
+        tone_map(color, hist, rgb);
+        success = save_image(rgb, hist.header.xsize, hist.header.ysize, name);
+        free(rgb);
+        return success;
+    }
+    /*  End of recolor.                                                       */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      recolor                                                           *
+     *  Purpose:                                                              *
+     *      Colors a histogram with the log-density tone mapper and writes    *
+     *      the image to a file.                                              *
+     *  Arguments:                                                            *
+     *      color (Tcolorer):                                                 *
+     *          The colorer, like bf::colorer::grayscale.                     *
+     *      hist (const bf::histogram &):                                     *
+     *          The histogram, rendered or loaded from a file.                *
+     *      params (const bf::log_density &):                                 *
+     *          Exposure, gamma, and white point.                             *
+     *      name (const char *):                                              *
+     *          The output file name, see save_image.                         *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if memory ran out or the file could not be written.     *
+     **************************************************************************/
+    template <typename Tcolorer>
+    inline bool
+    recolor(Tcolorer color, const histogram &hist, const log_density &params,
+            const char *name)
+    {
+        unsigned char * const rgb = static_cast<unsigned char *>(
+            malloc(3U * hist.number_of_pixels())
+        );
+        bool success;
+
+        /*  malloc returns NULL on failure. Check for this.                   */
+        if (!rgb || !hist.counts)
+        {
+            std::puts("ERROR: recolor has no data. Aborting.");
+            free(rgb);
+            return false;
+        }
+
+        tone_map(color, hist, rgb, params);
+        success = save_image(rgb, hist.header.xsize, hist.header.ysize, name);
+        free(rgb);
+        return success;
+    }
+    /*  End of recolor.                                                       */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      run_processes                                                     *
+     *  Purpose:                                                              *
+     *      Renders the default fern with forked worker processes and writes  *
+     *      the image to a file.                                              *
+     *  Arguments:                                                            *
+     *      color (Tcolorer):                                                 *
+     *          The colorer, like bf::colorer::grayscale.                     *
+     *      name (const char *):                                              *
+     *          The output file name, see save_image.                         *
+     *      workers (unsigned int):                                           *
+     *          The number of processes. Zero uses one per hardware thread.   *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if the fern could not be rendered or the file could not *
+     *          be written.                                                   *
+     *  Notes:                                                                *
+     *      The points come from the streams of the batch runner with seed 1, *
+     *      not from std::rand, so the image matches the batch runner's for   *
+     *      the same parameters rather than bf::run's. See bf_process.hpp.    *
+     **************************************************************************/
+    template <typename Tcolorer>
+    inline bool
+    run_processes(Tcolorer color, const char *name, unsigned int workers = 0U)
+    {
+        batch_group group;
+        histogram hist;
+        unsigned char *rgb;
+        bool success;
+
+        group.preset = "barnsley";
+        group.growth = setup::growth_factor;
+        group.iterations = setup::total;
+        group.seed = 1U;
+
+        if (!render_processes(group, hist, workers))
+        {
+            std::puts("ERROR: run_processes could not render. Aborting.");
+            return false;
+        }
+
+        rgb = static_cast<unsigned char *>(
+            malloc(3U * hist.number_of_pixels())
+        );
+
+        /*  malloc returns NULL on failure. Check for this.                   */
+        if (!rgb)
+        {
+            std::puts("ERROR: malloc failed and returned NULL. Aborting.");
+            return false;
+        }
+
+        tone_map(color, hist, rgb, group.linear_scale());
+        success = save_image(rgb, group.v.xsize, group.v.ysize, name);
+        free(rgb);
+        return success;
+    }
+    /*  End of run_processes.                                                 */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      run_sparse                                                        *
+     *  Purpose:                                                              *
+     *      Renders the Barnsley fern into a sparse histogram and writes the  *
+     *      image to a PPM file.                                              *
+     *  Arguments:                                                            *
+     *      color (Tcolorer):                                                 *
+     *          The colorer, like bf::colorer::grayscale.                     *
+     *      name (const char *):                                              *
+     *          The name of the PPM file.                                     *
+     *      v (const bf::view &):                                             *
+     *          The image size, the default is the one bf::run draws.         *
+     *      iterations (std::uint64_t):                                       *
+     *          The number of points.                                         *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if memory ran out or the file could not be written.     *
+     *  Notes:                                                                *
+     *      The points come from std::rand, as in bf::run, and the scale is   *
+     *      adjusted for the number of points per pixel, so the defaults give *
+     *      the same image as bf::run. Neither the counts nor the RGB image   *
+     *      are ever held for the whole canvas, see bf_sparse.hpp, so very    *
+     *      large images fit in memory.                                       *
+     **************************************************************************/
+    template <typename Tcolorer>
+    inline bool
+    run_sparse(Tcolorer color, const char *name, const view &v = view(),
+               std::uint64_t iterations = setup::total)
+    {
+        const ifs fern = ifs::barnsley();
+        const double scale_factor =
+            static_cast<double>(setup::max_iters) *
+            static_cast<double>(v.number_of_pixels()) /
+            (256.0 * static_cast<double>(iterations));
+        sparse_histogram hist(v);
+        stdlib_rng gen;
+        double x_val = fern.xstart;
+        double y_val = fern.ystart;
+
+        hist.render(fern, iterations, x_val, y_val, gen);
+
+        if (hist.failed)
+        {
+            std::puts("ERROR: run_sparse ran out of memory. Aborting.");
+            return false;
+        }
+
+        return write_sparse(color, hist, name, scale_factor);
+    }
+    /*  End of run_sparse.                                                    */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      run_definition                                                    *
+     *  Purpose:                                                              *
+     *      Renders an IFS read from a file and writes the image.             *
+     *  Arguments:                                                            *
+     *      def (const bf::ifs_definition &):                                 *
+     *          The maps, view, colorer, and points per pixel.                *
+     *      name (const char *):                                              *
+     *          The output file name, see save_image.                         *
+     *      seed (std::uint64_t):                                             *
+     *          Seed for the generator.                                       *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if memory ran out or the file could not be written.     *
+     *  Notes:                                                                *
+     *      The points come from count_points, like those of the presets. As  *
+     *      in the batch runner, the first batch_burn_in points are skipped,  *
+     *      since a start point that suits the Barnsley fern may be off       *
+     *      another attractor. The scale is the one of bf::run, adjusted for  *
+     *      the number of points per pixel.                                   *
+     **************************************************************************/
+    inline bool
+    run_definition(const ifs_definition &def, const char *name,
+                   std::uint64_t seed = 1U)
+    {
+        const std::uint64_t iterations = def.iterations();
+        const double scale_factor =
+            static_cast<double>(setup::max_iters) / (256.0 * def.points);
+        histogram hist(def.fern, def.v);
+        plain_counter counter(hist.counts);
+        no_probe probe;
+        double x_val = def.fern.xstart;
+        double y_val = def.fern.ystart;
+        rng gen(seed);
+        unsigned char *rgb;
+        unsigned int n;
+        bool success;
+
+        if (!hist.counts)
+            return false;
+
+        /*  The start point is not on the attractor, skip ahead.              */
+        for (n = 0U; n < batch_burn_in; ++n)
+            def.fern.transform[def.fern.select(gen.percent())].transform(
+                x_val, y_val
+            );
+
+        count_points(counter, def.fern, def.v, iterations,
+                     x_val, y_val, gen, probe);
+
+        rgb = static_cast<unsigned char *>(
+            malloc(3U * hist.number_of_pixels())
+        );
+
+        /*  malloc returns NULL on failure. Check for this.                   */
+        if (!rgb)
+        {
+            std::puts("ERROR: malloc failed and returned NULL. Aborting.");
+            return false;
+        }
+
+        tone_map(def.colorer, hist, rgb, scale_factor);
+        success = save_image(rgb, def.v.xsize, def.v.ysize, name);
+        free(rgb);
+        return success;
+    }
+    /*  End of run_definition.                                                */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      run_channels                                                      *
+     *  Purpose:                                                              *
+     *      Renders the Barnsley fern colored by the maps that drew it.       *
+     *  Arguments:                                                            *
+     *      name (const char *):                                              *
+     *          The output file name, see save_image.                         *
+     *      depth (unsigned int):                                             *
+     *          How many of the last maps pick the color, 1 or 2.             *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if memory ran out or the file could not be written.     *
+     *  Notes:                                                                *
+     *      The points come from std::rand in the same order as in bf::run,   *
+     *      and the channels of a pixel sum to its count in bf::run.          *
+     **************************************************************************/
+    inline bool run_channels(const char *name, unsigned int depth = 1U)
+    {
+        const ifs fern = ifs::barnsley();
+        channel_histogram hist(fern, view(), depth);
+        const channel_colorer color(hist);
+        double x_val = fern.xstart;
+        double y_val = fern.ystart;
+        stdlib_rng gen;
+        unsigned char *rgb;
+        bool success;
+
+        if (!hist.counts)
+            return false;
+
+        create_fern(hist, fern, setup::total, x_val, y_val, gen);
+
+        rgb = static_cast<unsigned char *>(
+            malloc(3U * hist.number_of_pixels())
+        );
+
+        /*  malloc returns NULL on failure. Check for this.                   */
+        if (!rgb)
+        {
+            std::puts("ERROR: malloc failed and returned NULL. Aborting.");
+            return false;
+        }
+
+        tone_map_channels(color, hist, rgb);
+        success = save_image(rgb, hist.v.xsize, hist.v.ysize, name);
+        free(rgb);
+        return success;
+    }
+    /*  End of run_channels.                                                  */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      run_estimated                                                     *
+     *  Purpose:                                                              *
+     *      Renders the Barnsley fern with few points per pixel and smooths   *
+     *      the noise with the adaptive density estimate.                     *
+     *  Arguments:                                                            *
+     *      color (Tcolorer):                                                 *
+     *          The colorer, like bf::colorer::grayscale.                     *
+     *      name (const char *):                                              *
+     *          The output file name, see save_image.                         *
+     *      points (unsigned int):                                            *
+     *          Points per pixel, in place of setup::max_iters.               *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if memory ran out or the file could not be written.     *
+     *  Notes:                                                                *
+     *      The scale is the one of bf::run, adjusted for the number of       *
+     *      points per pixel, so the image has the brightness of bf::run.     *
+     **************************************************************************/
+    template <typename Tcolorer>
+    inline bool
+    run_estimated(Tcolorer color, const char *name, unsigned int points = 8U)
+    {
+        const ifs fern = ifs::barnsley();
+        const view v;
+        const std::uint64_t iterations =
+            static_cast<std::uint64_t>(points) * v.number_of_pixels();
+        const double scale_factor =
+            static_cast<double>(setup::max_iters) / (256.0 * points);
+        histogram hist(fern, v);
+        double x_val = fern.xstart;
+        double y_val = fern.ystart;
+        stdlib_rng gen;
+        float *values;
+        unsigned char *rgb;
+        bool success;
+
+        if (!hist.counts)
+            return false;
+
+        create_fern(hist.counts, fern, v, iterations, x_val, y_val, gen);
+
+        values = static_cast<float *>(
+            malloc(sizeof(*values) * v.number_of_pixels())
+        );
+
+        rgb = static_cast<unsigned char *>(
+            malloc(3U * v.number_of_pixels())
+        );
+
+        /*  malloc returns NULL on failure. Check for this.                   */
+        if (!values || !rgb)
+        {
+            std::puts("ERROR: malloc failed and returned NULL. Aborting.");
+            free(values);
+            free(rgb);
+            return false;
+        }
+
+        estimate_density(hist, values);
+
+        /*  Only the smoothed values are needed now, free the counts early.   */
+        hist.release();
+
+        tone_map(color, values, v.xsize, v.ysize, rgb, scale_factor);
+        success = save_image(rgb, v.xsize, v.ysize, name);
+        free(values);
+        free(rgb);
+        return success;
+    }
+    /*  End of run_estimated.                                                 */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      valid_frame_pattern                                               *
+     *  Purpose:                                                              *
+     *      Checks that a file name pattern is safe to give to snprintf with  *
+     *      a frame number.                                                   *
+     *  Arguments:                                                            *
+     *      pattern (const char *):                                           *
+     *          The pattern, like "frame_%05u.png".                           *
+     *  Outputs:                                                              *
+     *      valid (bool):                                                     *
+     *          True if there is exactly one %u conversion.                   *
+     *  Notes:                                                                *
+     *      The conversion may have flags, a width, and a precision, but no   *
+     *      '*' or length modifier, since those would read other arguments    *
+     *      or another type. "%%" is a literal percent sign and may appear    *
+     *      any number of times.                                              *
+     **************************************************************************/
+    inline bool valid_frame_pattern(const char *pattern)
+    {
+        unsigned int conversions = 0U;
+        const char *c = pattern;
+
+        while (*c)
+        {
+            if (*c++ != '%')
+                continue;
+
+            if (*c == '%')
+            {
+                ++c;
+                continue;
+            }
+
+            while (*c && strchr("-+ #0", *c))
+                ++c;
+
+            while (*c >= '0' && *c <= '9')
+                ++c;
+
+            if (*c == '.')
+            {
+                ++c;
+
+                while (*c >= '0' && *c <= '9')
+                    ++c;
+            }
+
+            if (*c != 'u')
+                return false;
+
+            ++c;
+            ++conversions;
+        }
+
+        return conversions == 1U;
+    }
+    /*  End of valid_frame_pattern.                                           */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      animate                                                           *
+     *  Purpose:                                                              *
+     *      Renders an animation and writes every frame to its own file.      *
+     *  Arguments:                                                            *
+     *      color (Tcolorer):                                                 *
+     *          The colorer, like bf::colorer::grayscale.                     *
+     *      anim (bf::animation &):                                           *
+     *          The animation.                                                *
+     *      pattern (const char *):                                           *
+     *          printf-style file name with one unsigned int for the frame    *
+     *          number (ex. "frame_%05u.png"). See save_image for formats.    *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if the animation could not be rendered, a frame could   *
+     *          not be written, or the pattern is not accepted by             *
+     *          valid_frame_pattern.                                          *
+     *  Notes:                                                                *
+     *      The files do not need to be written in order, so frames are       *
+     *      saved by whichever thread finished them.                          *
+     **************************************************************************/
+    template <typename Tcolorer>
+    inline bool animate(Tcolorer color, animation &anim, const char *pattern)
+    {
+        const unsigned int x = anim.v.xsize;
+        const unsigned int y = anim.v.ysize;
+
+        /*  The pattern is used as a format string, so it must be checked.    */
+        if (!valid_frame_pattern(pattern))
+        {
+            std::printf("ERROR: the pattern %s needs exactly one %%u.\n",
+                        pattern);
+            return false;
+        }
+
+        return anim.run(color, [&](unsigned int n, const histogram &,
+                                   const unsigned char *rgb) -> bool
+        {
+            char name[4096];
+            snprintf(name, sizeof(name), pattern, n);
+            return save_image(rgb, x, y, name);
+        }, false);
+    }
+    /*  End of animate.                                                       */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      animate_stream                                                    *
+     *  Purpose:                                                              *
+     *      Renders an animation and streams the frames, in order, to a file  *
+     *      descriptor, usually a pipe into a video encoder.                  *
+     *  Arguments:                                                            *
+     *      color (Tcolorer):                                                 *
+     *          The colorer, like bf::colorer::grayscale.                     *
+     *      anim (bf::animation &):                                           *
+     *          The animation.                                                *
+     *      fd (int):                                                         *
+     *          The file descriptor to write to, 1 for stdout.                *
+     *      type (bf::stream::format):                                        *
+     *          Either bf::stream::raw or bf::stream::ppm.                    *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if rendering failed or the reader went away.            *
+     **************************************************************************/
+    template <typename Tcolorer>
+    inline bool
+    animate_stream(Tcolorer color, animation &anim, int fd,
+                   stream::format type)
+    {
+        const size_t frame_size = 3U * anim.v.number_of_pixels();
+        stream out(fd, anim.v.xsize, anim.v.ysize, type);
+        bool success;
+
+        success = anim.run(color, [&](unsigned int, const histogram &,
+                                      const unsigned char *rgb) -> bool
+        {
+            /*  Wait for a free buffer. NULL means the reader is gone.        */
+            unsigned char * const frame = out.acquire();
+
+            if (!frame)
+                return false;
+
+            memcpy(frame, rgb, frame_size);
+            out.submit();
+            return true;
+        });
+
+        /*  Write out whatever is still queued.                               */
+        out.close();
+        return success;
+    }
+    /*  End of animate_stream.                                                */
 }
 /*  End of namespace "bf".                                                    */
 
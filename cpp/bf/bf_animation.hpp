@@ -0,0 +1,566 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Provides a driver for animations where the IFS parameters change      *
+ *      from frame to frame. Buffers are reused between frames, and the       *
+ *      frames are spread over the cores.                                     *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_ANIMATION_HPP
+#define BF_ANIMATION_HPP
+
+/*  std::size_t given here.                                                   */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::uint32_t and std::uint64_t.               */
+#include <cstdint>
+
+/*  std::memset found here.                                                   */
+#include <cstring>
+
+/*  std::atomic, used for the abort flag.                                     */
+#include <atomic>
+
+/*  Locks for the buffer pool and for handing out frames in order.            */
+#include <condition_variable>
+#include <mutex>
+
+/*  std::vector, used for the buffer pool.                                    */
+#include <vector>
+
+/*  Main function for generating the Barnsley fern provided here.             */
+#include "bf_fern.hpp"
+
+/*  Histogram struct and the tone mapper.                                     */
+#include "bf_histogram.hpp"
+
+/*  Affine maps and iterated function systems.                                */
+#include "bf_ifs.hpp"
+
+/*  SIMD addition of counts, used to combine the threads of one frame.        */
+#include "bf_merge.hpp"
+
+/*  Threading helpers.                                                        */
+#include "bf_parallel.hpp"
+
+/*  Random number generator with per-thread state.                            */
+#include "bf_rng.hpp"
+
+/*  Image size and the point-to-pixel conversion.                             */
+#include "bf_view.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Every frame is split into this many independent random streams.       *
+     *  The split is the same no matter how many threads are used, so         *
+     *  the images do not depend on the machine or the schedule.              */
+    static const unsigned int animation_streams = 64U;
+
+    /*  Buffers for one frame in flight, the counts and the RGB pixels.       */
+    struct frame_buffers {
+        histogram hist;
+        std::vector<unsigned char> rgb;
+    };
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      frame_pool                                                        *
+     *  Purpose:                                                              *
+     *      A fixed set of frame buffers shared by the worker threads. The    *
+     *      buffers are allocated the first time they are used and are then   *
+     *      handed from frame to frame, so a long animation does the same     *
+     *      number of allocations as a short one.                             *
+     **************************************************************************/
+    struct frame_pool {
+
+        /*  All of the buffers, and the ones not currently in use.            */
+        std::vector<frame_buffers> buffers;
+        std::vector<frame_buffers *> available;
+
+        /*  Protects "available".                                             */
+        std::mutex lock;
+        std::condition_variable returned;
+
+        /*  Constructor, creates a given number of empty buffers.             */
+        frame_pool(unsigned int size);
+
+        /*  Takes a buffer, waiting for one if they are all in use.           */
+        inline frame_buffers *acquire(void);
+
+        /*  Gives a buffer back.                                              */
+        inline void release(frame_buffers *buffer);
+    };
+
+    /*  Constructor. Nothing is allocated until the buffers are reset.        */
+    inline frame_pool::frame_pool(unsigned int size) : buffers(size)
+    {
+        unsigned int n;
+
+        for (n = 0U; n < size; ++n)
+            available.push_back(&buffers[n]);
+    }
+
+    /*  Pops a free buffer off of the stack, blocking while there are none.   */
+    inline frame_buffers *frame_pool::acquire(void)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        frame_buffers *buffer;
+
+        while (available.empty())
+            returned.wait(guard);
+
+        buffer = available.back();
+        available.pop_back();
+        return buffer;
+    }
+
+    /*  Pushes a buffer back onto the stack and wakes up a waiting thread.    */
+    inline void frame_pool::release(frame_buffers *buffer)
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            available.push_back(buffer);
+        }
+
+        returned.notify_one();
+    }
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      animation                                                         *
+     *  Purpose:                                                              *
+     *      Describes an animation that sweeps from one IFS to another, and   *
+     *      renders it frame by frame.                                        *
+     *  Notes:                                                                *
+     *      There are two ways to use the cores. With frame_parallel every    *
+     *      thread renders a whole frame of its own, no data is shared and    *
+     *      nothing needs merging, so this gives the most frames per second.  *
+     *      It needs one set of buffers per thread, so for large images, or   *
+     *      for fewer frames than threads, intra_frame is used instead. There *
+     *      the threads split the random streams of a single frame, each      *
+     *      counting into a private buffer, and the buffers are then summed.  *
+     *      automatic picks between the two using these rules.                *
+     *      Neighbouring frames of a smooth sweep have almost the same        *
+     *      attractor. With coherent set, every random stream picks up where  *
+     *      it stopped in the previous frame, so its points are already on    *
+     *      (or very near) the attractor and no burn-in is needed. decay > 0  *
+     *      also adds decay times the previous histogram to the new one, an   *
+     *      exponential moving average, so a frame looks like one rendered    *
+     *      with up to 1 / (1 - decay) times as many points. Both make a      *
+     *      frame depend on the one before it, so both force intra_frame.     *
+     **************************************************************************/
+    struct animation {
+
+        /*  How the work is spread over the threads.                          */
+        enum schedule {automatic, frame_parallel, intra_frame};
+
+        /*  The parameters at the first and last frames.                      */
+        ifs first, last;
+
+        /*  The image size and the point-to-pixel conversion.                 */
+        view v;
+
+        /*  The number of frames, and the number of points per frame.         */
+        unsigned int frames;
+        std::uint64_t iterations;
+
+        /*  Seed for the random number generator, shared by all frames.       */
+        std::uint64_t seed;
+
+        /*  The schedule, and the number of threads. Zero uses them all.      */
+        schedule mode;
+        unsigned int threads;
+
+        /*  Upper limit on the memory frame_parallel may use for buffers.     */
+        std::size_t memory_budget;
+
+        /*  Points skipped at the start of a stream that starts cold.         */
+        unsigned int burn_in;
+
+        /*  Warm starts from the previous frame, and the history weight.      */
+        bool coherent;
+        double decay;
+
+        /*  The current point of every stream, carried between frames.        */
+        std::vector<double> walkers;
+
+        /*  Constructor from the start and end points and the frame count.    */
+        animation(const ifs &start, const ifs &end, unsigned int count);
+
+        /*  The IFS for a given frame.                                        */
+        inline ifs frame(unsigned int n) const;
+
+        /*  Resolves "automatic" to one of the two schedules.                 */
+        inline schedule choose(unsigned int workers) const;
+
+        /*  Runs one random stream of a frame, adding to the counts.          */
+        inline void render_stream(std::uint32_t *counts, const ifs &fern,
+                                  unsigned int n, unsigned int stream,
+                                  double *walker, bool warm) const;
+
+        /*  Renders every frame and hands the images to a sink.               */
+        template <typename Tcolorer, typename Tsink>
+        inline bool run(Tcolorer color, Tsink sink, bool ordered = true);
+    };
+
+    /**************************************************************************
+     *  Constructor:                                                          *
+     *      animation                                                         *
+     *  Purpose:                                                              *
+     *      Creates an animation with the image size and number of points     *
+     *      per frame used by bf::run.                                        *
+     *  Arguments:                                                            *
+     *      start (const bf::ifs &):                                          *
+     *          The IFS for the first frame.                                  *
+     *      end (const bf::ifs &):                                            *
+     *          The IFS for the last frame.                                   *
+     *      count (unsigned int):                                             *
+     *          The number of frames.                                         *
+     *  Outputs:                                                              *
+     *      anim (bf::animation):                                             *
+     *          The animation. The public members may be changed before run.  *
+     **************************************************************************/
+    inline animation::animation(const ifs &start, const ifs &end,
+                                unsigned int count)
+        : first(start), last(end), v(), frames(count),
+          iterations(setup::total), seed(1U), mode(automatic), threads(0U),
+          memory_budget(static_cast<std::size_t>(512U) << 20),
+          burn_in(16U), coherent(false), decay(0.0)
+    {
+        return;
+    }
+
+    /*  Frames are evenly spaced, the first and last are exactly the inputs.  */
+    inline ifs animation::frame(unsigned int n) const
+    {
+        if (frames < 2U)
+            return first;
+
+        return interpolate(first, last, static_cast<double>(n) /
+                                        static_cast<double>(frames - 1U));
+    }
+
+    /*  The rules from the notes above the struct.                            */
+    inline animation::schedule animation::choose(unsigned int workers) const
+    {
+        /*  Counts and RGB pixels for one frame.                              */
+        const std::size_t frame_bytes = v.number_of_pixels() *
+                                        (sizeof(std::uint32_t) + 3U);
+
+        if (coherent || decay > 0.0)
+            return intra_frame;
+
+        if (mode != automatic)
+            return mode;
+
+        if (workers < 2U)
+            return frame_parallel;
+
+        if (frames < workers)
+            return intra_frame;
+
+        if (frame_bytes * workers > memory_budget)
+            return intra_frame;
+
+        return frame_parallel;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      render_stream                                                     *
+     *  Purpose:                                                              *
+     *      Runs one of the animation_streams pieces of a frame.              *
+     *  Arguments:                                                            *
+     *      counts (std::uint32_t *):                                         *
+     *          The hit counts the points are added to.                       *
+     *      fern (const bf::ifs &):                                           *
+     *          The IFS for the frame.                                        *
+     *      n (unsigned int):                                                 *
+     *          The frame number.                                             *
+     *      stream (unsigned int):                                            *
+     *          Which piece, between 0 and animation_streams - 1.             *
+     *      walker (double *):                                                *
+     *          The point of the stream, x then y. Updated on return.         *
+     *      warm (bool):                                                      *
+     *          If true the stream continues from walker. Otherwise it starts *
+     *          from the start point of the IFS and the first burn_in points  *
+     *          are not counted, since they are not yet on the attractor.     *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Notes:                                                                *
+     *      Each piece has its own generator, seeded with the seed of the     *
+     *      animation and the number n * animation_streams + stream.          *
+     **************************************************************************/
+    inline void
+    animation::render_stream(std::uint32_t *counts, const ifs &fern,
+                             unsigned int n, unsigned int stream,
+                             double *walker, bool warm) const
+    {
+        const std::uint64_t share = iterations / animation_streams;
+        const std::uint64_t extra = iterations % animation_streams;
+        const std::uint64_t count = share + (stream < extra ? 1U : 0U);
+        const std::uint64_t id = static_cast<std::uint64_t>(n) *
+                                 animation_streams + stream;
+
+        rng gen(seed, id);
+        double x_val = (warm ? walker[0] : fern.xstart);
+        double y_val = (warm ? walker[1] : fern.ystart);
+        unsigned int n_skip;
+
+        if (!warm)
+            for (n_skip = 0U; n_skip < burn_in; ++n_skip)
+                fern.transform[fern.select(gen.percent())].transform(x_val,
+                                                                     y_val);
+
+        create_fern(counts, fern, v, count, x_val, y_val, gen);
+        walker[0] = x_val;
+        walker[1] = y_val;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      run                                                               *
+     *  Purpose:                                                              *
+     *      Renders and colors every frame of the animation.                  *
+     *  Arguments:                                                            *
+     *      color (Tcolorer):                                                 *
+     *          The colorer, like bf::colorer::grayscale.                     *
+     *      sink (Tsink):                                                     *
+     *          Called as sink(n, hist, rgb) for every frame n, where hist is *
+     *          the bf::histogram and rgb the colored image. Returns false to *
+     *          stop the animation early. The buffers are reused once the     *
+     *          sink returns, so copy anything that is needed later.          *
+     *      ordered (bool):                                                   *
+     *          If true, the sink is called for frames 0, 1, 2, ... in order  *
+     *          and never from two threads at once, as needed for streams.    *
+     *          If false, it may be called in any order and concurrently,     *
+     *          which is faster for things like writing numbered files.       *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if a buffer could not be allocated or the sink stopped  *
+     *          the animation.                                                *
+     *  Notes:                                                                *
+     *      The brightness is scaled by the number of points per frame, so    *
+     *      with the default of setup::total the images look like bf::run.    *
+     **************************************************************************/
+    template <typename Tcolorer, typename Tsink>
+    inline bool animation::run(Tcolorer color, Tsink sink, bool ordered)
+    {
+        const unsigned int workers = (threads == 0U ?
+                                      parallel::number_of_threads() :
+                                      threads);
+
+        const schedule plan = choose(workers);
+        const std::size_t pixels = v.number_of_pixels();
+
+        /*  Same scale as bf::run, 1/256 for 64 points per pixel.             */
+        const double scale_factor = static_cast<double>(pixels) /
+                                    (4.0 * static_cast<double>(iterations));
+
+        /*  Set if a sink asks to stop, or a buffer is unavailable.           */
+        std::atomic<bool> failed(false);
+
+        /*  The next frame to be given to an ordered sink.                    */
+        unsigned int turn = 0U;
+        std::mutex turn_lock;
+        std::condition_variable turn_changed;
+
+        /*  Sets up the buffers for a frame. The header is completed here.    */
+        auto prepare = [&](frame_buffers &buffer, const ifs &fern) -> bool
+        {
+            if (!buffer.hist.reset(fern, v))
+                return false;
+
+            buffer.hist.header.rng = histogram_rng_xoshiro;
+            buffer.hist.header.seed = seed;
+            buffer.hist.header.iterations = iterations;
+            buffer.rgb.resize(3U * pixels);
+            return true;
+        };
+
+        /*  Hands a finished frame to the sink, in order if asked to.         */
+        auto deliver = [&](unsigned int n, frame_buffers &buffer)
+        {
+            if (!ordered)
+            {
+                if (!failed && !sink(n, buffer.hist,
+                          static_cast<const unsigned char *>(&buffer.rgb[0])))
+                    failed = true;
+
+                return;
+            }
+
+            std::unique_lock<std::mutex> guard(turn_lock);
+
+            while (turn != n && !failed)
+                turn_changed.wait(guard);
+
+            if (!failed)
+                if (!sink(n, buffer.hist,
+                          static_cast<const unsigned char *>(&buffer.rgb[0])))
+                    failed = true;
+
+            ++turn;
+            turn_changed.notify_all();
+        };
+
+        if (plan == frame_parallel)
+        {
+            /*  One buffer per thread, so acquire never has to wait.          */
+            frame_pool pool(workers);
+
+            parallel::for_each(frames, [&](unsigned int n)
+            {
+                frame_buffers *buffer;
+                const ifs fern = frame(n);
+                unsigned int stream;
+                double walker[2];
+
+                if (failed)
+                {
+                    deliver(n, pool.buffers[0]);
+                    return;
+                }
+
+                buffer = pool.acquire();
+
+                if (prepare(*buffer, fern))
+                {
+                    for (stream = 0U; stream < animation_streams; ++stream)
+                        render_stream(buffer->hist.counts, fern, n, stream,
+                                      walker, false);
+
+                    tone_map(color, buffer->hist, &buffer->rgb[0],
+                             scale_factor, 1U);
+                }
+                else
+                    failed = true;
+
+                deliver(n, *buffer);
+                pool.release(buffer);
+            }, workers);
+        }
+
+        else
+        {
+            /*  Buffer 0 holds the frame, the others are per-thread counts.   */
+            frame_pool pool(workers);
+            const unsigned int tiles = static_cast<unsigned int>(
+                (pixels + merge_tile - 1U) / merge_tile
+            );
+
+            /*  Moving average of the frames, only needed with decay.         */
+            std::vector<float> history(decay > 0.0 ? pixels : 0U);
+            const float weight = static_cast<float>(decay);
+
+            /*  Number of points the mixed frame is worth.                    */
+            double effective = 0.0;
+            unsigned int n;
+
+            walkers.resize(2U * animation_streams);
+
+            for (n = 0U; n < frames && !failed; ++n)
+            {
+                const ifs fern = frame(n);
+                frame_buffers &out = pool.buffers[0];
+
+                if (!prepare(out, fern))
+                    return false;
+
+                /*  The other buffers are zeroed by the thread that uses      *
+                 *  them, so the clearing is parallel too.                    */
+                parallel::for_each(workers, [&](unsigned int worker)
+                {
+                    histogram &hist = pool.buffers[worker].hist;
+                    unsigned int stream;
+
+                    if (worker > 0U && !hist.reset(fern, v))
+                    {
+                        failed = true;
+                        return;
+                    }
+
+                    for (stream = worker; stream < animation_streams;
+                         stream += workers)
+                        render_stream(hist.counts, fern, n, stream,
+                                      &walkers[2U * stream],
+                                      coherent && n > 0U);
+                }, workers);
+
+                if (failed)
+                    return false;
+
+                /*  Sum the private counts into the frame, tile by tile.      */
+                parallel::for_each(tiles, [&](unsigned int tile)
+                {
+                    const std::size_t start = tile * merge_tile;
+                    const std::size_t length = (start + merge_tile > pixels ?
+                                                pixels - start : merge_tile);
+                    unsigned int worker;
+
+                    for (worker = 1U; worker < workers; ++worker)
+                        add_counts(out.hist.counts + start,
+                                   pool.buffers[worker].hist.counts + start,
+                                   length);
+
+                    /*  Blend in the previous frames. The average is kept in  *
+                     *  floating point, rounding it to integers each frame    *
+                     *  would leave small counts stuck and never fading out.  */
+                    if (!history.empty())
+                    {
+                        std::uint32_t * const counts = out.hist.counts + start;
+                        float * const average = &history[start];
+                        std::size_t index;
+
+                        for (index = 0U; index < length; ++index)
+                        {
+                            average[index] = weight*average[index] +
+                                             static_cast<float>(counts[index]);
+
+                            counts[index] = static_cast<std::uint32_t>(
+                                average[index] + 0.5F
+                            );
+                        }
+                    }
+                }, workers);
+
+                /*  The brightness follows the number of points blended in.   */
+                effective = static_cast<double>(iterations) + decay*effective;
+                out.hist.header.iterations =
+                    static_cast<std::uint64_t>(effective + 0.5);
+
+                tone_map(color, out.hist, &out.rgb[0],
+                         static_cast<double>(pixels) / (4.0 * effective),
+                         workers);
+                deliver(n, out);
+            }
+        }
+
+        return !failed;
+    }
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,823 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Provides a batch runner that reads a manifest of render jobs and runs *
+ *      them on a shared thread pool, computing each histogram only once.     *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_BATCH_HPP
+#define BF_BATCH_HPP
+
+/*  std::stable_sort, used to start the most expensive renders first.         */
+#include <algorithm>
+
+/*  std::atomic, set if a lane runs out of memory, and the failure count.     */
+#include <atomic>
+
+/*  std::size_t given here.                                                   */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::uint64_t.                                 */
+#include <cstdint>
+
+/*  FILE data type, std::fopen, std::fgets, and std::fprintf found here.      */
+#include <cstdio>
+
+/*  std::strtod and std::strtoull found here.                                 */
+#include <cstdlib>
+
+/*  std::strcmp, std::strchr, std::strspn, and std::strcspn found here.       */
+#include <cstring>
+
+/*  std::string, for the output file names.                                   */
+#include <string>
+
+/*  std::vector, for the jobs and the groups of jobs.                         */
+#include <vector>
+
+/*  Basic color struct and the colorers.                                      */
+#include "bf_color.hpp"
+
+/*  The chaos game for an arbitrary IFS.                                      */
+#include "bf_fern.hpp"
+
+/*  Histograms of hit counts, and the linear tone mapper.                     */
+#include "bf_histogram.hpp"
+
+/*  IFS struct and the presets.                                               */
+#include "bf_ifs.hpp"
+
+/*  add_counts and merge_tile, for summing the lanes of a render.             */
+#include "bf_merge.hpp"
+
+/*  save_image and save_density, for writing image files.                     */
+#include "bf_image.hpp"
+
+/*  Work-stealing scheduler, everything in a batch is one of its tasks.       */
+#include "bf_parallel.hpp"
+
+/*  xoshiro256** generator, std::rand cannot be shared by threads.            */
+#include "bf_rng.hpp"
+
+/*  Counting into one histogram shared by the lanes of a render.              */
+#include "bf_shared.hpp"
+
+/*  The log-density tone mapper.                                              */
+#include "bf_tonemap.hpp"
+
+/*  View struct, the image size and the point-to-pixel conversion.            */
+#include "bf_view.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Points per stream of the chaos game, the unit that is handed out.     */
+    static const std::uint64_t batch_stream_points = 4194304U;
+
+    /*  Points skipped at the start of each stream.                           */
+    static const unsigned int batch_burn_in = 16U;
+
+    /*  Memory for the extra buffers of one render, see batch::render.        */
+    static const std::size_t batch_lane_memory = 268435456U;
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      next_token                                                        *
+     *  Purpose:                                                              *
+     *      Splits a string into tokens like std::strtok, but keeps its       *
+     *      place in the caller's pointer rather than in hidden state, so     *
+     *      threads may tokenize different strings at once.                  *
+     *  Arguments:                                                            *
+     *      rest (char **):                                                   *
+     *          The text not yet read. It is advanced past the token.         *
+     *      delimiters (const char *):                                        *
+     *          The characters that separate tokens.                          *
+     *  Outputs:                                                              *
+     *      token (char *):                                                   *
+     *          The next token, NUL terminated in place, or NULL at the end.  *
+     **************************************************************************/
+    inline char *next_token(char **rest, const char *delimiters)
+    {
+        char *token = *rest + std::strspn(*rest, delimiters);
+        char *end;
+
+        if (*token == '\0')
+        {
+            *rest = token;
+            return NULL;
+        }
+
+        end = token + std::strcspn(token, delimiters);
+        *rest = end;
+
+        if (*end != '\0')
+        {
+            *end = '\0';
+            *rest = end + 1;
+        }
+
+        return token;
+    }
+
+    /*  One output of the batch: how to color a histogram, and where to.      */
+    struct batch_job {
+
+        /*  Line of the manifest, for error messages.                         */
+        unsigned int line;
+
+        /*  The colorer, like bf::colorer::grayscale.                         */
+        color (*colorer)(double);
+
+        /*  Log-density tone mapping if true, the linear one of bf::run if    *
+         *  false. The parameters are only used for the former.               */
+        bool log;
+        log_density params;
+
+        /*  The file name. The extension picks the format, see save.          */
+        std::string output;
+    };
+
+    /*  Jobs that share a histogram, differing only in color or format.       */
+    struct batch_group {
+
+        /*  The preset, "barnsley" or "thelypteridaceae", and its growth.     */
+        std::string preset;
+        double growth;
+
+        /*  The image size, the number of points, and the seed.               */
+        view v;
+        std::uint64_t iterations;
+        std::uint64_t seed;
+
+        /*  Everything drawn from this histogram.                             */
+        std::vector<batch_job> jobs;
+
+        /*  The IFS for the preset.                                           */
+        inline ifs get_ifs(void) const;
+
+        /*  True if the two groups would render identical histograms.         */
+        inline bool same_render(const batch_group &other) const;
+
+        /*  The scale of bf::run, adjusted for the number of points.          */
+        inline double linear_scale(void) const;
+
+        /*  The number of streams of batch_stream_points the points need.     */
+        inline std::uint64_t number_of_streams(void) const;
+    };
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      batch                                                             *
+     *  Purpose:                                                              *
+     *      A manifest of render jobs, grouped by histogram.                  *
+     *  Notes:                                                                *
+     *      The manifest has one job per line, as whitespace separated        *
+     *      key=value pairs. Blank lines and lines starting with # are        *
+     *      skipped. The keys, with their defaults, are:                      *
+     *          ifs=barnsley       Or thelypteridaceae.                       *
+     *          growth=0.8         Growth factor of the Barnsley fern.        *
+     *          size=1024x1024     Image size in pixels.                      *
+     *          points=64          Points per pixel.                          *
+     *          seed=1             Seed for the generator.                    *
+     *          color=grayscale    Or greenscale.                             *
+     *          tone=linear        Or log, the log-density tone mapper.       *
+     *          exposure=0         Exposure in stops, for tone=log.           *
+     *          gamma=0.4          Gamma, for tone=log.                       *
+     *          out=NAME           Required. Ends in .png, .pfm, .hist, or    *
+     *                             anything else for PPM.                     *
+     *      For example:                                                      *
+     *          growth=0.85 size=2048x2048 color=greenscale out=g.png         *
+     *      Jobs with the same ifs, growth, size, points, and seed share a    *
+     *      histogram, however far apart they are in the manifest.            *
+     **************************************************************************/
+    struct batch {
+
+        /*  The histograms to be rendered, in order of first appearance.      */
+        std::vector<batch_group> groups;
+
+        /*  Reads a manifest from a file, "-" for stdin.                      */
+        inline bool load(const char *name);
+
+        /*  Parses one line of a manifest and adds the job.                   */
+        inline bool parse(char *text, unsigned int line);
+
+        /*  The total number of jobs.                                         */
+        inline std::size_t number_of_jobs(void) const;
+
+        /*  Renders everything, returning the number of jobs that failed.     */
+        inline std::size_t
+        run(unsigned int threads = 0U,
+            histogram_strategy strategy = strategy_auto) const;
+
+        /*  Reads the settings of one job, without adding it anywhere.        */
+        static inline bool
+        read_job(char *text, unsigned int line, batch_group &group,
+                 batch_job &job);
+
+        /*  Renders the histogram for one group.                              */
+        static inline bool
+        render(const batch_group &group, histogram &hist, unsigned int lanes,
+               histogram_strategy strategy = strategy_auto);
+
+        /*  Adds one stream of a group's points to a counter.                 */
+        template <typename Tcounter>
+        static inline void
+        render_stream(const batch_group &group, const ifs &fern,
+                      Tcounter &counter, std::uint64_t stream);
+
+        /*  Adds one stream of a group's points to the counts.                */
+        static inline void
+        render_stream(const batch_group &group, const ifs &fern,
+                      std::uint32_t *counts, std::uint64_t stream);
+    };
+
+    /*  The presets are the ones in bf::ifs.                                  */
+    inline ifs batch_group::get_ifs(void) const
+    {
+        if (preset == "thelypteridaceae")
+            return ifs::thelypteridaceae();
+
+        return ifs::barnsley(growth);
+    }
+
+    /*  Exact comparisons, since both sides were parsed the same way.         */
+    inline bool batch_group::same_render(const batch_group &other) const
+    {
+        return preset == other.preset && growth == other.growth &&
+               v.xsize == other.v.xsize && v.ysize == other.v.ysize &&
+               iterations == other.iterations && seed == other.seed;
+    }
+
+    /*  64 points per pixel gives the 1 / 256 of bf::run.                     */
+    inline double batch_group::linear_scale(void) const
+    {
+        return static_cast<double>(setup::max_iters) *
+               static_cast<double>(v.number_of_pixels()) /
+               (256.0 * static_cast<double>(iterations));
+    }
+
+    /*  The last stream may be short.                                         */
+    inline std::uint64_t batch_group::number_of_streams(void) const
+    {
+        return (iterations + batch_stream_points - 1U) / batch_stream_points;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      load                                                              *
+     *  Purpose:                                                              *
+     *      Reads every job in a manifest.                                    *
+     *  Arguments:                                                            *
+     *      name (const char *):                                              *
+     *          The manifest file, or "-" for stdin.                          *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if the file could not be read or a line is invalid.     *
+     *          The offending line is reported on stderr.                     *
+     **************************************************************************/
+    inline bool batch::load(const char *name)
+    {
+        const bool use_stdin = (std::strcmp(name, "-") == 0);
+        std::FILE * const fp = (use_stdin ? stdin : std::fopen(name, "r"));
+        char text[4096];
+        unsigned int line = 0U;
+        bool success = true;
+
+        if (!fp)
+        {
+            std::fprintf(stderr, "ERROR: could not open %s.\n", name);
+            return false;
+        }
+
+        while (success && std::fgets(text, sizeof(text), fp))
+        {
+            ++line;
+
+            if (!std::strchr(text, '\n') && !std::feof(fp))
+            {
+                std::fprintf(stderr, "ERROR: %s:%u: line too long.\n",
+                             name, line);
+                success = false;
+            }
+
+            else
+                success = parse(text, line);
+        }
+
+        if (!use_stdin)
+            std::fclose(fp);
+
+        return success;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      read_job                                                          *
+     *  Purpose:                                                              *
+     *      Reads the key=value pairs of one job, see bf::batch.              *
+     *  Arguments:                                                            *
+     *      text (char *):                                                    *
+     *          The settings. It is modified by bf::next_token.               *
+     *      line (unsigned int):                                              *
+     *          The line number, for error messages.                          *
+     *      group (bf::batch_group &):                                        *
+     *          Output, the settings of the histogram.                        *
+     *      job (bf::batch_job &):                                            *
+     *          Output, the settings of the image. The output is left empty   *
+     *          if no out= is given.                                          *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if a pair is invalid. It is reported on stderr.         *
+     *  Notes:                                                                *
+     *      This is shared with the render server, whose requests are         *
+     *      manifest lines without the out= key.                              *
+     **************************************************************************/
+    inline bool
+    batch::read_job(char *text, unsigned int line, batch_group &group,
+                    batch_job &job)
+    {
+        const char * const spaces = " \t\r\n";
+        unsigned int xsize = setup::xsize, ysize = setup::ysize;
+        double points = setup::max_iters;
+        char *rest = text;
+        char *token = next_token(&rest, spaces);
+
+        group.preset = "barnsley";
+        group.growth = setup::growth_factor;
+        group.seed = 1U;
+        group.jobs.clear();
+        job.line = line;
+        job.colorer = colorer::grayscale;
+        job.log = false;
+        job.params = log_density();
+        job.output.clear();
+
+        for (; token; token = next_token(&rest, spaces))
+        {
+            char * const value = std::strchr(token, '=');
+            char *end = NULL;
+            bool valid = (value != NULL);
+
+            if (valid)
+            {
+                *value = '\0';
+
+                if (std::strcmp(token, "ifs") == 0)
+                {
+                    group.preset = value + 1;
+                    valid = (group.preset == "barnsley" ||
+                             group.preset == "thelypteridaceae");
+                }
+
+                else if (std::strcmp(token, "growth") == 0)
+                    group.growth = std::strtod(value + 1, &end);
+
+                else if (std::strcmp(token, "size") == 0)
+                    valid = (std::sscanf(value + 1, "%ux%u", &xsize, &ysize)
+                             == 2 && xsize > 0U && ysize > 0U);
+
+                else if (std::strcmp(token, "points") == 0)
+                {
+                    points = std::strtod(value + 1, &end);
+                    valid = (points > 0.0);
+                }
+
+                else if (std::strcmp(token, "seed") == 0)
+                    group.seed = std::strtoull(value + 1, &end, 10);
+
+                else if (std::strcmp(token, "color") == 0)
+                {
+                    if (std::strcmp(value + 1, "grayscale") == 0)
+                        job.colorer = colorer::grayscale;
+
+                    else if (std::strcmp(value + 1, "greenscale") == 0)
+                        job.colorer = colorer::greenscale;
+
+                    else
+                        valid = false;
+                }
+
+                else if (std::strcmp(token, "tone") == 0)
+                {
+                    job.log = (std::strcmp(value + 1, "log") == 0);
+                    valid = (job.log || std::strcmp(value + 1, "linear") == 0);
+                }
+
+                else if (std::strcmp(token, "exposure") == 0)
+                    job.params.exposure = std::strtod(value + 1, &end);
+
+                else if (std::strcmp(token, "gamma") == 0)
+                {
+                    job.params.gamma = std::strtod(value + 1, &end);
+                    valid = (job.params.gamma > 0.0);
+                }
+
+                else if (std::strcmp(token, "out") == 0)
+                {
+                    job.output = value + 1;
+                    valid = !job.output.empty();
+                }
+
+                else
+                    valid = false;
+
+                /*  Numbers must use up the whole value.                      */
+                if (end && (end == value + 1 || *end != '\0'))
+                    valid = false;
+
+                *value = '=';
+            }
+
+            if (!valid)
+            {
+                std::fprintf(stderr, "ERROR: line %u: bad option \"%s\".\n",
+                             line, token);
+                return false;
+            }
+        }
+
+        group.v = view(xsize, ysize);
+        group.iterations = static_cast<std::uint64_t>(
+            points * static_cast<double>(group.v.number_of_pixels())
+        );
+
+        return true;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      parse                                                             *
+     *  Purpose:                                                              *
+     *      Parses a line of a manifest, adding the job to its group.         *
+     *  Arguments:                                                            *
+     *      text (char *):                                                    *
+     *          The line. It is modified by bf::next_token.                   *
+     *      line (unsigned int):                                              *
+     *          The line number, for error messages.                          *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          True for a valid job or a blank or comment line.              *
+     **************************************************************************/
+    inline bool batch::parse(char *text, unsigned int line)
+    {
+        const char * const first = text + std::strspn(text, " \t\r\n");
+        batch_group group;
+        batch_job job;
+        std::size_t n;
+
+        /*  Blank lines and comments.                                         */
+        if (*first == '\0' || *first == '#')
+            return true;
+
+        if (!read_job(text, line, group, job))
+            return false;
+
+        if (job.output.empty())
+        {
+            std::fprintf(stderr, "ERROR: line %u: no out= given.\n", line);
+            return false;
+        }
+
+        /*  Jobs that can share a histogram go in the same group.             */
+        for (n = 0U; n < groups.size(); ++n)
+        {
+            if (groups[n].same_render(group))
+            {
+                groups[n].jobs.push_back(job);
+                return true;
+            }
+        }
+
+        group.jobs.push_back(job);
+        groups.push_back(group);
+        return true;
+    }
+
+    inline std::size_t batch::number_of_jobs(void) const
+    {
+        std::size_t n, count = 0U;
+
+        for (n = 0U; n < groups.size(); ++n)
+            count += groups[n].jobs.size();
+
+        return count;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      render                                                            *
+     *  Purpose:                                                              *
+     *      Runs the chaos game for a group, in pieces that can be stolen.    *
+     *  Arguments:                                                            *
+     *      group (const bf::batch_group &):                                  *
+     *          The group to render.                                          *
+     *      hist (bf::histogram &):                                           *
+     *          Output, the histogram. Reset to the size of the group.        *
+     *      lanes (unsigned int):                                             *
+     *          How many pieces may run at once.                              *
+     *      strategy (bf::histogram_strategy):                                *
+     *          How the lanes count, see bf_shared.hpp. The default picks     *
+     *          with choose_strategy.                                         *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if memory could not be found.                           *
+     *  Method:                                                               *
+     *      The points are split into streams of batch_stream_points, each    *
+     *      with its own generator, so the counts do not depend on how the    *
+     *      streams are spread over the lanes. Lane 0 counts straight into    *
+     *      the histogram, the others into their own buffers, and these are   *
+     *      summed in tiles afterwards. Every lane and tile is a task of the  *
+     *      scheduler. The number of lanes is limited so the extra buffers    *
+     *      stay within batch_lane_memory. With a shared strategy there are   *
+     *      no extra buffers, every lane adds to the histogram atomically,    *
+     *      so the lanes are not limited by memory.                           *
+     **************************************************************************/
+    inline bool
+    batch::render(const batch_group &group, histogram &hist, unsigned int lanes,
+                  histogram_strategy strategy)
+    {
+        const ifs fern = group.get_ifs();
+        const std::size_t pixels = group.v.number_of_pixels();
+        const std::size_t bytes = pixels * sizeof(*hist.counts);
+        const std::uint64_t streams = group.number_of_streams();
+        const std::size_t spare = 1U + batch_lane_memory / bytes;
+        const unsigned int tiles =
+            static_cast<unsigned int>((pixels + merge_tile - 1U) / merge_tile);
+        std::atomic<bool> failed(false);
+
+        if (lanes > streams)
+            lanes = static_cast<unsigned int>(streams);
+
+        if (lanes == 0U)
+            lanes = 1U;
+
+        if (strategy == strategy_auto)
+            strategy = choose_strategy(pixels, lanes, batch_lane_memory);
+
+        if (strategy == strategy_private && lanes > spare)
+            lanes = static_cast<unsigned int>(spare);
+
+        if (!hist.reset(fern, group.v))
+            return false;
+
+        hist.header.rng = histogram_rng_xoshiro;
+        hist.header.seed = group.seed;
+        hist.header.iterations = group.iterations;
+
+        /*  Atomic adds are exact, so the counts are the same as below.       */
+        if (strategy != strategy_private)
+        {
+            parallel::for_each(lanes, [&](unsigned int lane)
+            {
+                std::uint64_t stream;
+
+                if (strategy == strategy_cached)
+                {
+                    cached_counter counter(hist.counts);
+
+                    for (stream = lane; stream < streams; stream += lanes)
+                        render_stream(group, fern, counter, stream);
+
+                    counter.flush();
+                }
+
+                else
+                {
+                    atomic_counter counter(hist.counts);
+
+                    for (stream = lane; stream < streams; stream += lanes)
+                        render_stream(group, fern, counter, stream);
+                }
+            });
+
+            return true;
+        }
+
+        /*  One buffer per lane, freed when the block ends. Lane 0 counts     *
+         *  into hist, so the first buffer stays empty.                       */
+        {
+            std::vector<histogram> scratch(lanes);
+
+            /*  The scratch buffers are allocated by the lanes, in parallel.  */
+            parallel::for_each(lanes, [&](unsigned int lane)
+            {
+                histogram &mine = (lane == 0U ? hist : scratch[lane]);
+                std::uint64_t stream;
+
+                if (lane > 0U && !mine.reset(fern, group.v))
+                {
+                    failed = true;
+                    return;
+                }
+
+                for (stream = lane; stream < streams; stream += lanes)
+                    render_stream(group, fern, mine.counts, stream);
+            });
+
+            if (!failed && lanes > 1U)
+                parallel::for_each(tiles, [&](unsigned int tile)
+                {
+                    const std::size_t start = tile * merge_tile;
+                    const std::size_t length = (start + merge_tile > pixels ?
+                                                pixels - start : merge_tile);
+                    unsigned int lane;
+
+                    for (lane = 1U; lane < lanes; ++lane)
+                        add_counts(hist.counts + start,
+                                   scratch[lane].counts + start, length);
+                });
+        }
+
+        return !failed;
+    }
+    /*  End of render.                                                        */
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      render_stream                                                     *
+     *  Purpose:                                                              *
+     *      Runs one stream of the chaos game for a group.                    *
+     *  Arguments:                                                            *
+     *      group (const bf::batch_group &):                                  *
+     *          The group being rendered.                                     *
+     *      fern (const bf::ifs &):                                           *
+     *          The IFS of the group, from get_ifs.                           *
+     *      counter (Tcounter &):                                             *
+     *          Told about every hit, like bf::atomic_counter.                *
+     *      stream (std::uint64_t):                                           *
+     *          Which stream, less than group.number_of_streams().            *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Notes:                                                                *
+     *      Each stream has its own generator, seeded with the seed of the    *
+     *      group and the stream number, so any way of dealing out the        *
+     *      streams gives the same counts.                                    *
+     **************************************************************************/
+    template <typename Tcounter>
+    inline void
+    batch::render_stream(const batch_group &group, const ifs &fern,
+                         Tcounter &counter, std::uint64_t stream)
+    {
+        const std::uint64_t first = stream * batch_stream_points;
+        const std::uint64_t count =
+            (group.iterations - first < batch_stream_points ?
+             group.iterations - first : batch_stream_points);
+
+        rng gen(group.seed, stream);
+        double x_val = fern.xstart;
+        double y_val = fern.ystart;
+        no_probe probe;
+        unsigned int n_skip;
+
+        /*  The start point is not on the attractor, skip ahead.              */
+        for (n_skip = 0U; n_skip < batch_burn_in; ++n_skip)
+            fern.transform[fern.select(gen.percent())].transform(x_val, y_val);
+
+        count_points(counter, fern, group.v, count, x_val, y_val, gen, probe);
+    }
+    /*  End of render_stream.                                                 */
+
+    /*  Same as the previous method, adding straight to the counts.           */
+    inline void
+    batch::render_stream(const batch_group &group, const ifs &fern,
+                         std::uint32_t *counts, std::uint64_t stream)
+    {
+        plain_counter counter(counts);
+        render_stream(group, fern, counter, stream);
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      run                                                               *
+     *  Purpose:                                                              *
+     *      Renders every histogram and writes every job.                     *
+     *  Arguments:                                                            *
+     *      threads (unsigned int):                                           *
+     *          The number of threads. Zero uses all of them.                 *
+     *      strategy (bf::histogram_strategy):                                *
+     *          How the lanes of each render count, see batch::render.        *
+     *  Outputs:                                                              *
+     *      failures (std::size_t):                                           *
+     *          The number of jobs that were not written, either because      *
+     *          their histogram ran out of memory or because the file could   *
+     *          not be written. Each is reported on stderr.                   *
+     *  Method:                                                               *
+     *      Everything runs on one work-stealing scheduler. Each group is a   *
+     *      task, which splits its chaos game into lanes and tile merges,     *
+     *      then colors and writes its jobs. The tone mapping and the PNG     *
+     *      encoding are split into bands by parallel::for_each, which also   *
+     *      become tasks. So a thread that finishes a thumbnail steals part   *
+     *      of a poster instead of sitting idle, and no histogram is kept     *
+     *      longer than its own jobs need it.                                 *
+     *  Notes:                                                                *
+     *      The groups are spawned largest first, and the other threads       *
+     *      steal from the front, so the big renders start early.             *
+     *      Each stream has its own xoshiro256** generator, seeded by the     *
+     *      job, so the images do not depend on the number of threads.        *
+     *      The linear tone mapper uses the scale of bf::run adjusted for     *
+     *      the number of points, so 64 points per pixel matches bf::run.     *
+     **************************************************************************/
+    inline std::size_t
+    batch::run(unsigned int threads, histogram_strategy strategy) const
+    {
+        const unsigned int count = static_cast<unsigned int>(groups.size());
+        parallel::scheduler pool(threads);
+        std::vector<unsigned int> order(count);
+        std::atomic<std::size_t> failures(0U);
+        unsigned int n;
+
+        for (n = 0U; n < count; ++n)
+            order[n] = n;
+
+        std::stable_sort(order.begin(), order.end(),
+                         [&](unsigned int a, unsigned int b)
+        {
+            return groups[a].iterations > groups[b].iterations;
+        });
+
+        pool.run([&](void)
+        {
+            parallel::for_each(count, [&](unsigned int k)
+            {
+                const batch_group &group = groups[order[k]];
+                const double scale_factor = group.linear_scale();
+                histogram hist;
+                std::vector<unsigned char> rgb;
+                std::size_t j;
+
+                if (!render(group, hist, pool.size(), strategy))
+                {
+                    std::fprintf(stderr, "ERROR: line %u: out of memory.\n",
+                                 group.jobs[0].line);
+                    failures += group.jobs.size();
+                    return;
+                }
+
+                rgb.resize(3U * hist.number_of_pixels());
+
+                for (j = 0U; j < group.jobs.size(); ++j)
+                {
+                    const batch_job &job = group.jobs[j];
+                    const char * const name = job.output.c_str();
+                    const std::size_t length = job.output.size();
+                    bool success;
+
+                    if (length >= 5U && job.output.compare(length - 5U, 5U,
+                                                           ".hist") == 0)
+                        success = hist.save(name);
+
+                    else if (length >= 4U && job.output.compare(length - 4U, 4U,
+                                                                ".pfm") == 0)
+                        success = save_density(hist, name);
+
+                    else
+                    {
+                        if (job.log)
+                            tone_map(job.colorer, hist, rgb.data(),
+                                     job.params);
+                        else
+                            tone_map(job.colorer, hist, rgb.data(),
+                                     scale_factor);
+
+                        success = save_image(rgb.data(), group.v.xsize,
+                                             group.v.ysize, name);
+                    }
+
+                    if (!success)
+                    {
+                        std::fprintf(stderr, "ERROR: line %u: could not "
+                                             "write %s.\n", job.line, name);
+                        ++failures;
+                    }
+                }
+            });
+        });
+
+        return failures;
+    }
+    /*  End of run.                                                           */
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,380 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Provides a small harness for microbenchmarks. Every benchmark is      *
+ *      timed over many repetitions and summarized with robust statistics,    *
+ *      and the results can be written as JSON for comparing runs.            *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_BENCH_HPP
+#define BF_BENCH_HPP
+
+/*  std::sqrt and std::fabs given here.                                       */
+#include <cmath>
+
+/*  std::size_t given here.                                                   */
+#include <cstddef>
+
+/*  FILE data type and std::fprintf found here.                               */
+#include <cstdio>
+
+/*  std::sort and std::nth_element, for the median and the percentiles.       */
+#include <algorithm>
+
+/*  std::chrono::steady_clock, a monotonic clock for the timings.             */
+#include <chrono>
+
+/*  std::string for the names, std::vector for the samples.                   */
+#include <string>
+#include <vector>
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Another namespace to keep the benchmark tools grouped together.       */
+    namespace bench {
+
+        /**********************************************************************
+         *  Function:                                                         *
+         *      keep                                                          *
+         *  Purpose:                                                          *
+         *      Stops the compiler from removing a computation whose result   *
+         *      is never used, which would make a benchmark time nothing.     *
+         *  Arguments:                                                        *
+         *      value (const T &):                                            *
+         *          The result to keep.                                       *
+         *  Outputs:                                                          *
+         *      None (void).                                                  *
+         **********************************************************************/
+        template <typename T>
+        inline void keep(const T &value)
+        {
+#if defined(__GNUC__)
+            __asm__ __volatile__("" : : "r"(&value) : "memory");
+#else
+            static volatile const void *sink;
+            sink = &value;
+#endif
+        }
+
+        /*  Settings shared by all of the benchmarks in a run.                */
+        struct options {
+
+            /*  Number of timed samples per benchmark.                        */
+            unsigned int repetitions;
+
+            /*  Untimed samples first, to fault in memory and warm caches.    */
+            unsigned int warmups;
+
+            /*  Each sample repeats the work until it takes at least this     *
+             *  long, so timer resolution and overhead do not matter.         */
+            double min_sample_time;
+
+            /*  Empty constructor, sensible defaults.                         */
+            options(void) : repetitions(15U), warmups(2U),
+                            min_sample_time(0.05)
+            {
+                return;
+            }
+        };
+
+        /*  The timings of one benchmark, and statistics computed from them.  */
+        struct result {
+
+            /*  Name (ex. "scatter/1024x1024") and the unit of work.          */
+            std::string name;
+            std::string unit;
+
+            /*  Units of work done by one call, and calls per sample.         */
+            double items_per_call;
+            unsigned long calls_per_sample;
+
+            /*  Seconds per unit of work for every sample, sorted.            */
+            std::vector<double> samples;
+
+            /*  Summary of the samples.                                       */
+            double min, max, mean, median, stddev, mad;
+
+            /*  95% confidence interval for the median.                       */
+            double median_low, median_high;
+
+            /*  Fills in the summary from the samples.                        */
+            inline void summarize(void);
+        };
+
+        /**********************************************************************
+         *  Method:                                                           *
+         *      summarize                                                     *
+         *  Purpose:                                                          *
+         *      Computes the statistics of the samples.                       *
+         *  Arguments:                                                        *
+         *      None (void).                                                  *
+         *  Outputs:                                                          *
+         *      None (void).                                                  *
+         *  Method:                                                           *
+         *      Timings have a long right tail (interrupts, page faults), so  *
+         *      the median and the median absolute deviation are the numbers  *
+         *      to compare. The confidence interval for the median does not   *
+         *      assume any distribution: the number of samples below the      *
+         *      true median is binomial(n, 1/2), so the order statistics at   *
+         *      n/2 -+ 1.96 sqrt(n)/2 bracket it 95% of the time.             *
+         **********************************************************************/
+        inline void result::summarize(void)
+        {
+            const std::size_t n = samples.size();
+            std::vector<double> deviation(n);
+            double sum = 0.0, square_sum = 0.0;
+            double half_width, low_rank, high_rank;
+            std::size_t k;
+
+            if (n == 0U)
+                return;
+
+            std::sort(samples.begin(), samples.end());
+
+            for (k = 0U; k < n; ++k)
+                sum += samples[k];
+
+            mean = sum / static_cast<double>(n);
+
+            for (k = 0U; k < n; ++k)
+                square_sum += (samples[k] - mean) * (samples[k] - mean);
+
+            stddev = (n > 1U ?
+                      std::sqrt(square_sum / static_cast<double>(n - 1U)) :
+                      0.0);
+
+            min = samples[0];
+            max = samples[n - 1U];
+            median = (n % 2U == 1U ? samples[n / 2U] :
+                      0.5 * (samples[n / 2U - 1U] + samples[n / 2U]));
+
+            for (k = 0U; k < n; ++k)
+                deviation[k] = std::fabs(samples[k] - median);
+
+            std::sort(deviation.begin(), deviation.end());
+            mad = (n % 2U == 1U ? deviation[n / 2U] :
+                   0.5 * (deviation[n / 2U - 1U] + deviation[n / 2U]));
+
+            /*  Ranks of the order statistics, clamped to the samples.        */
+            half_width = 0.98 * std::sqrt(static_cast<double>(n));
+            low_rank = std::floor(0.5 * static_cast<double>(n) - half_width);
+            high_rank = std::ceil(0.5 * static_cast<double>(n) + half_width);
+
+            if (low_rank < 0.0)
+                low_rank = 0.0;
+
+            if (high_rank > static_cast<double>(n - 1U))
+                high_rank = static_cast<double>(n - 1U);
+
+            median_low = samples[static_cast<std::size_t>(low_rank)];
+            median_high = samples[static_cast<std::size_t>(high_rank)];
+        }
+
+        /**********************************************************************
+         *  Function:                                                         *
+         *      measure                                                       *
+         *  Purpose:                                                          *
+         *      Times a function over many samples.                           *
+         *  Arguments:                                                        *
+         *      name (const char *):                                          *
+         *          The name of the benchmark.                                *
+         *      unit (const char *):                                          *
+         *          The unit of work, like "point" or "byte".                 *
+         *      items_per_call (double):                                      *
+         *          Units of work done by one call of func.                   *
+         *      func (Tfunc):                                                 *
+         *          The code to time, called with no arguments.               *
+         *      opts (const bf::bench::options &):                            *
+         *          Number of samples and minimum sample time.                *
+         *  Outputs:                                                          *
+         *      res (bf::bench::result):                                      *
+         *          The samples, in seconds per unit, and their statistics.   *
+         *  Method:                                                           *
+         *      The number of calls per sample starts at one and doubles      *
+         *      until a sample takes min_sample_time. The calibration doubles *
+         *      as a warmup. Then the warmups are run and thrown away, and    *
+         *      the timed samples follow.                                     *
+         **********************************************************************/
+        template <typename Tfunc>
+        inline result
+        measure(const char *name, const char *unit, double items_per_call,
+                Tfunc func, const options &opts = options())
+        {
+            typedef std::chrono::steady_clock clock;
+            result res;
+            unsigned long calls = 1UL;
+            unsigned long n;
+            unsigned int k;
+
+            /*  Times "calls" calls of func, returning seconds.               */
+            auto sample = [&](void) -> double
+            {
+                const clock::time_point start = clock::now();
+
+                for (n = 0UL; n < calls; ++n)
+                    func();
+
+                return std::chrono::duration<double>(clock::now() -
+                                                     start).count();
+            };
+
+            while (sample() < opts.min_sample_time && calls < (1UL << 30))
+                calls *= 2UL;
+
+            for (k = 0U; k < opts.warmups; ++k)
+                sample();
+
+            res.name = name;
+            res.unit = unit;
+            res.items_per_call = items_per_call;
+            res.calls_per_sample = calls;
+
+            for (k = 0U; k < opts.repetitions; ++k)
+                res.samples.push_back(sample() / (static_cast<double>(calls) *
+                                                  items_per_call));
+
+            res.summarize();
+            return res;
+        }
+        /*  End of measure.                                                   */
+
+        /*  Prints one line per benchmark, for people rather than scripts.    */
+        inline void print(std::FILE *fp, const std::vector<result> &results)
+        {
+            std::size_t n;
+
+            std::fprintf(fp, "%-34s %12s %12s %8s  %s\n", "benchmark",
+                         "ns/item", "Mitems/s", "+-%", "unit");
+
+            for (n = 0U; n < results.size(); ++n)
+            {
+                const result &r = results[n];
+                const double spread = 50.0 * (r.median_high - r.median_low) /
+                                      r.median;
+
+                std::fprintf(fp, "%-34s %12.3f %12.2f %8.2f  %s\n",
+                             r.name.c_str(), 1.0E9 * r.median,
+                             1.0E-6 / r.median, spread, r.unit.c_str());
+            }
+        }
+
+        /*  Writes a string as a JSON string. The names are plain ASCII.      */
+        inline void write_json_string(std::FILE *fp, const std::string &str)
+        {
+            std::size_t n;
+
+            std::fputc('"', fp);
+
+            for (n = 0U; n < str.size(); ++n)
+            {
+                if (str[n] == '"' || str[n] == '\\')
+                    std::fputc('\\', fp);
+
+                std::fputc(str[n], fp);
+            }
+
+            std::fputc('"', fp);
+        }
+
+        /**********************************************************************
+         *  Function:                                                         *
+         *      write_json                                                    *
+         *  Purpose:                                                          *
+         *      Writes the results as a JSON document.                        *
+         *  Arguments:                                                        *
+         *      fp (std::FILE *):                                             *
+         *          The file to write to.                                     *
+         *      results (const std::vector<bf::bench::result> &):             *
+         *          The benchmarks.                                           *
+         *      opts (const bf::bench::options &):                            *
+         *          The options used, stored so runs can be compared fairly.  *
+         *  Outputs:                                                          *
+         *      None (void).                                                  *
+         *  Notes:                                                            *
+         *      All times are seconds per item, as in the samples. %.17g      *
+         *      prints doubles so that they read back exactly.                *
+         **********************************************************************/
+        inline void
+        write_json(std::FILE *fp, const std::vector<result> &results,
+                   const options &opts)
+        {
+            std::size_t n, k;
+
+            std::fprintf(fp, "{\n  \"context\": {\n");
+#if defined(__VERSION__)
+            std::fprintf(fp, "    \"compiler\": ");
+            write_json_string(fp, __VERSION__);
+            std::fprintf(fp, ",\n");
+#endif
+            std::fprintf(fp, "    \"cplusplus\": %ld,\n",
+                         static_cast<long>(__cplusplus));
+            std::fprintf(fp, "    \"repetitions\": %u,\n", opts.repetitions);
+            std::fprintf(fp, "    \"warmups\": %u,\n", opts.warmups);
+            std::fprintf(fp, "    \"min_sample_time\": %.17g\n  },\n",
+                         opts.min_sample_time);
+            std::fprintf(fp, "  \"benchmarks\": [");
+
+            for (n = 0U; n < results.size(); ++n)
+            {
+                const result &r = results[n];
+
+                std::fprintf(fp, "%s\n    {\n      \"name\": ",
+                             (n == 0U ? "" : ","));
+                write_json_string(fp, r.name);
+                std::fprintf(fp, ",\n      \"unit\": ");
+                write_json_string(fp, r.unit);
+                std::fprintf(fp, ",\n");
+                std::fprintf(fp, "      \"items_per_call\": %.17g,\n",
+                             r.items_per_call);
+                std::fprintf(fp, "      \"calls_per_sample\": %lu,\n",
+                             r.calls_per_sample);
+                std::fprintf(fp, "      \"items_per_second\": %.17g,\n",
+                             1.0 / r.median);
+                std::fprintf(fp, "      \"median\": %.17g,\n", r.median);
+                std::fprintf(fp, "      \"median_ci95\": [%.17g, %.17g],\n",
+                             r.median_low, r.median_high);
+                std::fprintf(fp, "      \"mad\": %.17g,\n", r.mad);
+                std::fprintf(fp, "      \"mean\": %.17g,\n", r.mean);
+                std::fprintf(fp, "      \"stddev\": %.17g,\n", r.stddev);
+                std::fprintf(fp, "      \"min\": %.17g,\n", r.min);
+                std::fprintf(fp, "      \"max\": %.17g,\n", r.max);
+                std::fprintf(fp, "      \"samples\": [");
+
+                for (k = 0U; k < r.samples.size(); ++k)
+                    std::fprintf(fp, "%s%.17g", (k == 0U ? "" : ", "),
+                                 r.samples[k]);
+
+                std::fprintf(fp, "]\n    }");
+            }
+
+            std::fprintf(fp, "\n  ]\n}\n");
+        }
+        /*  End of write_json.                                                */
+    }
+    /*  End of namespace "bench".                                             */
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,420 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Histograms with a count per map, or per last few maps, for every      *
+ *      pixel, filled in one pass, and a colorer that mixes a color for       *
+ *      each.                                                                 *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_CHANNELS_HPP
+#define BF_CHANNELS_HPP
+
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::uint8_t and std::uint32_t.                */
+#include <cstdint>
+
+/*  std::puts found here.                                                     */
+#include <cstdio>
+
+/*  std::calloc and std::free, for the counts.                                */
+#include <cstdlib>
+
+/*  std::vector, for the table of next channels.                              */
+#include <vector>
+
+/*  Color struct, the output of the colorer.                                  */
+#include "bf_color.hpp"
+
+/*  count_points, which drives the counter here as its probe as well.         */
+#include "bf_fern.hpp"
+
+/*  Affine maps and iterated function systems.                                */
+#include "bf_ifs.hpp"
+
+/*  Threading helpers, the bands of the image are colored in parallel.        */
+#include "bf_parallel.hpp"
+
+/*  View struct, the image size and the point-to-pixel conversion.            */
+#include "bf_view.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Most channels per pixel, 64 bytes of counts, one cache line.          */
+    static const unsigned int max_channels = 16U;
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      channel_histogram                                                 *
+     *  Purpose:                                                              *
+     *      Hit counts split by the maps that led to each point.              *
+     *  Notes:                                                                *
+     *      With depth 1 there is one channel per map, counting the points    *
+     *      that map produced. With depth d the channel is the last d maps,   *
+     *      read as digits in base m with the last map lowest, so m^d         *
+     *      channels. The depth is lowered until that is at most              *
+     *      max_channels. The counts of a pixel are next to each other, so a  *
+     *      hit touches one cache line however many channels there are. The   *
+     *      memory is the channels times that of a bf::histogram, and that    *
+     *      is the cost: for the 1024 x 1024 fern, the chaos game takes about *
+     *      1.3 times as long with 4 channels as with one, and twice as long  *
+     *      with 16, as fewer of the counts stay in cache.                    *
+     **************************************************************************/
+    struct channel_histogram {
+
+        /*  The image size and the map from the plane to the pixels.          */
+        view v;
+
+        /*  The maps of the IFS, the depth used, and m^depth.                 */
+        unsigned int number_of_maps, depth, channels;
+
+        /*  channels counts per pixel, by rows. NULL if calloc failed.        */
+        std::uint32_t *counts;
+
+        /*  next[c*m + n] is the channel after channel c when map n is used.  */
+        std::vector<std::uint8_t> next;
+
+        /*  Allocates zeroed counts for an IFS and a view.                    */
+        channel_histogram(const ifs &fern, const view &new_view,
+                          unsigned int new_depth = 1U);
+
+        /*  Destructor, frees the counts.                                     */
+        ~channel_histogram(void);
+
+        /*  Frees the counts.                                                 */
+        inline void release(void);
+
+        /*  The number of pixels, each with channels counts.                  */
+        inline std::size_t number_of_pixels(void) const;
+
+    private:
+
+        /*  Copying would free the counts twice.                              */
+        channel_histogram(const channel_histogram &);
+        channel_histogram &operator = (const channel_histogram &);
+    };
+
+    /**************************************************************************
+     *  Constructor:                                                          *
+     *      channel_histogram                                                 *
+     *  Purpose:                                                              *
+     *      Creates a histogram with all counts zero.                         *
+     *  Arguments:                                                            *
+     *      fern (const bf::ifs &):                                           *
+     *          The IFS, for its number of maps.                              *
+     *      new_view (const bf::view &):                                      *
+     *          The image size and the point-to-pixel conversion.             *
+     *      new_depth (unsigned int):                                         *
+     *          How many of the last maps pick the channel. Zero is one.      *
+     *  Outputs:                                                              *
+     *      hist (bf::channel_histogram):                                     *
+     *          The histogram.                                                *
+     *  Notes:                                                                *
+     *      As with bf::histogram, a failed calloc is reported and leaves the *
+     *      counts NULL, and the caller must check.                           *
+     **************************************************************************/
+    inline channel_histogram::channel_histogram(const ifs &fern,
+                                                const view &new_view,
+                                                unsigned int new_depth)
+    {
+        unsigned int channel, map;
+
+        v = new_view;
+        number_of_maps = (fern.number_of_maps > 0U ? fern.number_of_maps : 1U);
+        depth = 0U;
+        channels = 1U;
+
+        while (depth < (new_depth > 0U ? new_depth : 1U) &&
+               channels * number_of_maps <= max_channels)
+        {
+            channels *= number_of_maps;
+            ++depth;
+        }
+
+        /*  Past max_channels maps, depth 0 leaves a single channel.          */
+        next.resize(static_cast<std::size_t>(channels) * number_of_maps);
+
+        for (channel = 0U; channel < channels; ++channel)
+            for (map = 0U; map < number_of_maps; ++map)
+                next[channel*number_of_maps + map] = static_cast<std::uint8_t>(
+                    (channel*number_of_maps + map) % channels
+                );
+
+        counts = static_cast<std::uint32_t *>(
+            std::calloc(number_of_pixels() * channels, sizeof(*counts))
+        );
+
+        if (!counts)
+            std::puts("ERROR: calloc failed and returned NULL.");
+    }
+
+    /*  Destructor, the counts were allocated with calloc.                    */
+    inline channel_histogram::~channel_histogram(void)
+    {
+        release();
+    }
+
+    /*  Frees the counts and sets the pointer to NULL.                        */
+    inline void channel_histogram::release(void)
+    {
+        std::free(counts);
+        counts = NULL;
+    }
+
+    /*  The number of pixels, as a size_t since large images overflow.        */
+    inline std::size_t channel_histogram::number_of_pixels(void) const
+    {
+        return v.number_of_pixels();
+    }
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      channel_counter                                                   *
+     *  Purpose:                                                              *
+     *      Counter and probe for count_points that adds each hit to the      *
+     *      channel of the maps used so far.                                  *
+     *  Notes:                                                                *
+     *      count_points tells the probe the map before it moves the point,   *
+     *      so by the time the hit is added the channel is up to date. The    *
+     *      next channel is looked up rather than computed, a division per    *
+     *      point would cost more than the rest of the bookkeeping.           *
+     **************************************************************************/
+    struct channel_counter {
+        std::uint32_t *counts;
+        const std::uint8_t *next;
+        unsigned int channels, maps, channel;
+
+        explicit channel_counter(channel_histogram &hist)
+            : counts(hist.counts), next(&hist.next[0]),
+              channels(hist.channels), maps(hist.number_of_maps),
+              channel(0U)
+        {
+            return;
+        }
+
+        inline void add(std::size_t index)
+        {
+            ++counts[index*channels + channel];
+        }
+
+        inline void selected(unsigned int map)
+        {
+            channel = next[channel*maps + map];
+        }
+
+        inline void rejected(void)
+        {
+            return;
+        }
+    };
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      create_fern                                                       *
+     *  Purpose:                                                              *
+     *      Runs the chaos game for an IFS, counting hits by channel.         *
+     *  Arguments:                                                            *
+     *      hist (bf::channel_histogram &):                                   *
+     *          The counts, with the view to draw.                            *
+     *      fern, iterations, x_pt, y_pt, gen:                                *
+     *          As for count_points.                                          *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Notes:                                                                *
+     *      The points are the ones create_fern draws for the same generator, *
+     *      so the channels of a pixel add up to its count there. The first   *
+     *      depth - 1 points of a call only know their last few maps, and     *
+     *      are counted as if map 0 had come before them.                     *
+     **************************************************************************/
+    template <typename Trng>
+    inline void
+    create_fern(channel_histogram &hist, const ifs &fern,
+                std::uint64_t iterations, double &x_pt, double &y_pt,
+                Trng &gen)
+    {
+        channel_counter counter(hist);
+        count_points(counter, fern, hist.v, iterations, x_pt, y_pt,
+                     gen, counter);
+    }
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      channel_colorer                                                   *
+     *  Purpose:                                                              *
+     *      Colors a pixel from its channels, as the mix of a color per       *
+     *      channel, darkened like bf::colorer::grayscale.                    *
+     *  Notes:                                                                *
+     *      The ink of a pixel is one minus what grayscale would give for its *
+     *      total, and the pixel is white blended with the mix by the ink. A  *
+     *      palette of black gives grayscale back. The default palette has    *
+     *      brown for the stem map and three greens for the frond and the two *
+     *      leaflets, repeating for more maps. At depth 2 and more, each      *
+     *      channel is three parts the color of its last map and one part     *
+     *      that of the map before, so every leaflet shows its sub-leaflets.  *
+     **************************************************************************/
+    struct channel_colorer {
+
+        /*  Red, green, and blue for each channel, from 0 to 255.             */
+        double palette[max_channels][3];
+
+        /*  The default palette for a histogram.                              */
+        explicit channel_colorer(const channel_histogram &hist);
+
+        /*  The color of a pixel, given its counts.                           */
+        inline color
+        operator () (const std::uint32_t *channel_counts,
+                     unsigned int channels, double scale_factor) const;
+    };
+
+    /*  Brown, dark green, light green, and green, see the notes above.       */
+    inline channel_colorer::channel_colorer(const channel_histogram &hist)
+    {
+        const double base[4][3] = {
+            {139.0,  90.0,  43.0},
+            { 30.0, 107.0,  30.0},
+            {107.0, 176.0,  46.0},
+            { 46.0, 139.0,  87.0}
+        };
+        const unsigned int maps = hist.number_of_maps;
+        unsigned int channel, k;
+
+        for (channel = 0U; channel < max_channels; ++channel)
+        {
+            const unsigned int last = (channel % maps) % 4U;
+            const unsigned int before = ((channel / maps) % maps) % 4U;
+
+            for (k = 0U; k < 3U; ++k)
+            {
+                if (hist.depth > 1U)
+                    palette[channel][k] = 0.75*base[last][k] +
+                                          0.25*base[before][k];
+                else
+                    palette[channel][k] = base[last][k];
+            }
+        }
+    }
+
+    /*  White blended with the mix of the channels' colors, see above.        */
+    inline color
+    channel_colorer::operator () (const std::uint32_t *channel_counts,
+                                  unsigned int channels,
+                                  double scale_factor) const
+    {
+        double mix[3] = {0.0, 0.0, 0.0};
+        double total = 0.0, val, ink;
+        unsigned int channel, k;
+
+        for (channel = 0U; channel < channels; ++channel)
+        {
+            const double count = static_cast<double>(channel_counts[channel]);
+
+            total += count;
+
+            for (k = 0U; k < 3U; ++k)
+                mix[k] += count * palette[channel][k];
+        }
+
+        if (total == 0.0)
+            return colors::white();
+
+        val = 1.0 - scale_factor*total;
+
+        if (val <= 0.0)
+            ink = 1.0;
+        else
+        {
+            const double val_sq = val*val;
+            const double val_cb = val*val_sq;
+            ink = 1.0 - val_cb*val_cb;
+        }
+
+        for (k = 0U; k < 3U; ++k)
+            mix[k] = 255.0*(1.0 - ink) + ink*mix[k]/total;
+
+        return color(static_cast<unsigned char>(mix[0]),
+                     static_cast<unsigned char>(mix[1]),
+                     static_cast<unsigned char>(mix[2]));
+    }
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      tone_map_channels                                                 *
+     *  Purpose:                                                              *
+     *      Colors a channel histogram, writing RGB pixels to a buffer.       *
+     *  Arguments:                                                            *
+     *      color (Tcolorer):                                                 *
+     *          Called with the counts of a pixel, their number, and the      *
+     *          scale, like bf::channel_colorer.                              *
+     *      hist (const bf::channel_histogram &):                             *
+     *          The histogram.                                                *
+     *      rgb (unsigned char *):                                            *
+     *          Output, room for 3 * xsize * ysize bytes.                     *
+     *      scale_factor (double):                                            *
+     *          Scale factor for the intensity, as for tone_map.              *
+     *      threads (unsigned int):                                           *
+     *          The maximum number of threads. Zero uses all of them.         *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     **************************************************************************/
+    template <typename Tcolorer>
+    inline void
+    tone_map_channels(const Tcolorer &color, const channel_histogram &hist,
+                      unsigned char *rgb, double scale_factor = 1.0 / 256.0,
+                      unsigned int threads = 0U)
+    {
+        /*  Number of rows colored at a time by one thread.                   */
+        const unsigned int band_rows = 64U;
+        const unsigned int width = hist.v.xsize;
+        const unsigned int height = hist.v.ysize;
+        const unsigned int bands = (height + band_rows - 1U) / band_rows;
+        const unsigned int channels = hist.channels;
+
+        parallel::for_each(bands, [&](unsigned int band)
+        {
+            const std::size_t first = static_cast<std::size_t>(band) *
+                                      band_rows * width;
+            const unsigned int rows = (band + 1U == bands ?
+                                       height - band*band_rows : band_rows);
+            const std::size_t last = first +
+                                     static_cast<std::size_t>(rows) * width;
+            std::size_t index;
+
+            for (index = first; index < last; ++index)
+            {
+                const bf::color c = color(hist.counts + index*channels,
+                                          channels, scale_factor);
+
+                rgb[3U*index] = c.red;
+                rgb[3U*index + 1U] = c.green;
+                rgb[3U*index + 2U] = c.blue;
+            }
+        }, threads);
+    }
+    /*  End of tone_map_channels.                                             */
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,373 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Chaos game that draws k maps at once, from an alias table over all    *
+ *      words of k maps, and applies their precomputed compositions.          *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_COMPOSED_HPP
+#define BF_COMPOSED_HPP
+
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::uint32_t and std::uint64_t.               */
+#include <cstdint>
+
+/*  std::vector, for the compositions and the alias table.                    */
+#include <vector>
+
+/*  Affine maps and iterated function systems.                                */
+#include "bf_ifs.hpp"
+
+/*  View struct, the image size and the point-to-pixel conversion.            */
+#include "bf_view.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Default size of the tables, a part of L2 cache, leaving the rest to   *
+     *  the histogram.                                                        */
+    static const std::size_t composed_budget = 65536U;
+
+    /*  Longest word a table is built for, whatever the budget.               */
+    static const unsigned int composed_max_length = 12U;
+
+    /*  Entry of an alias table, see composed_ifs::draw.                      */
+    struct alias_entry {
+        std::uint32_t threshold;
+        std::uint32_t alias;
+    };
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      composed_ifs                                                      *
+     *  Purpose:                                                              *
+     *      Every word of k maps of an IFS, with the partial compositions     *
+     *      of each word and an alias table for drawing one.                  *
+     *  Notes:                                                                *
+     *      With m maps, word w picks map w mod m first, then (w / m) mod m,  *
+     *      and so on. Its probability is the product of those of its maps,   *
+     *      so a word drawn from the table is distributed exactly like k maps *
+     *      drawn one at a time. steps[w*k + j] is the composition of the     *
+     *      first j + 1 maps of word w, so the j-th point of the walk is that *
+     *      map applied to the point the word started from. Those k products  *
+     *      do not depend on each other, unlike k maps applied in turn.       *
+     *      The table has m^k entries; composed_length picks k for a budget.  *
+     **************************************************************************/
+    struct composed_ifs {
+        unsigned int length;
+        std::uint32_t number_of_words;
+        std::vector<affine> steps;
+        std::vector<alias_entry> table;
+
+        composed_ifs(const ifs &fern, unsigned int word_length);
+
+        /*  Picks a word with one random 64-bit number.                       */
+        inline std::uint32_t draw(std::uint64_t random_bits) const;
+
+        /*  The memory used by the tables, in bytes.                          */
+        inline std::size_t bytes(void) const;
+    };
+
+    /*  The probability of each map, from the cutoffs as select reads them.   */
+    inline void map_probabilities(const ifs &fern, double *probability)
+    {
+        double previous = 0.0;
+        unsigned int n;
+
+        for (n = 0U; n < fern.number_of_maps; ++n)
+        {
+            const double right = (n + 1U < fern.number_of_maps ?
+                                  fern.cutoff[n] : 100.0);
+
+            probability[n] = (right > previous ? right - previous : 0.0);
+            probability[n] *= 0.01;
+
+            if (right > previous)
+                previous = right;
+        }
+    }
+
+    /*  Composition "outer after inner", the map p -> outer(inner(p)).        */
+    inline affine compose(const affine &outer, const affine &inner)
+    {
+        affine result;
+
+        result.xx = outer.xx*inner.xx + outer.xy*inner.yx;
+        result.xy = outer.xx*inner.xy + outer.xy*inner.yy;
+        result.yx = outer.yx*inner.xx + outer.yy*inner.yx;
+        result.yy = outer.yx*inner.xy + outer.yy*inner.yy;
+        result.x_shift = outer.xx*inner.x_shift + outer.xy*inner.y_shift +
+                         outer.x_shift;
+        result.y_shift = outer.yx*inner.x_shift + outer.yy*inner.y_shift +
+                         outer.y_shift;
+
+        return result;
+    }
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      composed_length                                                   *
+     *  Purpose:                                                              *
+     *      Picks the longest word whose tables fit in a budget.              *
+     *  Arguments:                                                            *
+     *      fern (const bf::ifs &):                                           *
+     *          The maps.                                                     *
+     *      budget (std::size_t):                                             *
+     *          The most memory the tables may use, in bytes.                 *
+     *  Outputs:                                                              *
+     *      k (unsigned int):                                                 *
+     *          The word length, at least 1.                                  *
+     *  Notes:                                                                *
+     *      Each word costs k affine maps and one alias entry, so the tables  *
+     *      take m^k (48k + 8) bytes. The Barnsley fern gets k = 4, 50 kB, at *
+     *      the default budget. Longer words barely help: at 256 x 256 the    *
+     *      time per point falls from 10.8 ns with count_points to 6.4 ns at  *
+     *      k = 3 and 6.1 ns at k = 5, and rises again at k = 6, 1.2 MB.      *
+     **************************************************************************/
+    inline unsigned int
+    composed_length(const ifs &fern, std::size_t budget = composed_budget)
+    {
+        const std::uint64_t maps = (fern.number_of_maps > 1U ?
+                                    fern.number_of_maps : 2U);
+        std::uint64_t words = maps;
+        unsigned int length = 1U;
+
+        while (length < composed_max_length)
+        {
+            const std::uint64_t next_words = words * maps;
+            const std::uint64_t next_bytes =
+                next_words * ((length + 1U) * sizeof(affine) +
+                              sizeof(alias_entry));
+
+            if (next_bytes > budget)
+                break;
+
+            words = next_words;
+            ++length;
+        }
+
+        return length;
+    }
+
+    /**************************************************************************
+     *  Constructor:                                                          *
+     *      composed_ifs                                                      *
+     *  Purpose:                                                              *
+     *      Builds the compositions and the alias table for words of a given  *
+     *      length.                                                           *
+     *  Arguments:                                                            *
+     *      fern (const bf::ifs &):                                           *
+     *          The maps and probabilities.                                   *
+     *      word_length (unsigned int):                                       *
+     *          The number of maps per word, k. Zero is taken as one.         *
+     *  Outputs:                                                              *
+     *      words (bf::composed_ifs):                                         *
+     *          The tables.                                                   *
+     *  Method:                                                               *
+     *      The compositions are built word by word from the previous prefix. *
+     *      The alias table is Vose's. Every word gets a bucket of the same   *
+     *      width. A word less likely than that keeps the fraction            *
+     *      threshold / 2^32 of its bucket and gives the rest to a more       *
+     *      likely word, until every bucket is full. Drawing is then one      *
+     *      uniform bucket and one compare, whatever the number of words.     *
+     **************************************************************************/
+    inline composed_ifs::composed_ifs(const ifs &fern, unsigned int word_length)
+    {
+        const unsigned int maps = fern.number_of_maps;
+        double probability[max_maps];
+        std::vector<double> share;
+        std::vector<std::uint32_t> small, large;
+        std::uint32_t word, rest;
+        unsigned int n;
+
+        length = (word_length > 0U ? word_length : 1U);
+        number_of_words = 1U;
+
+        for (n = 0U; n < length; ++n)
+            number_of_words *= maps;
+
+        steps.resize(static_cast<std::size_t>(number_of_words) * length);
+        table.resize(number_of_words);
+        share.resize(number_of_words);
+        map_probabilities(fern, probability);
+
+        for (word = 0U; word < number_of_words; ++word)
+        {
+            affine *step = &steps[static_cast<std::size_t>(word) * length];
+            double chance = 1.0;
+
+            rest = word;
+
+            for (n = 0U; n < length; ++n)
+            {
+                const unsigned int map = rest % maps;
+
+                rest /= maps;
+                chance *= probability[map];
+
+                if (n == 0U)
+                    step[n] = fern.transform[map];
+                else
+                    step[n] = compose(fern.transform[map], step[n - 1U]);
+            }
+
+            share[word] = chance * static_cast<double>(number_of_words);
+
+            if (share[word] < 1.0)
+                small.push_back(word);
+            else
+                large.push_back(word);
+        }
+
+        while (!small.empty() && !large.empty())
+        {
+            const std::uint32_t less = small.back();
+            const std::uint32_t more = large.back();
+
+            small.pop_back();
+            table[less].threshold = static_cast<std::uint32_t>(
+                share[less] * 4294967296.0
+            );
+            table[less].alias = more;
+            share[more] -= 1.0 - share[less];
+
+            if (share[more] < 1.0)
+            {
+                large.pop_back();
+                small.push_back(more);
+            }
+        }
+
+        /*  What is left is full up to rounding, and never gives any away.    */
+        while (!large.empty())
+        {
+            table[large.back()].threshold = 0xFFFFFFFFU;
+            table[large.back()].alias = large.back();
+            large.pop_back();
+        }
+
+        while (!small.empty())
+        {
+            table[small.back()].threshold = 0xFFFFFFFFU;
+            table[small.back()].alias = small.back();
+            small.pop_back();
+        }
+    }
+
+    /*  The top 32 bits pick a bucket, the bottom 32 bits where within it.    */
+    inline std::uint32_t composed_ifs::draw(std::uint64_t random_bits) const
+    {
+        const std::uint64_t high = random_bits >> 32;
+        const std::uint32_t low = static_cast<std::uint32_t>(random_bits);
+        const std::uint32_t bucket =
+            static_cast<std::uint32_t>((high * number_of_words) >> 32);
+        const alias_entry &entry = table[bucket];
+
+        return (low < entry.threshold ? bucket : entry.alias);
+    }
+
+    inline std::size_t composed_ifs::bytes(void) const
+    {
+        return steps.size() * sizeof(affine) +
+               table.size() * sizeof(alias_entry);
+    }
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      count_points_composed                                             *
+     *  Purpose:                                                              *
+     *      The chaos game of count_points, drawing a word of k maps per      *
+     *      random number rather than one map.                                *
+     *  Arguments:                                                            *
+     *      counter (Tcounter &):                                             *
+     *          Told about every hit with add(index), like bf::plain_counter. *
+     *      words (const bf::composed_ifs &):                                 *
+     *          The words of the IFS, built once and shared by the threads.   *
+     *      v (const bf::view &):                                             *
+     *          The image size and the point-to-pixel conversion.             *
+     *      iterations (std::uint64_t):                                       *
+     *          The number of points to compute. If this is not a multiple of *
+     *          k, the last word is cut short.                                *
+     *      x_pt (double &):                                                  *
+     *          The x coordinate of the current point. Updated on return.     *
+     *      y_pt (double &):                                                  *
+     *          The y coordinate of the current point. Updated on return.     *
+     *      gen (Trng &):                                                     *
+     *          The generator, like bf::rng. Must provide next(), which       *
+     *          returns 64 random bits.                                       *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Notes:                                                                *
+     *      The points have the same distribution as from count_points, but   *
+     *      not the same values for the same generator, since the maps are    *
+     *      drawn differently. The composed maps also round differently from  *
+     *      the maps applied in turn, by a few units in the last place.       *
+     **************************************************************************/
+    template <typename Tcounter, typename Trng>
+    inline void
+    count_points_composed(Tcounter &counter, const composed_ifs &words,
+                          const view &v, std::uint64_t iterations,
+                          double &x_pt, double &y_pt, Trng &gen)
+    {
+        const std::uint64_t length = words.length;
+        const affine *step;
+        double x_start = x_pt;
+        double y_start = y_pt;
+        double x_val = x_start;
+        double y_val = y_start;
+        std::uint64_t n, count, j;
+        std::size_t index;
+
+        for (n = 0U; n < iterations; n += count)
+        {
+            count = (iterations - n < length ? iterations - n : length);
+            step = &words.steps[
+                static_cast<std::size_t>(words.draw(gen.next()) * length)
+            ];
+
+            /*  Every point of the word comes from the one it started at.     */
+            for (j = 0U; j < count; ++j)
+            {
+                x_val = x_start;
+                y_val = y_start;
+                step[j].transform(x_val, y_val);
+
+                if (v.point_to_pixel(x_val, y_val, index))
+                    counter.add(index);
+            }
+
+            x_start = x_val;
+            y_start = y_val;
+        }
+
+        x_pt = x_start;
+        y_pt = y_start;
+    }
+    /*  End of count_points_composed.                                         */
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
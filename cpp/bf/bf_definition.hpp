@@ -0,0 +1,411 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      IFS definitions read from text files at run time.                     *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_DEFINITION_HPP
+#define BF_DEFINITION_HPP
+
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::uint64_t.                                 */
+#include <cstdint>
+
+/*  FILE data type, std::fopen, std::fgets, and std::fprintf found here.      */
+#include <cstdio>
+
+/*  std::strtod found here.                                                   */
+#include <cstdlib>
+
+/*  std::strcmp, std::strchr, std::strspn, and std::strtok found here.        */
+#include <cstring>
+
+/*  The colorers, named in the file.                                          */
+#include "bf_color.hpp"
+
+/*  Affine maps and iterated function systems.                                */
+#include "bf_ifs.hpp"
+
+/*  View struct, the image size and the point-to-pixel conversion.            */
+#include "bf_view.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      ifs_definition                                                    *
+     *  Purpose:                                                              *
+     *      An IFS, the view, and the colorer, as read from a text file.      *
+     *  Notes:                                                                *
+     *      The file has one setting per line, a keyword and its values,      *
+     *      separated by whitespace. Blank lines and lines starting with #    *
+     *      are skipped. The keywords are:                                    *
+     *          map xx xy yx yy u v w   The map (x, y) -> (xx x + xy y + u,   *
+     *                                  yx x + yy y + v), drawn with weight   *
+     *                                  w. Up to 16, in order.                *
+     *          start x y               The first point, 0 1 by default.      *
+     *          size WxH                Image size, 1024x1024 by default.     *
+     *          frame x0 x1 y0 y1       The region drawn, the fern's own by   *
+     *                                  default. y1 is at the top.            *
+     *          points p                Points per pixel, 64 by default.      *
+     *          color name              grayscale, the default, or            *
+     *                                  greenscale.                           *
+     *      The weights are scaled to sum to 100 and need not do so already,  *
+     *      and maps with weight 0 are dropped. The Barnsley fern is:         *
+     *          map  0.00  0.00  0.00  0.16  0.00  0.00   1                   *
+     *          map  0.80  0.04 -0.04  0.85  0.00  1.60  85                   *
+     *          map  0.20 -0.26  0.23  0.22  0.00  1.60   7                   *
+     *          map -0.15  0.28  0.26  0.24  0.00  0.44   7                   *
+     *      which gives exactly the cutoffs and maps of bf::ifs::barnsley.    *
+     **************************************************************************/
+    struct ifs_definition {
+
+        /*  The maps, probabilities, and starting point.                      */
+        ifs fern;
+
+        /*  The image size and the region of the plane drawn.                 */
+        view v;
+
+        /*  The colorer, like bf::colorer::grayscale.                         */
+        color (*colorer)(double);
+
+        /*  Points per pixel.                                                 */
+        double points;
+
+        /*  The weights as given, before they become cutoffs.                 */
+        double weight[max_maps];
+
+        /*  The region of the plane, x0, x1, y0, y1, if a frame was given.    */
+        double frame[4];
+        bool framed;
+
+        /*  The defaults, and no maps.                                        */
+        ifs_definition(void);
+
+        /*  Reads a definition from a file, "-" for stdin.                    */
+        inline bool load(const char *name);
+
+        /*  Parses one line of a definition.                                  */
+        inline bool parse(char *text, const char *name, unsigned int line);
+
+        /*  Turns the weights into cutoffs and the frame into the view.       */
+        inline bool finish(const char *name);
+
+        /*  The number of points to draw, points per pixel times pixels.      */
+        inline std::uint64_t iterations(void) const;
+    };
+
+    /*  Setting number_of_maps to zero lets parse count the maps.             */
+    inline ifs_definition::ifs_definition(void)
+    {
+        unsigned int n;
+
+        fern = ifs();
+        fern.number_of_maps = 0U;
+        fern.xstart = setup::xstart;
+        fern.ystart = setup::ystart;
+        v = view();
+        colorer = colorer::grayscale;
+        points = static_cast<double>(setup::max_iters);
+        framed = false;
+
+        for (n = 0U; n < max_maps; ++n)
+            weight[n] = 0.0;
+
+        for (n = 0U; n < 4U; ++n)
+            frame[n] = 0.0;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      load                                                              *
+     *  Purpose:                                                              *
+     *      Reads every line of a definition and checks the result.           *
+     *  Arguments:                                                            *
+     *      name (const char *):                                              *
+     *          The file, or "-" for stdin.                                   *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if the file could not be read or is invalid. The        *
+     *          reason is reported on stderr.                                 *
+     **************************************************************************/
+    inline bool ifs_definition::load(const char *name)
+    {
+        const bool use_stdin = (std::strcmp(name, "-") == 0);
+        std::FILE * const fp = (use_stdin ? stdin : std::fopen(name, "r"));
+        char text[4096];
+        unsigned int line = 0U;
+        bool success = true;
+
+        if (!fp)
+        {
+            std::fprintf(stderr, "ERROR: could not open %s.\n", name);
+            return false;
+        }
+
+        while (success && std::fgets(text, sizeof(text), fp))
+        {
+            ++line;
+
+            if (!std::strchr(text, '\n') && !std::feof(fp))
+            {
+                std::fprintf(stderr, "ERROR: %s:%u: line too long.\n",
+                             name, line);
+                success = false;
+            }
+
+            else
+                success = parse(text, name, line);
+        }
+
+        if (!use_stdin)
+            std::fclose(fp);
+
+        return success && finish(name);
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      parse                                                             *
+     *  Purpose:                                                              *
+     *      Reads one line of a definition, see bf::ifs_definition.           *
+     *  Arguments:                                                            *
+     *      text (char *):                                                    *
+     *          The line. It is modified by std::strtok.                      *
+     *      name (const char *):                                              *
+     *          The file name, for error messages.                            *
+     *      line (unsigned int):                                              *
+     *          The line number, for error messages.                          *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          True for a valid setting or a blank or comment line.          *
+     **************************************************************************/
+    inline bool
+    ifs_definition::parse(char *text, const char *name, unsigned int line)
+    {
+        const char * const spaces = " \t\r\n";
+        const char * const first = text + std::strspn(text, spaces);
+        const char *keyword;
+        char *token, *end;
+        double value[7];
+        unsigned int count = 0U, expected = 0U;
+        unsigned int xsize, ysize;
+        bool valid = true;
+
+        /*  Blank lines and comments.                                         */
+        if (*first == '\0' || *first == '#')
+            return true;
+
+        keyword = std::strtok(text, spaces);
+        token = std::strtok(NULL, spaces);
+
+        if (std::strcmp(keyword, "size") == 0)
+        {
+            valid = (token && std::sscanf(token, "%ux%u", &xsize, &ysize) == 2
+                     && xsize > 0U && ysize > 0U);
+
+            if (valid)
+            {
+                v.xsize = xsize;
+                v.ysize = ysize;
+            }
+
+            token = std::strtok(NULL, spaces);
+        }
+
+        else if (std::strcmp(keyword, "color") == 0)
+        {
+            if (token && std::strcmp(token, "grayscale") == 0)
+                colorer = colorer::grayscale;
+
+            else if (token && std::strcmp(token, "greenscale") == 0)
+                colorer = colorer::greenscale;
+
+            else
+                valid = false;
+
+            token = std::strtok(NULL, spaces);
+        }
+
+        else
+        {
+            if (std::strcmp(keyword, "map") == 0)
+                expected = 7U;
+            else if (std::strcmp(keyword, "start") == 0)
+                expected = 2U;
+            else if (std::strcmp(keyword, "frame") == 0)
+                expected = 4U;
+            else if (std::strcmp(keyword, "points") == 0)
+                expected = 1U;
+            else
+                valid = false;
+
+            /*  Numbers must use up the whole token.                          */
+            for (; valid && token && count < expected; ++count)
+            {
+                value[count] = std::strtod(token, &end);
+                valid = (end != token && *end == '\0');
+                token = std::strtok(NULL, spaces);
+            }
+
+            valid = valid && (count == expected);
+        }
+
+        /*  Anything left over is as wrong as something missing.              */
+        if (!valid || token)
+        {
+            std::fprintf(stderr, "ERROR: %s:%u: bad \"%s\" line.\n",
+                         name, line, keyword);
+            return false;
+        }
+
+        if (expected == 7U)
+        {
+            if (fern.number_of_maps == max_maps || !(value[6] >= 0.0))
+            {
+                std::fprintf(stderr, "ERROR: %s:%u: %s.\n", name, line,
+                             (fern.number_of_maps == max_maps ?
+                              "too many maps" : "negative weight"));
+                return false;
+            }
+
+            /*  Maps with no weight would never be picked, leave them out.    */
+            if (value[6] == 0.0)
+                return true;
+
+            fern.transform[fern.number_of_maps].xx = value[0];
+            fern.transform[fern.number_of_maps].xy = value[1];
+            fern.transform[fern.number_of_maps].yx = value[2];
+            fern.transform[fern.number_of_maps].yy = value[3];
+            fern.transform[fern.number_of_maps].x_shift = value[4];
+            fern.transform[fern.number_of_maps].y_shift = value[5];
+            weight[fern.number_of_maps] = value[6];
+            ++fern.number_of_maps;
+        }
+
+        else if (expected == 2U)
+        {
+            fern.xstart = value[0];
+            fern.ystart = value[1];
+        }
+
+        else if (expected == 4U)
+        {
+            if (!(value[1] > value[0]) || !(value[3] > value[2]))
+            {
+                std::fprintf(stderr, "ERROR: %s:%u: empty frame.\n",
+                             name, line);
+                return false;
+            }
+
+            for (count = 0U; count < 4U; ++count)
+                frame[count] = value[count];
+
+            framed = true;
+        }
+
+        else if (expected == 1U)
+        {
+            if (!(value[0] > 0.0))
+            {
+                std::fprintf(stderr, "ERROR: %s:%u: points must be "
+                             "positive.\n", name, line);
+                return false;
+            }
+
+            points = value[0];
+        }
+
+        return true;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      finish                                                            *
+     *  Purpose:                                                              *
+     *      Turns the weights into cutoffs, and the size and frame into the   *
+     *      view, once every line has been read.                              *
+     *  Arguments:                                                            *
+     *      name (const char *):                                              *
+     *          The file name, for error messages.                            *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if there are no maps.                                   *
+     *  Notes:                                                                *
+     *      The cutoffs are the running sums of the weights, times 100 over   *
+     *      the total. Weights that already sum to 100 are used as they are,  *
+     *      so whole percentages give exact cutoffs. Without a frame, the     *
+     *      view is the one bf::view gives for the size.                      *
+     **************************************************************************/
+    inline bool ifs_definition::finish(const char *name)
+    {
+        double total = 0.0, sum = 0.0;
+        unsigned int n;
+
+        for (n = 0U; n < fern.number_of_maps; ++n)
+            total += weight[n];
+
+        if (fern.number_of_maps == 0U || !(total > 0.0))
+        {
+            std::fprintf(stderr, "ERROR: %s: no maps.\n", name);
+            return false;
+        }
+
+        for (n = 0U; n < fern.number_of_maps; ++n)
+        {
+            sum += weight[n];
+            fern.cutoff[n] = (total == 100.0 ? sum : 100.0 * sum / total);
+        }
+
+        for (; n < max_maps; ++n)
+            fern.cutoff[n] = 100.0;
+
+        if (!framed)
+        {
+            v = view(v.xsize, v.ysize);
+            return true;
+        }
+
+        /*  x0 goes to the left edge and y1 to the top one.                   */
+        v.xscale = static_cast<double>(v.xsize) / (frame[1] - frame[0]);
+        v.yscale = -static_cast<double>(v.ysize) / (frame[3] - frame[2]);
+        v.xshift = -frame[0] * v.xscale;
+        v.yshift = -frame[3] * v.yscale;
+        return true;
+    }
+
+    /*  Points per pixel times the number of pixels.                          */
+    inline std::uint64_t ifs_definition::iterations(void) const
+    {
+        return static_cast<std::uint64_t>(
+            points * static_cast<double>(v.number_of_pixels())
+        );
+    }
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
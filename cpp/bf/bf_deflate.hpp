@@ -0,0 +1,877 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Minimal deflate (RFC 1951) encoder with the CRC-32 and Adler-32       *
+ *      checksums needed for PNG files. Data is compressed in independent     *
+ *      pieces so that several threads can work on one image at once.         *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_DEFLATE_HPP
+#define BF_DEFLATE_HPP
+
+/*  Heap operations for building Huffman trees.                               */
+#include <algorithm>
+
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::uint32_t and std::uint64_t.               */
+#include <cstdint>
+
+/*  std::vector, used for the output buffers and the hash table.              */
+#include <vector>
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Another namespace for the compression tools.                          */
+    namespace deflate {
+
+        /*  Deflate back-references may look at most 32 KiB into the past.    */
+        static const std::size_t window_size = 32768U;
+
+        /*  Matches are between 3 and 258 bytes long.                         */
+        static const std::size_t min_match = 3U;
+        static const std::size_t max_match = 258U;
+
+        /*  Number of bits used for the hash table of 3-byte prefixes.        */
+        static const unsigned int hash_bits = 15U;
+
+        /*  Largest prime less than 2^16, the modulus for Adler-32.           */
+        static const std::uint32_t adler_base = 65521U;
+
+        /*  Lengths and distances are stored as a code plus extra bits. These *
+         *  are the base values and extra bit counts from RFC 1951.           */
+        static const unsigned short length_base[29] = {
+            3U, 4U, 5U, 6U, 7U, 8U, 9U, 10U, 11U, 13U, 15U, 17U, 19U, 23U,
+            27U, 31U, 35U, 43U, 51U, 59U, 67U, 83U, 99U, 115U, 131U, 163U,
+            195U, 227U, 258U
+        };
+
+        static const unsigned char length_extra[29] = {
+            0U, 0U, 0U, 0U, 0U, 0U, 0U, 0U, 1U, 1U, 1U, 1U, 2U, 2U, 2U, 2U,
+            3U, 3U, 3U, 3U, 4U, 4U, 4U, 4U, 5U, 5U, 5U, 5U, 0U
+        };
+
+        static const unsigned short distance_base[30] = {
+            1U, 2U, 3U, 4U, 5U, 7U, 9U, 13U, 17U, 25U, 33U, 49U, 65U, 97U,
+            129U, 193U, 257U, 385U, 513U, 769U, 1025U, 1537U, 2049U, 3073U,
+            4097U, 6145U, 8193U, 12289U, 16385U, 24577U
+        };
+
+        static const unsigned char distance_extra[30] = {
+            0U, 0U, 0U, 0U, 1U, 1U, 2U, 2U, 3U, 3U, 4U, 4U, 5U, 5U, 6U, 6U,
+            7U, 7U, 8U, 8U, 9U, 9U, 10U, 10U, 11U, 11U, 12U, 12U, 13U, 13U
+        };
+
+        /**********************************************************************
+         *  Struct:                                                           *
+         *      tables                                                        *
+         *  Purpose:                                                          *
+         *      Lookup tables computed once and shared by every thread. This  *
+         *      holds the CRC-32 table and maps from lengths and distances to *
+         *      their deflate codes.                                          *
+         **********************************************************************/
+        struct tables {
+
+            /*  CRC-32 table for the polynomial 0xEDB88320 (reversed form).   */
+            std::uint32_t crc[256];
+
+            /*  Maps a match length (3 to 258) to its length code (0 to 28).  */
+            unsigned char length_symbol[259];
+
+            /*  Maps a distance to its code. Distances up to 256 index the    *
+             *  first half directly, larger ones use (distance - 1) >> 7.     */
+            unsigned char distance_symbol[512];
+
+            /*  Constructor, fills in all of the tables.                      */
+            tables(void);
+
+            /*  Returns the shared instance, built on first use.              */
+            static inline const tables &get(void);
+        };
+
+        /*  Reverses the lowest "bits" bits of "code".                        */
+        inline unsigned int reverse_bits(unsigned int code, unsigned int bits)
+        {
+            unsigned int out = 0U;
+            unsigned int n;
+
+            for (n = 0U; n < bits; ++n)
+            {
+                out = (out << 1U) | (code & 1U);
+                code >>= 1U;
+            }
+
+            return out;
+        }
+
+        /**********************************************************************
+         *  Constructor:                                                      *
+         *      tables                                                        *
+         *  Purpose:                                                          *
+         *      Computes all of the lookup tables used by the encoder.        *
+         *  Arguments:                                                        *
+         *      None (void).                                                  *
+         *  Outputs:                                                          *
+         *      t (bf::deflate::tables):                                      *
+         *          The tables.                                               *
+         **********************************************************************/
+        inline tables::tables(void)
+        {
+            unsigned int n, k;
+
+            /*  Standard byte-at-a-time CRC-32 table.                         */
+            for (n = 0U; n < 256U; ++n)
+            {
+                std::uint32_t c = n;
+
+                for (k = 0U; k < 8U; ++k)
+                    c = (c & 1U) ? (0xEDB88320U ^ (c >> 1U)) : (c >> 1U);
+
+                crc[n] = c;
+            }
+
+            /*  Length to length-code lookup.                                 */
+            for (k = 0U; k < 29U; ++k)
+            {
+                const unsigned int end = (k == 28U ? 259U : length_base[k+1]);
+
+                for (n = length_base[k]; n < end; ++n)
+                    length_symbol[n] = static_cast<unsigned char>(k);
+            }
+
+            /*  Distance to distance-code lookup, same layout as zlib.        */
+            for (k = 0U; k < 30U; ++k)
+            {
+                const unsigned int start = distance_base[k];
+                const unsigned int end = start + (1U << distance_extra[k]);
+
+                for (n = start; n < end; ++n)
+                {
+                    if (n <= 256U)
+                        distance_symbol[n - 1U] = static_cast<unsigned char>(k);
+                    else
+                        distance_symbol[256U + ((n - 1U) >> 7U)] =
+                            static_cast<unsigned char>(k);
+                }
+            }
+        }
+
+        /*  Function-local statics are initialized once, even with threads.   */
+        inline const tables &tables::get(void)
+        {
+            static const tables shared;
+            return shared;
+        }
+
+        /**********************************************************************
+         *  Function:                                                         *
+         *      crc32                                                         *
+         *  Purpose:                                                          *
+         *      Updates a running CRC-32 checksum with more data.             *
+         *  Arguments:                                                        *
+         *      crc (std::uint32_t):                                          *
+         *          The checksum so far. Start with zero.                     *
+         *      buffer (const unsigned char *):                               *
+         *          The new data.                                             *
+         *      length (std::size_t):                                         *
+         *          The number of bytes in the buffer.                        *
+         *  Outputs:                                                          *
+         *      crc (std::uint32_t):                                          *
+         *          The updated checksum.                                     *
+         **********************************************************************/
+        inline std::uint32_t
+        crc32(std::uint32_t crc, const unsigned char *buffer,
+              std::size_t length)
+        {
+            const std::uint32_t * const table = tables::get().crc;
+            std::size_t n;
+
+            crc = ~crc;
+
+            for (n = 0U; n < length; ++n)
+                crc = table[(crc ^ buffer[n]) & 0xFFU] ^ (crc >> 8U);
+
+            return ~crc;
+        }
+
+        /**********************************************************************
+         *  Function:                                                         *
+         *      adler32                                                       *
+         *  Purpose:                                                          *
+         *      Updates a running Adler-32 checksum with more data.           *
+         *  Arguments:                                                        *
+         *      adler (std::uint32_t):                                        *
+         *          The checksum so far. Start with one.                      *
+         *      buffer (const unsigned char *):                               *
+         *          The new data.                                             *
+         *      length (std::size_t):                                         *
+         *          The number of bytes in the buffer.                        *
+         *  Outputs:                                                          *
+         *      adler (std::uint32_t):                                        *
+         *          The updated checksum.                                     *
+         *  Method:                                                           *
+         *      The modulo is only needed every 5552 bytes, the largest block *
+         *      for which the sums can not overflow 32 bits.                  *
+         **********************************************************************/
+        inline std::uint32_t
+        adler32(std::uint32_t adler, const unsigned char *buffer,
+                std::size_t length)
+        {
+            std::uint32_t a = adler & 0xFFFFU;
+            std::uint32_t b = adler >> 16U;
+
+            while (length > 0U)
+            {
+                std::size_t block = (length < 5552U ? length : 5552U);
+                length -= block;
+
+                while (block > 0U)
+                {
+                    a += *buffer;
+                    b += a;
+                    ++buffer;
+                    --block;
+                }
+
+                a %= adler_base;
+                b %= adler_base;
+            }
+
+            return a | (b << 16U);
+        }
+
+        /**********************************************************************
+         *  Function:                                                         *
+         *      adler32_combine                                               *
+         *  Purpose:                                                          *
+         *      Computes the Adler-32 checksum of two buffers placed end to   *
+         *      end from the checksums of the two pieces.                     *
+         *  Arguments:                                                        *
+         *      adler1 (std::uint32_t):                                       *
+         *          The checksum of the first buffer.                         *
+         *      adler2 (std::uint32_t):                                       *
+         *          The checksum of the second buffer.                        *
+         *      length2 (std::size_t):                                        *
+         *          The number of bytes in the second buffer.                 *
+         *  Outputs:                                                          *
+         *      adler (std::uint32_t):                                        *
+         *          The checksum of the concatenated buffers.                 *
+         *  Method:                                                           *
+         *      The low half sums bytes, so it just adds. The high half sums  *
+         *      the running low half, so the first buffer's low half is       *
+         *      counted once for each byte of the second buffer.              *
+         **********************************************************************/
+        inline std::uint32_t
+        adler32_combine(std::uint32_t adler1, std::uint32_t adler2,
+                        std::size_t length2)
+        {
+            const std::uint32_t rem =
+                static_cast<std::uint32_t>(length2 % adler_base);
+
+            std::uint32_t sum1 = adler1 & 0xFFFFU;
+            std::uint32_t sum2 = (rem * sum1) % adler_base;
+
+            sum1 += (adler2 & 0xFFFFU) + adler_base - 1U;
+            sum2 += (adler1 >> 16U) + (adler2 >> 16U) + adler_base - rem;
+
+            if (sum1 >= adler_base)
+                sum1 -= adler_base;
+
+            if (sum1 >= adler_base)
+                sum1 -= adler_base;
+
+            if (sum2 >= (adler_base << 1U))
+                sum2 -= (adler_base << 1U);
+
+            if (sum2 >= adler_base)
+                sum2 -= adler_base;
+
+            return sum1 | (sum2 << 16U);
+        }
+
+        /*  Packs variable-length codes into bytes, least significant first.  */
+        struct bit_writer {
+
+            /*  The output buffer, compressed bytes are appended to this.     */
+            std::vector<unsigned char> &out;
+
+            /*  Bits waiting to be written, and how many there are.           */
+            std::uint64_t bits;
+            unsigned int count;
+
+            /*  Constructor from the output buffer.                           */
+            bit_writer(std::vector<unsigned char> &buffer)
+                : out(buffer), bits(0U), count(0U)
+            {
+                return;
+            }
+
+            /*  Adds the lowest n bits of value to the stream.                */
+            inline void put(std::uint32_t value, unsigned int n)
+            {
+                bits |= static_cast<std::uint64_t>(value) << count;
+                count += n;
+
+                /*  Flush whole bytes once enough bits have accumulated.      */
+                if (count >= 32U)
+                {
+                    out.push_back(static_cast<unsigned char>(bits));
+                    out.push_back(static_cast<unsigned char>(bits >> 8U));
+                    out.push_back(static_cast<unsigned char>(bits >> 16U));
+                    out.push_back(static_cast<unsigned char>(bits >> 24U));
+                    bits >>= 32U;
+                    count -= 32U;
+                }
+            }
+
+            /*  Pads the stream with zeros to the next byte boundary.         */
+            inline void align(void)
+            {
+                while (count > 0U)
+                {
+                    out.push_back(static_cast<unsigned char>(bits));
+                    bits >>= 8U;
+                    count = (count > 8U ? count - 8U : 0U);
+                }
+
+                bits = 0U;
+            }
+        };
+
+        /*  A literal (distance zero) or a back-reference found by LZ77.      */
+        struct token {
+            unsigned short length;
+            unsigned short distance;
+        };
+
+        /*  Maximum number of tokens in one block before it is written out.   */
+        static const std::size_t block_tokens = 65536U;
+
+        /*  Order the code length code lengths are stored in, from RFC 1951.  */
+        static const unsigned char code_length_order[19] = {
+            16U, 17U, 18U, 0U, 8U, 7U, 9U, 6U, 10U, 5U, 11U, 4U, 12U, 3U,
+            13U, 2U, 14U, 1U, 15U
+        };
+
+        /**********************************************************************
+         *  Function:                                                         *
+         *      huffman_lengths                                               *
+         *  Purpose:                                                          *
+         *      Computes Huffman code lengths for a set of frequencies, with  *
+         *      no code longer than a given limit.                            *
+         *  Arguments:                                                        *
+         *      freq (const std::uint32_t *):                                 *
+         *          The frequency of each symbol.                             *
+         *      count (unsigned int):                                         *
+         *          The number of symbols.                                    *
+         *      limit (unsigned int):                                         *
+         *          The longest allowed code, 15 or 7 for deflate.            *
+         *      lengths (unsigned char *):                                    *
+         *          Output, the code length for each symbol. Zero means the   *
+         *          symbol is unused.                                         *
+         *  Outputs:                                                          *
+         *      None (void).                                                  *
+         *  Method:                                                           *
+         *      Build the tree by repeatedly joining the two lightest nodes.  *
+         *      If it is too deep, halve the frequencies, which flattens the  *
+         *      distribution, and try again. This is not optimal, but the     *
+         *      limit is rarely hit and the loss is tiny when it is.          *
+         **********************************************************************/
+        inline void
+        huffman_lengths(const std::uint32_t *freq, unsigned int count,
+                        unsigned int limit, unsigned char *lengths)
+        {
+            /*  Weights and parents of the leaves followed by inner nodes.    */
+            std::vector<std::uint32_t> weight(count);
+            std::vector<unsigned int> parent(2U * count);
+            std::vector<unsigned int> heap;
+            unsigned int n;
+
+            unsigned int used = 0U;
+
+            for (n = 0U; n < count; ++n)
+            {
+                weight[n] = freq[n];
+
+                if (weight[n] != 0U)
+                    ++used;
+            }
+
+            /*  A tree needs two leaves. Pad with unused symbols if needed.   */
+            for (n = 0U; used < 2U && n < count; ++n)
+            {
+                if (weight[n] == 0U)
+                {
+                    weight[n] = 1U;
+                    ++used;
+                }
+            }
+
+            for (;;)
+            {
+                /*  The inner nodes are appended after the leaves.            */
+                std::vector<std::uint32_t> node(weight);
+                unsigned int deepest = 0U;
+
+                /*  Min-heap on the node weights.                             */
+                auto heavier = [&](unsigned int a, unsigned int b)
+                {
+                    return node[a] > node[b];
+                };
+
+                heap.clear();
+
+                for (n = 0U; n < count; ++n)
+                {
+                    if (weight[n] != 0U)
+                        heap.push_back(n);
+                }
+
+                std::make_heap(heap.begin(), heap.end(), heavier);
+
+                /*  Join the two lightest nodes until one tree remains.       */
+                while (heap.size() > 1U)
+                {
+                    unsigned int a, b;
+                    const unsigned int joined =
+                        static_cast<unsigned int>(node.size());
+
+                    std::pop_heap(heap.begin(), heap.end(), heavier);
+                    a = heap.back();
+                    heap.pop_back();
+
+                    std::pop_heap(heap.begin(), heap.end(), heavier);
+                    b = heap.back();
+                    heap.pop_back();
+
+                    node.push_back(node[a] + node[b]);
+                    parent[a] = joined;
+                    parent[b] = joined;
+
+                    heap.push_back(joined);
+                    std::push_heap(heap.begin(), heap.end(), heavier);
+                }
+
+                /*  The depth of a leaf is the length of its code.            */
+                for (n = 0U; n < count; ++n)
+                {
+                    unsigned int depth = 0U;
+                    unsigned int k = n;
+
+                    if (weight[n] == 0U)
+                    {
+                        lengths[n] = 0U;
+                        continue;
+                    }
+
+                    while (k != node.size() - 1U)
+                    {
+                        k = parent[k];
+                        ++depth;
+                    }
+
+                    lengths[n] = static_cast<unsigned char>(depth);
+
+                    if (depth > deepest)
+                        deepest = depth;
+                }
+
+                if (deepest <= limit)
+                    return;
+
+                /*  Too deep, flatten the frequencies and start over.         */
+                for (n = 0U; n < count; ++n)
+                {
+                    if (weight[n] != 0U)
+                        weight[n] = (weight[n] >> 1U) | 1U;
+                }
+            }
+        }
+
+        /**********************************************************************
+         *  Function:                                                         *
+         *      huffman_codes                                                 *
+         *  Purpose:                                                          *
+         *      Computes the canonical Huffman codes for a set of lengths.    *
+         *  Arguments:                                                        *
+         *      lengths (const unsigned char *):                              *
+         *          The code length for each symbol.                          *
+         *      count (unsigned int):                                         *
+         *          The number of symbols.                                    *
+         *      codes (unsigned short *):                                     *
+         *          Output, the code for each symbol. These are bit-reversed  *
+         *          since deflate packs Huffman codes most significant bit    *
+         *          first while bit_writer works least significant bit first. *
+         *  Outputs:                                                          *
+         *      None (void).                                                  *
+         **********************************************************************/
+        inline void
+        huffman_codes(const unsigned char *lengths, unsigned int count,
+                      unsigned short *codes)
+        {
+            unsigned int bl_count[16] = {0U};
+            unsigned int next_code[16] = {0U};
+            unsigned int n, code = 0U;
+
+            for (n = 0U; n < count; ++n)
+                ++bl_count[lengths[n]];
+
+            bl_count[0] = 0U;
+
+            for (n = 1U; n < 16U; ++n)
+            {
+                code = (code + bl_count[n - 1U]) << 1U;
+                next_code[n] = code;
+            }
+
+            for (n = 0U; n < count; ++n)
+            {
+                if (lengths[n] == 0U)
+                    continue;
+
+                codes[n] = static_cast<unsigned short>(
+                    reverse_bits(next_code[lengths[n]], lengths[n])
+                );
+
+                ++next_code[lengths[n]];
+            }
+        }
+
+        /**********************************************************************
+         *  Function:                                                         *
+         *      write_block                                                   *
+         *  Purpose:                                                          *
+         *      Writes a block of LZ77 tokens using dynamic Huffman codes.    *
+         *  Arguments:                                                        *
+         *      tokens (const std::vector<token> &):                          *
+         *          The literals and back-references in the block.            *
+         *      final (bool):                                                 *
+         *          Boolean for whether or not this is the last block.        *
+         *      writer (bit_writer &):                                        *
+         *          The output stream.                                        *
+         *  Outputs:                                                          *
+         *      None (void).                                                  *
+         *  Method:                                                           *
+         *      Count how often each literal / length and distance symbol     *
+         *      occurs and build codes from these. The code lengths are run   *
+         *      length encoded with symbols 16, 17, and 18, and these are in  *
+         *      turn Huffman coded. See section 3.2.7 of RFC 1951.            *
+         **********************************************************************/
+        inline void
+        write_block(const std::vector<token> &tokens, bool final,
+                    bit_writer &writer)
+        {
+            const tables &t = tables::get();
+
+            std::uint32_t lfreq[286] = {0U}, dfreq[30] = {0U}, cfreq[19] = {0U};
+            unsigned char llen[286], dlen[30], clen[19];
+            unsigned short lcode[286], dcode[30], ccode[19];
+
+            /*  The run length encoded code lengths and their extra bits.     */
+            unsigned char all[316], rle[316], extra[316];
+            unsigned int hlit = 286U, hdist = 30U, hclen = 19U;
+            unsigned int n, k, runs = 0U;
+
+            /*  Gather the statistics for the block.                          */
+            for (n = 0U; n < tokens.size(); ++n)
+            {
+                if (tokens[n].distance == 0U)
+                    ++lfreq[tokens[n].length];
+                else
+                {
+                    const unsigned int d = tokens[n].distance;
+                    ++lfreq[257U + t.length_symbol[tokens[n].length]];
+                    ++dfreq[d <= 256U ? t.distance_symbol[d - 1U] :
+                                        t.distance_symbol[256U + ((d-1U)>>7U)]];
+                }
+            }
+
+            /*  End of block is always used. Giving the first two distance    *
+             *  codes a count keeps both trees complete, which every decoder  *
+             *  accepts, even when there are no back-references at all.       */
+            lfreq[256] = 1U;
+            dfreq[0] |= 1U;
+            dfreq[1] |= 1U;
+
+            huffman_lengths(lfreq, 286U, 15U, llen);
+            huffman_lengths(dfreq, 30U, 15U, dlen);
+            huffman_codes(llen, 286U, lcode);
+            huffman_codes(dlen, 30U, dcode);
+
+            /*  Trailing unused codes need not be sent.                       */
+            while (hlit > 257U && llen[hlit - 1U] == 0U)
+                --hlit;
+
+            while (hdist > 1U && dlen[hdist - 1U] == 0U)
+                --hdist;
+
+            for (n = 0U; n < hlit; ++n)
+                all[n] = llen[n];
+
+            for (n = 0U; n < hdist; ++n)
+                all[hlit + n] = dlen[n];
+
+            /*  Run length encode the combined list of lengths.               */
+            n = 0U;
+            while (n < hlit + hdist)
+            {
+                const unsigned char value = all[n];
+                unsigned int run = 1U;
+
+                while (n + run < hlit + hdist && all[n + run] == value)
+                    ++run;
+
+                n += run;
+
+                /*  Runs of zeros use 17 (3 to 10 zeros) and 18 (11 to 138).  */
+                if (value == 0U)
+                {
+                    while (run >= 11U)
+                    {
+                        k = (run < 138U ? run : 138U);
+                        rle[runs] = 18U;
+                        extra[runs++] = static_cast<unsigned char>(k - 11U);
+                        run -= k;
+                    }
+
+                    if (run >= 3U)
+                    {
+                        rle[runs] = 17U;
+                        extra[runs++] = static_cast<unsigned char>(run - 3U);
+                        run = 0U;
+                    }
+                }
+
+                /*  Other runs send the length once, then repeat it with 16.  */
+                else
+                {
+                    rle[runs] = value;
+                    extra[runs++] = 0U;
+                    --run;
+
+                    while (run >= 3U)
+                    {
+                        k = (run < 6U ? run : 6U);
+                        rle[runs] = 16U;
+                        extra[runs++] = static_cast<unsigned char>(k - 3U);
+                        run -= k;
+                    }
+                }
+
+                /*  Whatever is left is too short for a repeat code.          */
+                while (run > 0U)
+                {
+                    rle[runs] = value;
+                    extra[runs++] = 0U;
+                    --run;
+                }
+            }
+
+            for (n = 0U; n < runs; ++n)
+                ++cfreq[rle[n]];
+
+            huffman_lengths(cfreq, 19U, 7U, clen);
+            huffman_codes(clen, 19U, ccode);
+
+            while (hclen > 4U && clen[code_length_order[hclen - 1U]] == 0U)
+                --hclen;
+
+            /*  Block header. BFINAL bit followed by BTYPE = 10, dynamic.     */
+            writer.put(final ? 1U : 0U, 1U);
+            writer.put(2U, 2U);
+            writer.put(hlit - 257U, 5U);
+            writer.put(hdist - 1U, 5U);
+            writer.put(hclen - 4U, 4U);
+
+            for (n = 0U; n < hclen; ++n)
+                writer.put(clen[code_length_order[n]], 3U);
+
+            for (n = 0U; n < runs; ++n)
+            {
+                writer.put(ccode[rle[n]], clen[rle[n]]);
+
+                if (rle[n] == 16U)
+                    writer.put(extra[n], 2U);
+                else if (rle[n] == 17U)
+                    writer.put(extra[n], 3U);
+                else if (rle[n] == 18U)
+                    writer.put(extra[n], 7U);
+            }
+
+            /*  The compressed data itself.                                   */
+            for (n = 0U; n < tokens.size(); ++n)
+            {
+                const unsigned int length = tokens[n].length;
+                const unsigned int d = tokens[n].distance;
+
+                if (d == 0U)
+                {
+                    writer.put(lcode[length], llen[length]);
+                    continue;
+                }
+
+                const unsigned int lsym = t.length_symbol[length];
+                const unsigned int dsym = (d <= 256U ?
+                    t.distance_symbol[d - 1U] :
+                    t.distance_symbol[256U + ((d - 1U) >> 7U)]);
+
+                writer.put(lcode[257U + lsym], llen[257U + lsym]);
+                writer.put(length - length_base[lsym], length_extra[lsym]);
+                writer.put(dcode[dsym], dlen[dsym]);
+                writer.put(d - distance_base[dsym], distance_extra[dsym]);
+            }
+
+            /*  End-of-block symbol.                                          */
+            writer.put(lcode[256], llen[256]);
+        }
+
+        /**********************************************************************
+         *  Function:                                                         *
+         *      compress                                                      *
+         *  Purpose:                                                          *
+         *      Compresses a buffer into one or more deflate blocks. The      *
+         *      result does not reference data outside of the buffer and ends *
+         *      on a byte boundary, so the outputs for consecutive buffers    *
+         *      can be glued together into a single deflate stream.           *
+         *  Arguments:                                                        *
+         *      in (const unsigned char *):                                   *
+         *          The data to be compressed.                                *
+         *      length (std::size_t):                                         *
+         *          The number of bytes in the input.                         *
+         *      last (bool):                                                  *
+         *          Boolean for whether or not this is the end of the stream. *
+         *      out (std::vector<unsigned char> &):                           *
+         *          The compressed bytes are appended to this.                *
+         *  Outputs:                                                          *
+         *      None (void).                                                  *
+         *  Method:                                                           *
+         *      Greedy LZ77 using a single-entry hash table of 3-byte         *
+         *      prefixes, written as dynamic Huffman blocks. Rendered ferns   *
+         *      are dominated by long runs of the background color, which     *
+         *      this handles with back-references of the maximum length. If   *
+         *      "last" is false the piece is finished with an empty stored    *
+         *      block (the same trick pigz uses) so that it ends on a byte    *
+         *      boundary without ending the stream.                           *
+         **********************************************************************/
+        inline void
+        compress(const unsigned char *in, std::size_t length, bool last,
+                 std::vector<unsigned char> &out)
+        {
+            /*  Most recent position of each hashed 3-byte prefix. Positions  *
+             *  are stored shifted by one so zero means "empty".              */
+            std::vector<std::uint32_t> head(std::size_t(1) << hash_bits, 0U);
+
+            /*  Tokens for the block currently being built.                   */
+            std::vector<token> tokens;
+
+            std::size_t pos = 0U;
+            bit_writer writer(out);
+
+            tokens.reserve(block_tokens);
+
+            while (pos < length)
+            {
+                token next;
+                std::size_t match = 0U;
+
+                /*  The last one or two bytes can not start a match.          */
+                if (pos + min_match <= length)
+                {
+                    const std::uint32_t prefix =
+                        (static_cast<std::uint32_t>(in[pos]) << 16U) |
+                        (static_cast<std::uint32_t>(in[pos + 1U]) << 8U) |
+                         static_cast<std::uint32_t>(in[pos + 2U]);
+
+                    const std::uint32_t hash =
+                        (prefix * 2654435761U) >> (32U - hash_bits);
+
+                    const std::size_t candidate = head[hash];
+                    head[hash] = static_cast<std::uint32_t>(pos + 1U);
+
+                    /*  Check the candidate is in range and really matches.   */
+                    if (candidate != 0U && pos + 1U - candidate <= window_size)
+                    {
+                        const unsigned char *prev = in + (candidate - 1U);
+                        const std::size_t room = length - pos;
+                        const std::size_t limit = (room < max_match ?
+                                                   room : max_match);
+
+                        while (match < limit && prev[match] == in[pos + match])
+                            ++match;
+
+                        next.distance = static_cast<unsigned short>(
+                            pos + 1U - candidate
+                        );
+                    }
+                }
+
+                /*  Store a back-reference if a match was found.              */
+                if (match >= min_match)
+                {
+                    next.length = static_cast<unsigned short>(match);
+                    pos += match;
+                }
+
+                /*  Otherwise store the byte as a literal.                    */
+                else
+                {
+                    next.length = in[pos];
+                    next.distance = 0U;
+                    ++pos;
+                }
+
+                tokens.push_back(next);
+
+                /*  Flush full blocks. The final one is written below.        */
+                if (tokens.size() == block_tokens && pos < length)
+                {
+                    write_block(tokens, false, writer);
+                    tokens.clear();
+                }
+            }
+
+            write_block(tokens, last, writer);
+
+            /*  Empty stored block to reach a byte boundary mid-stream.       */
+            if (!last)
+            {
+                writer.put(0U, 3U);
+                writer.align();
+                out.push_back(0x00U);
+                out.push_back(0x00U);
+                out.push_back(0xFFU);
+                out.push_back(0xFFU);
+            }
+            else
+                writer.align();
+        }
+        /*  End of compress.                                                  */
+    }
+    /*  End of namespace "deflate".                                           */
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -30,14 +30,47 @@
 /*  rand() function is provided here.                                         */
 #include <cstdlib>
 
+/*  Fixed-width integer types, std::uint32_t and std::uint64_t.               */
+#include <cstdint>
+
+/*  Affine maps and iterated function systems.                                */
+#include "bf_ifs.hpp"
+
 /*  Parameters for the output PPM, such as number of pixels, given here.      */
 #include "bf_setup.hpp"
 
+/*  Image size and the point-to-pixel conversion.                             */
+#include "bf_view.hpp"
+
 /*  Namespace for the mini-project. "Barnsley Fractal."                       */
 namespace bf {
 
-    /*  Computes the values for the Barnsley fern.                            */
-    inline void create_fern(double *data)
+    /**************************************************************************
+     *  Function:                                                             *
+     *      create_fern                                                       *
+     *  Purpose:                                                              *
+     *      Runs a given number of iterations of the Barnsley fern, picking   *
+     *      up from the point (x_pt, y_pt).                                   *
+     *  Arguments:                                                            *
+     *      data (double *):                                                  *
+     *          The buffer the hits are added to.                             *
+     *      iterations (unsigned int):                                        *
+     *          The number of points to compute.                              *
+     *      x_pt (double &):                                                  *
+     *          The x coordinate of the current point. Updated on return.     *
+     *      y_pt (double &):                                                  *
+     *          The y coordinate of the current point. Updated on return.     *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Notes:                                                                *
+     *      Splitting a render into several calls gives the same result as    *
+     *      one call with the combined number of iterations. The point is     *
+     *      copied to local variables, otherwise the compiler must assume the *
+     *      writes to data may change it and reload it on every iteration.    *
+     **************************************************************************/
+    inline void
+    create_fern(double *data, unsigned int iterations,
+                double &x_pt, double &y_pt)
     {
         /*  Scale factor to convert random numbers to fall between 0 and 100. */
         const double scale_factor = 100.0 / static_cast<double>(RAND_MAX);
@@ -46,11 +79,11 @@ namespace bf {
         unsigned int n, index;
 
         /*  The variables for the fern itself.                                */
-        double x_val = setup::xstart;
-        double y_val = setup::ystart;
+        double x_val = x_pt;
+        double y_val = y_pt;
 
         /*  Loop over and create the fern.                                    */
-        for (n = 0U; n < setup::total; ++n)
+        for (n = 0U; n < iterations; ++n)
         {
             /*  Get a random integer using the standard library function.     */
             const int rint = std::rand();
@@ -89,8 +122,181 @@ namespace bf {
             data[index] += 1.0;
         }
         /*  End of for-loop over n.                                           */
+
+        /*  Save the current point so the caller can continue from here.      */
+        x_pt = x_val;
+        y_pt = y_val;
+    }
+    /*  End of create_fern.                                                   */
+
+    /*  Computes the values for the Barnsley fern.                            */
+    inline void create_fern(double *data)
+    {
+        /*  The variables for the fern itself.                                */
+        double x_val = setup::xstart;
+        double y_val = setup::ystart;
+
+        create_fern(data, setup::total, x_val, y_val);
     }
     /*  End of bf_create_fern.                                                */
+
+    /*  Random numbers from std::rand, scaled to [0, 100] like bf::run does.  */
+    struct stdlib_rng {
+        inline double percent(void)
+        {
+            const double scale_factor = 100.0 / static_cast<double>(RAND_MAX);
+            return static_cast<double>(std::rand()) * scale_factor;
+        }
+    };
+
+    /*  Probe that records nothing. Its empty methods are inlined away, so    *
+     *  uninstrumented renders pay nothing for the instrumentation hooks.     */
+    struct no_probe {
+        inline void selected(unsigned int) {}
+        inline void rejected(void) {}
+    };
+
+    /*  Counter that adds hits straight to an array of counts.                */
+    struct plain_counter {
+        std::uint32_t *counts;
+
+        explicit plain_counter(std::uint32_t *data) : counts(data) {}
+
+        inline void add(std::size_t index)
+        {
+            ++counts[index];
+        }
+    };
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      count_points                                                      *
+     *  Purpose:                                                              *
+     *      Runs the chaos game for an arbitrary IFS and view, handing the    *
+     *      pixel of every point to a counter.                                *
+     *  Arguments:                                                            *
+     *      counter (Tcounter &):                                             *
+     *          Told about every hit with add(index). Like bf::plain_counter, *
+     *          or the shared counters of bf_shared.hpp.                      *
+     *      fern (const bf::ifs &):                                           *
+     *          The maps and probabilities.                                   *
+     *      v (const bf::view &):                                             *
+     *          The image size and the point-to-pixel conversion.             *
+     *      iterations (std::uint64_t):                                       *
+     *          The number of points to compute.                              *
+     *      x_pt (double &):                                                  *
+     *          The x coordinate of the current point. Updated on return.     *
+     *      y_pt (double &):                                                  *
+     *          The y coordinate of the current point. Updated on return.     *
+     *      gen (Trng &):                                                     *
+     *          The generator, like bf::rng. Must provide percent(), which    *
+     *          returns a number in [0, 100).                                 *
+     *      probe (Tprobe &):                                                 *
+     *          Told about every map chosen, with selected(n), and every      *
+     *          point off of the image, with rejected(). See bf_stats.hpp.    *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     **************************************************************************/
+    template <typename Tcounter, typename Trng, typename Tprobe>
+    inline void
+    count_points(Tcounter &counter, const ifs &fern, const view &v,
+                 std::uint64_t iterations, double &x_pt, double &y_pt,
+                 Trng &gen, Tprobe &probe)
+    {
+        /*  Variables for indexing and looping over pixels in the fern.       */
+        std::uint64_t n;
+        std::size_t index;
+
+        /*  Local copies of the point, see the notes for the first version.   */
+        double x_val = x_pt;
+        double y_val = y_pt;
+
+        /*  Loop over and create the fern.                                    */
+        for (n = 0U; n < iterations; ++n)
+        {
+            const unsigned int map = fern.select(gen.percent());
+
+            probe.selected(map);
+            fern.transform[map].transform(x_val, y_val);
+
+            /*  Get the pixel x_val and y_val correspond to, if any.          */
+            if (v.point_to_pixel(x_val, y_val, index))
+                counter.add(index);
+            else
+                probe.rejected();
+        }
+        /*  End of for-loop over n.                                           */
+
+        /*  Save the current point so the caller can continue from here.      */
+        x_pt = x_val;
+        y_pt = y_val;
+    }
+    /*  End of count_points.                                                  */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      create_fern                                                       *
+     *  Purpose:                                                              *
+     *      Runs the chaos game for an arbitrary IFS and view, counting the   *
+     *      number of hits for each pixel.                                    *
+     *  Arguments:                                                            *
+     *      counts (std::uint32_t *):                                         *
+     *          The hit counts, one per pixel of the view.                    *
+     *      fern, v, iterations, x_pt, y_pt, gen, probe:                      *
+     *          As for count_points.                                          *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     **************************************************************************/
+    template <typename Trng, typename Tprobe>
+    inline void
+    create_fern(std::uint32_t *counts, const ifs &fern, const view &v,
+                std::uint64_t iterations, double &x_pt, double &y_pt,
+                Trng &gen, Tprobe &probe)
+    {
+        plain_counter counter(counts);
+        count_points(counter, fern, v, iterations, x_pt, y_pt, gen, probe);
+    }
+    /*  End of create_fern.                                                   */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      create_fern                                                       *
+     *  Purpose:                                                              *
+     *      Same as the previous function, without a probe.                   *
+     *  Notes:                                                                *
+     *      std::rand has one hidden state shared by the whole program, so    *
+     *      only one thread can use it at a time. Giving each thread its own  *
+     *      generator lets several renders run at once.                       *
+     **************************************************************************/
+    template <typename Trng>
+    inline void
+    create_fern(std::uint32_t *counts, const ifs &fern, const view &v,
+                std::uint64_t iterations, double &x_pt, double &y_pt,
+                Trng &gen)
+    {
+        no_probe probe;
+        create_fern(counts, fern, v, iterations, x_pt, y_pt, gen, probe);
+    }
+    /*  End of create_fern.                                                   */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      create_fern                                                       *
+     *  Purpose:                                                              *
+     *      Same as the previous function, using std::rand for the numbers.   *
+     *  Notes:                                                                *
+     *      With ifs::barnsley and the default view the counts agree with the *
+     *      values that bf::run computes. Points landing off the image are    *
+     *      skipped rather than written out of bounds.                        *
+     **************************************************************************/
+    inline void
+    create_fern(std::uint32_t *counts, const ifs &fern, const view &v,
+                std::uint64_t iterations, double &x_pt, double &y_pt)
+    {
+        stdlib_rng gen;
+        create_fern(counts, fern, v, iterations, x_pt, y_pt, gen);
+    }
+    /*  End of create_fern.                                                   */
 }
 /*  End of namespace "bf".                                                    */
 
@@ -0,0 +1,318 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Fern kernel in fixed-point pixel coordinates, the maps conjugated by  *
+ *      the view so the pixel is a shift of the point.                        *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_FIXED_HPP
+#define BF_FIXED_HPP
+
+/*  std::ldexp and std::floor found here.                                     */
+#include <cmath>
+
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::int32_t and std::int64_t.                 */
+#include <cstdint>
+
+/*  Affine maps and iterated function systems.                                */
+#include "bf_ifs.hpp"
+
+/*  View struct, the image size and the point-to-pixel conversion.            */
+#include "bf_view.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Fraction bits of the coefficients of a bf::fixed_affine.              */
+    const int fixed_coefficient_bits = 28;
+
+    /*  Fraction bits and integer bits, with sign, of a fixed-point point.    */
+    const int fixed_point_bits = 31;
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      fixed_affine                                                      *
+     *  Purpose:                                                              *
+     *      An affine map on fixed-point pixel coordinates.                   *
+     *  Notes:                                                                *
+     *      The coefficients have fixed_coefficient_bits fraction bits, so    *
+     *      must be less than 8 in size. The shifts have those and the        *
+     *      fraction bits of the point, and carry half a unit so the shift    *
+     *      down rounds. The products are 64 bits wide. This relies on >> of  *
+     *      a negative number shifting in ones, which C++11 leaves to the     *
+     *      compiler and every compiler for the targets we build on does.     *
+     **************************************************************************/
+    struct fixed_affine {
+        std::int64_t xx, xy, yx, yy;
+        std::int64_t x_shift, y_shift;
+
+        inline void transform(std::int32_t &x, std::int32_t &y) const
+        {
+            const std::int64_t x_old = x;
+            const std::int64_t y_old = y;
+            const std::int64_t x_new = xx*x_old + xy*y_old + x_shift;
+            const std::int64_t y_new = yx*x_old + yy*y_old + y_shift;
+            x = static_cast<std::int32_t>(x_new >> fixed_coefficient_bits);
+            y = static_cast<std::int32_t>(y_new >> fixed_coefficient_bits);
+        }
+    };
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      fixed_ifs                                                         *
+     *  Purpose:                                                              *
+     *      An IFS moved to the pixel coordinates of a view, in fixed point.  *
+     *  Notes:                                                                *
+     *      If D = diag(xscale, yscale) and s = (xshift, yshift), a point p   *
+     *      is at pixel D p + s, and the map p -> A p + b becomes             *
+     *      q -> M q + D b + s - M s, with M = D A D^-1, on pixels. The       *
+     *      pixel of q is then q itself with the fraction bits shifted off.   *
+     *      The point has fixed_point_bits minus enough bits for the larger   *
+     *      side of the image and three more as fraction bits, so points up   *
+     *      to about eight image sizes off the image are kept. A point        *
+     *      further off wraps around; the maps of a fern are contractions     *
+     *      and no point of a walk that started near it gets that far.        *
+     *      The cutoffs stay double and the map is picked as in               *
+     *      bf::ifs::select, so the same generator picks the same maps as     *
+     *      the double kernel.                                                *
+     **************************************************************************/
+    struct fixed_ifs {
+        unsigned int number_of_maps;
+        double cutoff[max_maps];
+        fixed_affine transform[max_maps];
+        unsigned int xsize, ysize;
+        int fraction_bits;
+        view frame;
+
+        fixed_ifs(const ifs &fern, const view &v);
+
+        inline unsigned int select(double random_value) const
+        {
+            unsigned int n = 0U;
+
+            while (n + 1U < number_of_maps && random_value >= cutoff[n])
+                ++n;
+
+            return n;
+        }
+
+        /*  Converts a point in the plane to fixed-point pixel coordinates.   */
+        inline void
+        to_fixed(double xpt, double ypt,
+                 std::int32_t &x, std::int32_t &y) const;
+
+        /*  Converts fixed-point pixel coordinates back to the plane.         */
+        inline void
+        to_point(std::int32_t x, std::int32_t y,
+                 double &xpt, double &ypt) const;
+    };
+
+    /*  Rounds a real number to the nearest integer, saturating at the ends.  */
+    inline std::int64_t fixed_round(double value, double limit)
+    {
+        if (!(value > -limit))
+            return static_cast<std::int64_t>(-limit);
+
+        if (!(value < limit))
+            return static_cast<std::int64_t>(limit);
+
+        return static_cast<std::int64_t>(std::floor(value + 0.5));
+    }
+
+    /**************************************************************************
+     *  Constructor:                                                          *
+     *      fixed_ifs                                                         *
+     *  Purpose:                                                              *
+     *      Conjugates the maps of an IFS by the view and rounds them to      *
+     *      fixed point.                                                      *
+     *  Arguments:                                                            *
+     *      fern (const bf::ifs &):                                           *
+     *          The maps and probabilities.                                   *
+     *      v (const bf::view &):                                             *
+     *          The image size and the map from the plane to the pixels.      *
+     *  Outputs:                                                              *
+     *      maps (bf::fixed_ifs):                                             *
+     *          The maps on fixed-point pixel coordinates.                    *
+     **************************************************************************/
+    inline fixed_ifs::fixed_ifs(const ifs &fern, const view &v)
+    {
+        const unsigned int side = (v.xsize > v.ysize ? v.xsize : v.ysize);
+        const double limit = std::ldexp(1.0, 62);
+        double one, unit, half;
+        int side_bits = 0;
+        unsigned int n;
+
+        while (side_bits < 28 && (1U << side_bits) < side)
+            ++side_bits;
+
+        number_of_maps = fern.number_of_maps;
+        xsize = v.xsize;
+        ysize = v.ysize;
+        frame = v;
+        fraction_bits = fixed_point_bits - side_bits - 3;
+        one = std::ldexp(1.0, fixed_coefficient_bits);
+        unit = std::ldexp(1.0, fixed_coefficient_bits + fraction_bits);
+        half = 0.5 * one;
+
+        for (n = 0U; n < max_maps; ++n)
+        {
+            const affine &T = fern.transform[n];
+            const double xx = T.xx;
+            const double xy = v.xscale * T.xy / v.yscale;
+            const double yx = v.yscale * T.yx / v.xscale;
+            const double yy = T.yy;
+            const double x_shift =
+                v.xscale*T.x_shift + v.xshift - xx*v.xshift - xy*v.yshift;
+            const double y_shift =
+                v.yscale*T.y_shift + v.yshift - yx*v.xshift - yy*v.yshift;
+
+            cutoff[n] = fern.cutoff[n];
+
+            transform[n].xx = fixed_round(one * xx, limit);
+            transform[n].xy = fixed_round(one * xy, limit);
+            transform[n].yx = fixed_round(one * yx, limit);
+            transform[n].yy = fixed_round(one * yy, limit);
+            transform[n].x_shift = fixed_round(unit*x_shift + half,
+                                               limit);
+            transform[n].y_shift = fixed_round(unit*y_shift + half,
+                                               limit);
+        }
+    }
+
+    /*  Pixel = shift + scale * point, with the fraction bits kept.           */
+    inline void
+    fixed_ifs::to_fixed(double xpt, double ypt,
+                        std::int32_t &x, std::int32_t &y) const
+    {
+        const double limit = std::ldexp(1.0, fixed_point_bits) - 1.0;
+        const double xpx = frame.xshift + frame.xscale*xpt;
+        const double ypx = frame.yshift + frame.yscale*ypt;
+
+        x = static_cast<std::int32_t>(
+            fixed_round(std::ldexp(xpx, fraction_bits), limit)
+        );
+
+        y = static_cast<std::int32_t>(
+            fixed_round(std::ldexp(ypx, fraction_bits), limit)
+        );
+    }
+
+    /*  The inverse of to_fixed, up to rounding.                              */
+    inline void
+    fixed_ifs::to_point(std::int32_t x, std::int32_t y,
+                        double &xpt, double &ypt) const
+    {
+        const double xpx = std::ldexp(static_cast<double>(x), -fraction_bits);
+        const double ypx = std::ldexp(static_cast<double>(y), -fraction_bits);
+
+        xpt = (xpx - frame.xshift) / frame.xscale;
+        ypt = (ypx - frame.yshift) / frame.yscale;
+    }
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      count_points_fixed                                                *
+     *  Purpose:                                                              *
+     *      The chaos game of count_points in fixed-point pixel coordinates.  *
+     *  Arguments:                                                            *
+     *      counter (Tcounter &):                                             *
+     *          Told about every hit with add(index), like bf::plain_counter. *
+     *      fern (const bf::ifs &):                                           *
+     *          The maps and probabilities.                                   *
+     *      v (const bf::view &):                                             *
+     *          The image size and the map from the plane to the pixels.      *
+     *      iterations (std::uint64_t):                                       *
+     *          The number of points to compute.                              *
+     *      x_pt (double &):                                                  *
+     *          The x coordinate of the current point. Updated on return.     *
+     *      y_pt (double &):                                                  *
+     *          The y coordinate of the current point. Updated on return.     *
+     *      gen (Trng &):                                                     *
+     *          The generator, like bf::rng.                                  *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Method:                                                               *
+     *      The maps are moved to pixel coordinates by bf::fixed_ifs, and     *
+     *      the point is moved there once at the start and back at the end.   *
+     *      In between, the column and row are the point shifted right by     *
+     *      the fraction bits. Negative values become large once unsigned,    *
+     *      so one compare per axis also rejects points left of or above the  *
+     *      image. There is no conversion between reals and integers in the   *
+     *      loop, and no floating point arithmetic on the point.              *
+     *  Notes:                                                                *
+     *      The image is the same as from count_points up to rounding, which  *
+     *      is finer than float's at the sizes we render. validate_kernel     *
+     *      with bf::fixed_kernel says if the image changes at a given size.  *
+     *      As with float, on x86-64 this is about as fast as the double      *
+     *      kernel, since the loop is bound by the generator, picking the     *
+     *      map, and adding the hit. It pays off where conversions or double  *
+     *      arithmetic are slow, and the all-integer loop is the one to run   *
+     *      in integer SIMD lanes where those are wider than double ones.     *
+     **************************************************************************/
+    template <typename Tcounter, typename Trng>
+    inline void
+    count_points_fixed(Tcounter &counter, const ifs &fern, const view &v,
+                       std::uint64_t iterations, double &x_pt, double &y_pt,
+                       Trng &gen)
+    {
+        const fixed_ifs maps(fern, v);
+        const int bits = maps.fraction_bits;
+        std::int32_t x_val, y_val;
+        std::uint32_t col, row;
+        std::uint64_t n;
+
+        maps.to_fixed(x_pt, y_pt, x_val, y_val);
+
+        for (n = 0U; n < iterations; ++n)
+        {
+            maps.transform[maps.select(gen.percent())].transform(x_val, y_val);
+            col = static_cast<std::uint32_t>(x_val >> bits);
+            row = static_cast<std::uint32_t>(y_val >> bits);
+
+            if (col < maps.xsize && row < maps.ysize)
+                counter.add(col + static_cast<std::size_t>(row) * maps.xsize);
+        }
+
+        maps.to_point(x_val, y_val, x_pt, y_pt);
+    }
+    /*  End of count_points_fixed.                                            */
+
+    /*  count_points_fixed as a function object, for validate_kernel.         */
+    struct fixed_kernel {
+        template <typename Tcounter, typename Trng>
+        inline void
+        operator () (Tcounter &counter, const ifs &fern, const view &v,
+                     std::uint64_t iterations, double &x_pt, double &y_pt,
+                     Trng &gen) const
+        {
+            count_points_fixed(counter, fern, v, iterations, x_pt, y_pt, gen);
+        }
+    };
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
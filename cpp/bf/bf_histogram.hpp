@@ -0,0 +1,618 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Provides a struct for hit-count histograms and a compact binary file  *
+ *      format for them, so a render can be colored many times over.          *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_HISTOGRAM_HPP
+#define BF_HISTOGRAM_HPP
+
+/*  File data type found here.                                                */
+#include <cstdio>
+
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::uint32_t and std::uint64_t.               */
+#include <cstdint>
+
+/*  std::free is found here.                                                  */
+#include <cstdlib>
+
+/*  std::memcmp and std::memcpy are found here.                               */
+#include <cstring>
+
+/*  POSIX mmap, used for loading histograms without copying them, and         *
+ *  posix_memalign for allocating them.                                       */
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/*  Basic color struct, the tone mapper returns these.                        */
+#include "bf_color.hpp"
+
+/*  Main function for generating the Barnsley fern provided here.             */
+#include "bf_fern.hpp"
+
+/*  Affine maps and iterated function systems.                                */
+#include "bf_ifs.hpp"
+
+/*  Threading helpers, used to color the image in parallel.                   */
+#include "bf_parallel.hpp"
+
+/*  Seeded generator for render, independent of std::rand.                    */
+#include "bf_rng.hpp"
+
+/*  Image size and the point-to-pixel conversion.                             */
+#include "bf_view.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Current version of the file format. Bump this if the layout changes.  */
+    static const std::uint32_t histogram_version = 1U;
+
+    /*  Identifiers for the random number generator used for a render.        */
+    static const std::uint32_t histogram_rng_stdlib = 0U;
+    static const std::uint32_t histogram_rng_xoshiro = 1U;
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      histogram_header                                                  *
+     *  Purpose:                                                              *
+     *      The first 1024 bytes of a histogram file. Everything needed to    *
+     *      reproduce the render is stored here, followed by xsize * ysize    *
+     *      32-bit counts in row-major order.                                 *
+     *  Notes:                                                                *
+     *      The header is written as-is, in the byte order of the machine.    *
+     *      byte_order holds 0x01020304 so that a file from a machine of the  *
+     *      other endianness is rejected rather than misread. The size is a   *
+     *      multiple of 64, so the counts in an mmap'd file are aligned for   *
+     *      any SIMD loads.                                                   *
+     **************************************************************************/
+    struct histogram_header {
+
+        /*  "BFHIST" followed by two zeros.                                   */
+        char magic[8];
+
+        /*  Format version, the size of this header, and the byte order mark. */
+        std::uint32_t version;
+        std::uint32_t header_size;
+        std::uint32_t byte_order;
+
+        /*  Number of pixels in the x and y axes.                             */
+        std::uint32_t xsize;
+        std::uint32_t ysize;
+
+        /*  Which random number generator was used, see histogram_rng_*.      */
+        std::uint32_t rng;
+
+        /*  Number of maps in the IFS, and padding to align what follows.     */
+        std::uint32_t number_of_maps;
+        std::uint32_t reserved;
+
+        /*  Seed for the random number generator, and the number of points.   */
+        std::uint64_t seed;
+        std::uint64_t iterations;
+
+        /*  The view transform, pixel = shift + scale * point.                */
+        double xscale, yscale, xshift, yshift;
+
+        /*  The IFS. Start point, cutoffs, and maps as (xx, xy, yx, yy, u, v).*/
+        double xstart, ystart;
+        double cutoff[max_maps];
+        double transform[max_maps][6];
+
+        /*  Unused, pads the header to 1024 bytes.                            */
+        unsigned char padding[24];
+    };
+
+    static_assert(sizeof(histogram_header) == 1024U,
+                  "histogram_header must be exactly 1024 bytes.");
+
+    /*  Alignment of the counts, the size of a cache line.                    */
+    static const std::size_t histogram_alignment = 64U;
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      allocate_counts                                                   *
+     *  Purpose:                                                              *
+     *      Allocates zeroed counts aligned to a cache line.                  *
+     *  Arguments:                                                            *
+     *      number_of_pixels (std::size_t):                                   *
+     *          The number of counts.                                         *
+     *  Outputs:                                                              *
+     *      counts (std::uint32_t *):                                         *
+     *          The counts, freed with std::free. NULL on failure.            *
+     *  Notes:                                                                *
+     *      calloc only promises the alignment of the largest basic type,     *
+     *      16 bytes on most machines, so groups of 16 counts could straddle  *
+     *      two cache lines. The shared counters of bf_shared.hpp rely on     *
+     *      them not doing so. Mapped histograms are aligned too, since the   *
+     *      header is a multiple of 64 bytes.                                 *
+     **************************************************************************/
+    inline std::uint32_t *allocate_counts(std::size_t number_of_pixels)
+    {
+        const std::size_t bytes = number_of_pixels * sizeof(std::uint32_t);
+        void *data;
+
+        if (posix_memalign(&data, histogram_alignment, bytes) != 0)
+            return NULL;
+
+        std::memset(data, 0, bytes);
+        return static_cast<std::uint32_t *>(data);
+    }
+
+    /*  Struct for the hit counts of a render along with its parameters.      */
+    struct histogram {
+
+        /*  The parameters of the render, exactly as stored on disk.          */
+        histogram_header header;
+
+        /*  The counts, xsize * ysize of them, one per pixel.                 */
+        std::uint32_t *counts;
+
+        /*  If the histogram was loaded from a file, the mapped region.       */
+        void *mapping;
+        std::size_t mapping_size;
+
+        /*  Empty constructor, holds no data.                                 */
+        histogram(void);
+
+        /*  Constructor from an IFS and a view. The counts start at zero.     */
+        histogram(const ifs &fern, const view &v);
+
+        /*  Destructor, frees or unmaps the counts.                           */
+        ~histogram(void);
+
+        /*  Sets new parameters and zeros the counts, reusing the memory.     */
+        inline bool reset(const ifs &fern, const view &v);
+
+        /*  Fills the header from an IFS and a view.                          */
+        inline void set_header(const ifs &fern, const view &v);
+
+        /*  Runs the chaos game, adding to the counts.                        */
+        inline void render(std::uint64_t iterations, std::uint64_t seed);
+
+        /*  Writes the histogram to a file.                                   */
+        inline bool save(const char *name) const;
+
+        /*  Maps a histogram file into memory.                                */
+        inline bool load(const char *name);
+
+        /*  Frees or unmaps the counts.                                       */
+        inline void release(void);
+
+        /*  The view and IFS stored in the header.                            */
+        inline view get_view(void) const;
+        inline ifs get_ifs(void) const;
+
+        /*  The number of counts, xsize * ysize.                              */
+        inline std::size_t number_of_pixels(void) const;
+
+    private:
+
+        /*  Copying would free the counts twice.                              */
+        histogram(const histogram &);
+        histogram &operator = (const histogram &);
+    };
+
+    /*  Empty constructor. Zero the header so that it is well defined.        */
+    inline histogram::histogram(void)
+    {
+        std::memset(&header, 0, sizeof(header));
+        counts = NULL;
+        mapping = NULL;
+        mapping_size = 0U;
+    }
+
+    /**************************************************************************
+     *  Constructor:                                                          *
+     *      histogram                                                         *
+     *  Purpose:                                                              *
+     *      Creates an empty histogram for a given IFS and view.              *
+     *  Arguments:                                                            *
+     *      fern (const bf::ifs &):                                           *
+     *          The maps and probabilities to be drawn.                       *
+     *      v (const bf::view &):                                             *
+     *          The image size and the point-to-pixel conversion.             *
+     *  Outputs:                                                              *
+     *      hist (bf::histogram):                                             *
+     *          A histogram with all counts zero.                             *
+     *  Notes:                                                                *
+     *      allocate_counts returns NULL on failure. This function will print *
+     *      a warning if it does, and it is the caller's responsibility to    *
+     *      check the counts pointer before using it.                         *
+     **************************************************************************/
+    inline histogram::histogram(const ifs &fern, const view &v)
+    {
+        set_header(fern, v);
+
+        mapping = NULL;
+        mapping_size = 0U;
+        counts = allocate_counts(v.number_of_pixels());
+
+        if (!counts)
+            std::puts("ERROR: posix_memalign failed to allocate the counts.");
+    }
+
+    /*  Destructor, the counts were allocated by allocate_counts or mapped.   */
+    inline histogram::~histogram(void)
+    {
+        release();
+    }
+
+    /*  Writes the magic number, sizes, view, and IFS to the header.          */
+    inline void histogram::set_header(const ifs &fern, const view &v)
+    {
+        unsigned int n;
+
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, "BFHIST\0\0", 8U);
+        header.version = histogram_version;
+        header.header_size = sizeof(histogram_header);
+        header.byte_order = 0x01020304U;
+        header.xsize = v.xsize;
+        header.ysize = v.ysize;
+        header.rng = histogram_rng_stdlib;
+        header.number_of_maps = fern.number_of_maps;
+        header.xscale = v.xscale;
+        header.yscale = v.yscale;
+        header.xshift = v.xshift;
+        header.yshift = v.yshift;
+        header.xstart = fern.xstart;
+        header.ystart = fern.ystart;
+
+        for (n = 0U; n < fern.number_of_maps; ++n)
+        {
+            const affine &T = fern.transform[n];
+            header.cutoff[n] = fern.cutoff[n];
+            header.transform[n][0] = T.xx;
+            header.transform[n][1] = T.xy;
+            header.transform[n][2] = T.yx;
+            header.transform[n][3] = T.yy;
+            header.transform[n][4] = T.x_shift;
+            header.transform[n][5] = T.y_shift;
+        }
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      reset                                                             *
+     *  Purpose:                                                              *
+     *      Turns the histogram into an empty one for new parameters.         *
+     *  Arguments:                                                            *
+     *      fern (const bf::ifs &):                                           *
+     *          The maps and probabilities to be drawn.                       *
+     *      v (const bf::view &):                                             *
+     *          The image size and the point-to-pixel conversion.             *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if memory for the counts could not be found.            *
+     *  Notes:                                                                *
+     *      If the image has the same size as before, the counts are zeroed   *
+     *      in place rather than freed and allocated again. This is how the   *
+     *      animation code reuses buffers from one frame to the next.         *
+     **************************************************************************/
+    inline bool histogram::reset(const ifs &fern, const view &v)
+    {
+        const bool same_size = (counts && !mapping &&
+                                header.xsize == v.xsize &&
+                                header.ysize == v.ysize);
+
+        if (!same_size)
+            release();
+
+        set_header(fern, v);
+
+        if (same_size)
+            std::memset(counts, 0, v.number_of_pixels() * sizeof(*counts));
+
+        else
+        {
+            counts = allocate_counts(v.number_of_pixels());
+
+            if (!counts)
+            {
+                std::puts("ERROR: posix_memalign failed to allocate the "
+                          "counts.");
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /*  The number of counts stored.                                          */
+    inline std::size_t histogram::number_of_pixels(void) const
+    {
+        return static_cast<std::size_t>(header.xsize) *
+               static_cast<std::size_t>(header.ysize);
+    }
+
+    /*  Rebuilds the view from the header.                                    */
+    inline view histogram::get_view(void) const
+    {
+        view v;
+        v.xsize = header.xsize;
+        v.ysize = header.ysize;
+        v.xscale = header.xscale;
+        v.yscale = header.yscale;
+        v.xshift = header.xshift;
+        v.yshift = header.yshift;
+        return v;
+    }
+
+    /*  Rebuilds the IFS from the header.                                     */
+    inline ifs histogram::get_ifs(void) const
+    {
+        ifs fern = ifs();
+        unsigned int n;
+
+        fern.number_of_maps = header.number_of_maps;
+        fern.xstart = header.xstart;
+        fern.ystart = header.ystart;
+
+        for (n = 0U; n < header.number_of_maps && n < max_maps; ++n)
+        {
+            affine &T = fern.transform[n];
+            fern.cutoff[n] = header.cutoff[n];
+            T.xx = header.transform[n][0];
+            T.xy = header.transform[n][1];
+            T.yx = header.transform[n][2];
+            T.yy = header.transform[n][3];
+            T.x_shift = header.transform[n][4];
+            T.y_shift = header.transform[n][5];
+        }
+
+        return fern;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      render                                                            *
+     *  Purpose:                                                              *
+     *      Runs the chaos game from the start point of the IFS, adding the   *
+     *      hits to the counts.                                               *
+     *  Arguments:                                                            *
+     *      iterations (std::uint64_t):                                       *
+     *          The number of points to compute.                              *
+     *      seed (std::uint64_t):                                             *
+     *          Seed for the generator, a bf::rng of its own.                 *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Notes:                                                                *
+     *      The generator is local, so std::rand and anything else drawing    *
+     *      from it are left alone. The same seed gives the same counts.      *
+     **************************************************************************/
+    inline void histogram::render(std::uint64_t iterations, std::uint64_t seed)
+    {
+        const ifs fern = get_ifs();
+        const view v = get_view();
+        double x_val = fern.xstart;
+        double y_val = fern.ystart;
+        rng gen(seed);
+
+        if (!counts)
+            return;
+
+        create_fern(counts, fern, v, iterations, x_val, y_val, gen);
+
+        header.rng = histogram_rng_xoshiro;
+        header.seed = seed;
+        header.iterations += iterations;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      save                                                              *
+     *  Purpose:                                                              *
+     *      Writes the header and the counts to a file.                       *
+     *  Arguments:                                                            *
+     *      name (const char *):                                              *
+     *          The file name (ex. "barnsley_fern.hist").                     *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          True if the whole histogram was written.                      *
+     **************************************************************************/
+    inline bool histogram::save(const char *name) const
+    {
+        std::FILE *fp;
+        std::size_t written;
+
+        if (!counts)
+            return false;
+
+        fp = std::fopen(name, "wb");
+
+        if (!fp)
+        {
+            std::puts("ERROR: fopen failed and returned NULL.");
+            return false;
+        }
+
+        written = std::fwrite(&header, sizeof(header), 1U, fp);
+        written += std::fwrite(counts, sizeof(*counts), number_of_pixels(), fp);
+
+        /*  fclose writes out the buffer, and may fail on a full disk.        */
+        if (std::fclose(fp) != 0)
+            return false;
+
+        return written == number_of_pixels() + 1U;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      load                                                              *
+     *  Purpose:                                                              *
+     *      Maps a histogram file into memory and checks its header.          *
+     *  Arguments:                                                            *
+     *      name (const char *):                                              *
+     *          The file name (ex. "barnsley_fern.hist").                     *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          True if the file is a valid histogram.                        *
+     *  Method:                                                               *
+     *      The file is mapped privately, so the counts are paged in from the *
+     *      page cache as they are touched rather than read up front. They    *
+     *      may be modified, but changes are never written back to the file.  *
+     **************************************************************************/
+    inline bool histogram::load(const char *name)
+    {
+        struct stat info;
+        void *region;
+        const histogram_header *disk;
+        const int fd = open(name, O_RDONLY);
+
+        release();
+
+        if (fd < 0)
+        {
+            std::puts("ERROR: could not open the histogram file.");
+            return false;
+        }
+
+        if (fstat(fd, &info) != 0 ||
+            static_cast<std::size_t>(info.st_size) < sizeof(histogram_header))
+        {
+            std::puts("ERROR: histogram file is too small.");
+            ::close(fd);
+            return false;
+        }
+
+        region = mmap(NULL, static_cast<std::size_t>(info.st_size),
+                      PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+        /*  The mapping stays valid after the file is closed.                 */
+        ::close(fd);
+
+        if (region == MAP_FAILED)
+        {
+            std::puts("ERROR: mmap failed.");
+            return false;
+        }
+
+        disk = static_cast<const histogram_header *>(region);
+
+        /*  Check the header before trusting any of the sizes in it.          */
+        if (std::memcmp(disk->magic, "BFHIST\0\0", 8U) != 0 ||
+            disk->version != histogram_version ||
+            disk->byte_order != 0x01020304U ||
+            disk->header_size != sizeof(histogram_header) ||
+            disk->number_of_maps == 0U || disk->number_of_maps > max_maps ||
+            static_cast<std::size_t>(info.st_size) != sizeof(histogram_header) +
+                sizeof(std::uint32_t) * static_cast<std::size_t>(disk->xsize) *
+                                        static_cast<std::size_t>(disk->ysize))
+        {
+            std::puts("ERROR: not a valid histogram file.");
+            munmap(region, static_cast<std::size_t>(info.st_size));
+            return false;
+        }
+
+        std::memcpy(&header, disk, sizeof(header));
+        mapping = region;
+        mapping_size = static_cast<std::size_t>(info.st_size);
+        counts = reinterpret_cast<std::uint32_t *>(
+            static_cast<unsigned char *>(region) + sizeof(histogram_header)
+        );
+
+        /*  Tone mapping reads the counts front to back.                      */
+        madvise(region, mapping_size, MADV_SEQUENTIAL);
+        return true;
+    }
+
+    /*  Frees the counts, or unmaps them if they came from a file.            */
+    inline void histogram::release(void)
+    {
+        if (mapping)
+            munmap(mapping, mapping_size);
+        else
+            std::free(counts);
+
+        counts = NULL;
+        mapping = NULL;
+        mapping_size = 0U;
+    }
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      tone_map                                                          *
+     *  Purpose:                                                              *
+     *      Colors a histogram, writing RGB pixels to a buffer.               *
+     *  Arguments:                                                            *
+     *      color (Tcolorer):                                                 *
+     *          The colorer, like bf::colorer::grayscale.                     *
+     *      hist (const bf::histogram &):                                     *
+     *          The histogram.                                                *
+     *      rgb (unsigned char *):                                            *
+     *          Output, room for 3 * xsize * ysize bytes.                     *
+     *      scale_factor (double):                                            *
+     *          Scale factor for the intensity. The default is the one that   *
+     *          bf::run uses, so the output matches its images.               *
+     *      threads (unsigned int):                                           *
+     *          The maximum number of threads. Zero uses all of them.         *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Method:                                                               *
+     *      Same formula as bf::run, split into bands of rows on threads.     *
+     **************************************************************************/
+    template <typename Tcolorer>
+    inline void
+    tone_map(Tcolorer color, const histogram &hist, unsigned char *rgb,
+             double scale_factor = 1.0 / 256.0, unsigned int threads = 0U)
+    {
+        /*  Number of rows colored at a time by one thread.                   */
+        const unsigned int band_rows = 64U;
+        const unsigned int width = hist.header.xsize;
+        const unsigned int height = hist.header.ysize;
+        const unsigned int bands = (height + band_rows - 1U) / band_rows;
+
+        parallel::for_each(bands, [&](unsigned int band)
+        {
+            const std::size_t first = static_cast<std::size_t>(band) *
+                                      band_rows * width;
+            const unsigned int rows = (band + 1U == bands ?
+                                       height - band*band_rows : band_rows);
+            const std::size_t last = first +
+                                     static_cast<std::size_t>(rows) * width;
+            std::size_t index;
+
+            for (index = first; index < last; ++index)
+            {
+                const double val = 1.0 - scale_factor*hist.counts[index];
+                const bf::color c = color(val);
+
+                rgb[3U*index] = c.red;
+                rgb[3U*index + 1U] = c.green;
+                rgb[3U*index + 2U] = c.blue;
+            }
+        }, threads);
+    }
+    /*  End of tone_map.                                                      */
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,250 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Provides a struct for iterated function systems (IFS), a list of      *
+ *      affine maps and the probability of choosing each one.                 *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_IFS_HPP
+#define BF_IFS_HPP
+
+/*  Default parameters, like the growth factor, are found here.               */
+#include "bf_setup.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Largest number of maps an IFS may have.                               */
+    static const unsigned int max_maps = 16U;
+
+    /*  Affine transformation of the plane, T(x, y) = A(x, y) + (u, v).       */
+    struct affine {
+
+        /*  The matrix A, stored row by row, and the shift (u, v).            */
+        double xx, xy, yx, yy;
+        double x_shift, y_shift;
+
+        /**********************************************************************
+         *  Method:                                                           *
+         *      transform                                                     *
+         *  Purpose:                                                          *
+         *      Applies the affine transformation to a point in place.        *
+         *  Arguments:                                                        *
+         *      x (double &):                                                 *
+         *          The x coordinate of the point.                            *
+         *      y (double &):                                                 *
+         *          The y coordinate of the point.                            *
+         *  Outputs:                                                          *
+         *      None (void).                                                  *
+         **********************************************************************/
+        inline void transform(double &x, double &y) const
+        {
+            const double x_old = x;
+            const double y_old = y;
+            x = xx*x_old + xy*y_old + x_shift;
+            y = yx*x_old + yy*y_old + y_shift;
+        }
+    };
+
+    /*  An iterated function system, the maps and their probabilities.        */
+    struct ifs {
+
+        /*  Number of maps actually used, at most max_maps.                   */
+        unsigned int number_of_maps;
+
+        /*  As in the C version, [0, 100] is split into sub-intervals, one    *
+         *  per map. cutoff[n] is the right end of the n-th interval, so      *
+         *  these are increasing and the last one is 100.                     */
+        double cutoff[max_maps];
+
+        /*  The affine transformations for the sub-intervals.                 */
+        affine transform[max_maps];
+
+        /*  Starting point for the iteration.                                 */
+        double xstart, ystart;
+
+        /*  Returns the index of the map for a number between 0 and 100.      */
+        inline unsigned int select(double random_value) const;
+
+        /*  "The" Barnsley fern, as drawn by bf::run.                         */
+        static inline ifs barnsley(double growth_factor = setup::growth_factor);
+
+        /*  Mutated variant for the Thelypteridaceae fern, from the C code.   */
+        static inline ifs thelypteridaceae(void);
+    };
+
+    /*  Linear interpolation between two IFS's, used for animations.          */
+    inline ifs interpolate(const ifs &first, const ifs &last, double t);
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      select                                                            *
+     *  Purpose:                                                              *
+     *      Picks the map corresponding to a random value in [0, 100).        *
+     *  Arguments:                                                            *
+     *      random_value (double):                                            *
+     *          A number between 0 and 100.                                   *
+     *  Outputs:                                                              *
+     *      n (unsigned int):                                                 *
+     *          The index of the sub-interval containing random_value.        *
+     **************************************************************************/
+    inline unsigned int ifs::select(double random_value) const
+    {
+        unsigned int n = 0U;
+
+        while (n + 1U < number_of_maps && random_value >= cutoff[n])
+            ++n;
+
+        return n;
+    }
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      barnsley                                                          *
+     *  Purpose:                                                              *
+     *      Returns the parameters of the Barnsley fern used by bf::run.      *
+     *  Arguments:                                                            *
+     *      growth_factor (double):                                           *
+     *          The top-left entry of the second map. Defaults to the value   *
+     *          in "setup".                                                   *
+     *  Outputs:                                                              *
+     *      fern (bf::ifs):                                                   *
+     *          The Barnsley fern.                                            *
+     *  Notes:                                                                *
+     *      Iterating this with bf::create_fern gives the same points as the  *
+     *      hand-written version in bf_fern.hpp.                              *
+     **************************************************************************/
+    inline ifs ifs::barnsley(double growth_factor)
+    {
+        const affine stem = {+0.00, +0.00, +0.00, +0.16, 0.00, 0.00};
+        const affine frond = {growth_factor, +0.04, -0.04, +0.85, 0.00, 1.60};
+        const affine left = {+0.20, -0.26, +0.23, +0.22, 0.00, 1.60};
+        const affine right = {-0.15, +0.28, +0.26, +0.24, 0.00, 0.44};
+
+        ifs fern = ifs();
+        fern.number_of_maps = 4U;
+        fern.cutoff[0] = 1.0;
+        fern.cutoff[1] = 86.0;
+        fern.cutoff[2] = 93.0;
+        fern.cutoff[3] = 100.0;
+        fern.transform[0] = stem;
+        fern.transform[1] = frond;
+        fern.transform[2] = left;
+        fern.transform[3] = right;
+        fern.xstart = setup::xstart;
+        fern.ystart = setup::ystart;
+        return fern;
+    }
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      thelypteridaceae                                                  *
+     *  Purpose:                                                              *
+     *      Returns the parameters of the Thelypteridaceae fern.              *
+     *  Arguments:                                                            *
+     *      None (void).                                                      *
+     *  Outputs:                                                              *
+     *      fern (bf::ifs):                                                   *
+     *          The Thelypteridaceae fern, same values as c/bf/bf_data.h.     *
+     **************************************************************************/
+    inline ifs ifs::thelypteridaceae(void)
+    {
+        const affine stem = {+0.000, +0.000, +0.000, +0.250, +0.000, -0.400};
+        const affine frond = {+0.950, +0.002, -0.005, +0.930, -0.002, +0.700};
+        const affine left = {+0.035, -0.200, +0.160, +0.040, -0.090, +0.020};
+        const affine right = {-0.040, +0.200, +0.160, +0.040, +0.083, +0.120};
+
+        ifs fern = ifs();
+        fern.number_of_maps = 4U;
+        fern.cutoff[0] = 2.0;
+        fern.cutoff[1] = 86.0;
+        fern.cutoff[2] = 93.0;
+        fern.cutoff[3] = 100.0;
+        fern.transform[0] = stem;
+        fern.transform[1] = frond;
+        fern.transform[2] = left;
+        fern.transform[3] = right;
+        fern.xstart = setup::xstart;
+        fern.ystart = setup::ystart;
+        return fern;
+    }
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      interpolate                                                       *
+     *  Purpose:                                                              *
+     *      Blends two iterated function systems, coefficient by coefficient. *
+     *  Arguments:                                                            *
+     *      first (const bf::ifs &):                                          *
+     *          The IFS at t = 0.                                             *
+     *      last (const bf::ifs &):                                           *
+     *          The IFS at t = 1.                                             *
+     *      t (double):                                                       *
+     *          The position between the two, usually between 0 and 1.        *
+     *  Outputs:                                                              *
+     *      fern (bf::ifs):                                                   *
+     *          (1 - t) * first + t * last for the maps, cutoffs, and start.  *
+     *  Notes:                                                                *
+     *      The number of maps is taken from whichever has more. Missing maps *
+     *      are zero, and missing cutoffs are 100, so a map can fade in or    *
+     *      out by having an empty interval at one end.                       *
+     **************************************************************************/
+    inline ifs interpolate(const ifs &first, const ifs &last, double t)
+    {
+        const double s = 1.0 - t;
+        const affine zero = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+        ifs fern = ifs();
+        unsigned int n;
+
+        fern.number_of_maps = (first.number_of_maps > last.number_of_maps ?
+                               first.number_of_maps : last.number_of_maps);
+
+        for (n = 0U; n < fern.number_of_maps; ++n)
+        {
+            const bool has_a = (n < first.number_of_maps);
+            const bool has_b = (n < last.number_of_maps);
+            const affine &A = (has_a ? first.transform[n] : zero);
+            const affine &B = (has_b ? last.transform[n] : zero);
+            const double a = (has_a ? first.cutoff[n] : 100.0);
+            const double b = (has_b ? last.cutoff[n] : 100.0);
+
+            fern.cutoff[n] = s*a + t*b;
+            fern.transform[n].xx = s*A.xx + t*B.xx;
+            fern.transform[n].xy = s*A.xy + t*B.xy;
+            fern.transform[n].yx = s*A.yx + t*B.yx;
+            fern.transform[n].yy = s*A.yy + t*B.yy;
+            fern.transform[n].x_shift = s*A.x_shift + t*B.x_shift;
+            fern.transform[n].y_shift = s*A.y_shift + t*B.y_shift;
+        }
+
+        /*  Guard against rounding, the last interval must end at 100.        */
+        fern.cutoff[fern.number_of_maps - 1U] = 100.0;
+        fern.xstart = s*first.xstart + t*last.xstart;
+        fern.ystart = s*first.ystart + t*last.ystart;
+        return fern;
+    }
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
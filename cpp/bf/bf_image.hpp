@@ -0,0 +1,144 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Provides save_image, which writes an RGB buffer as a PPM or a PNG     *
+ *      file depending on the name, and save_density, which writes a PFM.     *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_IMAGE_HPP
+#define BF_IMAGE_HPP
+
+/*  puts found here.                                                          */
+#include <stdio.h>
+
+/*  malloc and free found here.                                               */
+#include <stdlib.h>
+
+/*  size_t, strlen, and strcmp found here.                                    */
+#include <string.h>
+
+/*  Histograms of hit counts.                                                 */
+#include "bf_histogram.hpp"
+
+/*  PFM struct for writing floating point images.                             */
+#include "bf_pfm.hpp"
+
+/*  PNG struct with a multi-threaded encoder.                                 */
+#include "bf_png.hpp"
+
+/*  PPM struct defined here with basic functions and utilities.               */
+#include "bf_ppm.hpp"
+
+/*  bf::density, the normalized counts written by save_density.               */
+#include "bf_tonemap.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      save_image                                                        *
+     *  Purpose:                                                              *
+     *      Writes an RGB image, picking the format from the file name.       *
+     *  Arguments:                                                            *
+     *      rgb (const unsigned char *):                                      *
+     *          The image, 3 bytes per pixel, rows stored top to bottom.      *
+     *      x (unsigned int):                                                 *
+     *          The number of pixels in the x axis.                           *
+     *      y (unsigned int):                                                 *
+     *          The number of pixels in the y axis.                           *
+     *      name (const char *):                                              *
+     *          The file name. Names ending in ".png" give PNG files, all     *
+     *          others give PPM files.                                        *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if the file could not be opened or fully written.       *
+     **************************************************************************/
+    inline bool
+    save_image(const unsigned char *rgb, unsigned int x, unsigned int y,
+               const char *name)
+    {
+        const size_t length = strlen(name);
+
+        if (length >= 4U && strcmp(name + length - 4U, ".png") == 0)
+        {
+            struct png PNG = png(name);
+            PNG.write(rgb, x, y);
+            return PNG.close();
+        }
+        else
+        {
+            struct ppm PPM = ppm(name);
+            PPM.write(rgb, x, y);
+            return PPM.close();
+        }
+    }
+    /*  End of save_image.                                                    */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      save_density                                                      *
+     *  Purpose:                                                              *
+     *      Writes the normalized density of a histogram as a grayscale PFM.  *
+     *  Arguments:                                                            *
+     *      hist (const bf::histogram &):                                     *
+     *          The histogram, rendered or loaded from a file.                *
+     *      name (const char *):                                              *
+     *          The output file name (ex. "barnsley_fern.pfm").               *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if there was no data, or the file could not be opened   *
+     *          or fully written.                                             *
+     **************************************************************************/
+    inline bool save_density(const histogram &hist, const char *name)
+    {
+        bool success;
+        float * const data = static_cast<float *>(
+            malloc(sizeof(float) * hist.number_of_pixels())
+        );
+
+        /*  malloc returns NULL on failure. Check for this.                   */
+        if (!data || !hist.counts)
+        {
+            std::puts("ERROR: save_density has no data. Aborting.");
+            free(data);
+            return false;
+        }
+
+        density(hist, data);
+
+        {
+            struct pfm PFM = pfm(name);
+            PFM.write(data, hist.header.xsize, hist.header.ysize, 1U);
+            success = PFM.close();
+        }
+
+        free(data);
+        return success;
+    }
+    /*  End of save_density.                                                  */
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,298 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Tools for summing histograms from several independent renders, for    *
+ *      example ones run with different seeds on different machines.          *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_MERGE_HPP
+#define BF_MERGE_HPP
+
+/*  std::puts found here.                                                     */
+#include <cstdio>
+
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::uint32_t and std::uint64_t.               */
+#include <cstdint>
+
+/*  std::memcmp, for comparing the parameters in the headers.                 */
+#include <cstring>
+
+/*  std::vector, for holding the mapped input files.                          */
+#include <vector>
+
+/*  madvise, for dropping input pages once they have been added.              */
+#include <sys/mman.h>
+#include <unistd.h>
+
+/*  SSE2 is part of x86-64, AVX2 only if the compiler is told to use it.      */
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+/*  Histograms and the file format.                                           */
+#include "bf_histogram.hpp"
+
+/*  Threading helpers, tiles are summed in parallel.                          */
+#include "bf_parallel.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Number of counts in a tile, a multiple of the page size in bytes.     */
+    static const std::size_t merge_tile = 65536U;
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      compatible                                                        *
+     *  Purpose:                                                              *
+     *      Checks whether two histograms can be added together. They must    *
+     *      describe the same image of the same IFS with the same kind of     *
+     *      random number generator. Seeds and iteration counts may differ.   *
+     *  Arguments:                                                            *
+     *      a (const bf::histogram_header &):                                 *
+     *          The header of the first histogram.                            *
+     *      b (const bf::histogram_header &):                                 *
+     *          The header of the second histogram.                           *
+     *  Outputs:                                                              *
+     *      same (bool):                                                      *
+     *          True if the histograms may be merged.                         *
+     *  Notes:                                                                *
+     *      The floating point parameters are compared bit for bit. Renders   *
+     *      meant to be merged are made from the same parameters, so there is *
+     *      no reason for them to differ in even the last place.              *
+     **************************************************************************/
+    inline bool
+    compatible(const histogram_header &a, const histogram_header &b)
+    {
+        const std::size_t maps = a.number_of_maps;
+
+        if (a.version != b.version || a.xsize != b.xsize ||
+            a.ysize != b.ysize || a.rng != b.rng ||
+            a.number_of_maps != b.number_of_maps || maps > max_maps)
+            return false;
+
+        /*  The view and the start point are six consecutive doubles.         */
+        if (std::memcmp(&a.xscale, &b.xscale, 6U * sizeof(double)) != 0)
+            return false;
+
+        if (std::memcmp(a.cutoff, b.cutoff, maps * sizeof(double)) != 0)
+            return false;
+
+        return std::memcmp(a.transform, b.transform,
+                           maps * sizeof(a.transform[0])) == 0;
+    }
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      add_counts                                                        *
+     *  Purpose:                                                              *
+     *      Adds one array of counts to another, dst[n] += src[n].            *
+     *  Arguments:                                                            *
+     *      dst (std::uint32_t *):                                            *
+     *          The running sum.                                              *
+     *      src (const std::uint32_t *):                                      *
+     *          The counts being added.                                       *
+     *      length (std::size_t):                                             *
+     *          The number of elements.                                       *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Method:                                                               *
+     *      Eight (AVX2) or four (SSE2) counts per instruction with unaligned *
+     *      loads, then a scalar loop for the remainder. Counts wrap modulo   *
+     *      2^32, as with ordinary unsigned arithmetic.                       *
+     **************************************************************************/
+    inline void
+    add_counts(std::uint32_t *dst, const std::uint32_t *src, std::size_t length)
+    {
+        std::size_t n = 0U;
+
+#if defined(__AVX2__)
+        for (; n + 8U <= length; n += 8U)
+        {
+            __m256i *d = reinterpret_cast<__m256i *>(dst + n);
+            const __m256i *s = reinterpret_cast<const __m256i *>(src + n);
+            const __m256i sum = _mm256_add_epi32(_mm256_loadu_si256(d),
+                                                 _mm256_loadu_si256(s));
+            _mm256_storeu_si256(d, sum);
+        }
+#elif defined(__SSE2__)
+        for (; n + 4U <= length; n += 4U)
+        {
+            __m128i *d = reinterpret_cast<__m128i *>(dst + n);
+            const __m128i *s = reinterpret_cast<const __m128i *>(src + n);
+            const __m128i sum = _mm_add_epi32(_mm_loadu_si128(d),
+                                              _mm_loadu_si128(s));
+            _mm_storeu_si128(d, sum);
+        }
+#endif
+
+        for (; n < length; ++n)
+            dst[n] += src[n];
+    }
+
+    /*  Drops the pages of [first, first + length) from a private mapping.    */
+    inline void drop_pages(const void *first, std::size_t length)
+    {
+        const std::size_t page =
+            static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+
+        const std::size_t start = reinterpret_cast<std::size_t>(first);
+        const std::size_t begin = (start + page - 1U) / page * page;
+        const std::size_t end = (start + length) / page * page;
+
+        /*  Only whole pages inside the range are dropped.                    */
+        if (end > begin)
+            madvise(reinterpret_cast<void *>(begin), end - begin,
+                    MADV_DONTNEED);
+    }
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      merge                                                             *
+     *  Purpose:                                                              *
+     *      Adds the counts of several histograms to another.                 *
+     *  Arguments:                                                            *
+     *      out (bf::histogram &):                                            *
+     *          The histogram being added to. Usually empty.                  *
+     *      inputs (const bf::histogram *):                                   *
+     *          The histograms being added.                                   *
+     *      count (unsigned int):                                             *
+     *          The number of inputs.                                         *
+     *      drop_inputs (bool):                                               *
+     *          If true, pages of inputs loaded from files are released once  *
+     *          they have been added. Any changes made to those inputs in     *
+     *          memory are lost, so this is off by default.                   *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if any of the inputs is incompatible with out.          *
+     *  Method:                                                               *
+     *      The image is cut into tiles of merge_tile counts, and each thread *
+     *      takes a tile and adds every input into it before moving on. The   *
+     *      running sum stays in cache while the inputs stream past, and each *
+     *      input is read exactly once. Inputs that were loaded from files    *
+     *      have their pages dropped as soon as a tile is done, so the page   *
+     *      cache does not fill up with data that will not be read again.     *
+     **************************************************************************/
+    inline bool
+    merge(histogram &out, const histogram *inputs, unsigned int count,
+          bool drop_inputs = false)
+    {
+        const std::size_t pixels = out.number_of_pixels();
+        const unsigned int tiles =
+            static_cast<unsigned int>((pixels + merge_tile - 1U) / merge_tile);
+        unsigned int n;
+
+        if (!out.counts)
+            return false;
+
+        /*  Check everything before touching any of the counts.               */
+        for (n = 0U; n < count; ++n)
+        {
+            if (!inputs[n].counts || !compatible(out.header, inputs[n].header))
+            {
+                std::puts("ERROR: histograms are not compatible.");
+                return false;
+            }
+        }
+
+        parallel::for_each(tiles, [&](unsigned int tile)
+        {
+            const std::size_t first = static_cast<std::size_t>(tile) *
+                                      merge_tile;
+            const std::size_t length = (first + merge_tile > pixels ?
+                                        pixels - first : merge_tile);
+            unsigned int k;
+
+            for (k = 0U; k < count; ++k)
+            {
+                const std::uint32_t * const src = inputs[k].counts + first;
+                add_counts(out.counts + first, src, length);
+
+                if (drop_inputs && inputs[k].mapping)
+                    drop_pages(src, length * sizeof(*src));
+            }
+        });
+
+        for (n = 0U; n < count; ++n)
+            out.header.iterations += inputs[n].header.iterations;
+
+        return true;
+    }
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      merge_files                                                       *
+     *  Purpose:                                                              *
+     *      Sums several histogram files and saves the result.                *
+     *  Arguments:                                                            *
+     *      names (const char * const *):                                     *
+     *          The input file names.                                         *
+     *      count (unsigned int):                                             *
+     *          The number of input files, at least one.                      *
+     *      name (const char *):                                              *
+     *          The output file name.                                         *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          True if every file was read, merged, and the result saved.    *
+     *  Notes:                                                                *
+     *      The output takes its header from the first input, so it records   *
+     *      the first seed and the total number of iterations.                *
+     **************************************************************************/
+    inline bool
+    merge_files(const char * const *names, unsigned int count, const char *name)
+    {
+        std::vector<histogram> inputs(count);
+        histogram out;
+        bool success = (count > 0U);
+        unsigned int n;
+
+        /*  Map all of the inputs. Nothing is read until the merge itself.    */
+        for (n = 0U; n < count && success; ++n)
+        {
+            success = inputs[n].load(names[n]);
+
+            if (!success)
+                std::printf("ERROR: could not load %s\n", names[n]);
+        }
+
+        /*  reset allocates the counts, set to zero for the merge.            */
+        if (success)
+            success = out.reset(inputs[0].get_ifs(), inputs[0].get_view());
+
+        if (success)
+        {
+            out.header = inputs[0].header;
+            out.header.iterations = 0U;
+            success = merge(out, inputs.data(), count, true) && out.save(name);
+        }
+
+        return success;
+    }
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,477 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Small helpers for splitting work across hardware threads.             *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_PARALLEL_HPP
+#define BF_PARALLEL_HPP
+
+/*  std::atomic, used for handing out work items to the threads.              */
+#include <atomic>
+
+/*  std::condition_variable, idle workers of the scheduler sleep on one.      */
+#include <condition_variable>
+
+/*  std::size_t and std::ptrdiff_t, for indexing into the task queues.        */
+#include <cstddef>
+
+/*  std::deque, the task queues of the scheduler.                             */
+#include <deque>
+
+/*  std::function, the type of a task.                                        */
+#include <functional>
+
+/*  std::mutex, one per task queue.                                           */
+#include <mutex>
+
+/*  std::thread and std::thread::hardware_concurrency given here.             */
+#include <thread>
+
+/*  std::vector, used for storing the thread objects and the queues.          */
+#include <vector>
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Another namespace to keep the threading helpers grouped together.     */
+    namespace parallel {
+
+        /**********************************************************************
+         *  Function:                                                         *
+         *      number_of_threads                                             *
+         *  Purpose:                                                          *
+         *      Returns the number of hardware threads available.             *
+         *  Arguments:                                                        *
+         *      None (void).                                                  *
+         *  Outputs:                                                          *
+         *      n (unsigned int):                                             *
+         *          The number of threads the machine can run concurrently.   *
+         *  Notes:                                                            *
+         *      hardware_concurrency may return zero if the value is not      *
+         *      computable. One is returned in this case.                     *
+         **********************************************************************/
+        inline unsigned int number_of_threads(void)
+        {
+            const unsigned int n = std::thread::hardware_concurrency();
+            return (n == 0U ? 1U : n);
+        }
+
+        struct task_group;
+
+        /*  The group of the task running on this thread, NULL outside one.   */
+        inline task_group *&running_group(void)
+        {
+            static thread_local task_group *group = NULL;
+            return group;
+        }
+
+        /*  Counts the unfinished tasks spawned into it, see scheduler. The   *
+         *  parent is the group of the task that created it.                  */
+        struct task_group {
+            std::atomic<unsigned int> pending;
+            const task_group * const parent;
+
+            task_group(void) : pending(0U), parent(running_group())
+            {
+                return;
+            }
+
+            /*  True if this is group, or was created under one of its tasks. */
+            inline bool descends_from(const task_group *group) const
+            {
+                const task_group *ancestor = this;
+
+                while (ancestor && ancestor != group)
+                    ancestor = ancestor->parent;
+
+                return ancestor != NULL;
+            }
+        };
+
+        /**********************************************************************
+         *  Struct:                                                           *
+         *      scheduler                                                     *
+         *  Purpose:                                                          *
+         *      A work-stealing thread pool. Tasks may spawn more tasks and   *
+         *      wait for them, so jobs of very different sizes can be broken  *
+         *      up as finely as they need and run side by side.               *
+         *  Notes:                                                            *
+         *      Each thread has its own queue. New tasks go on the back of    *
+         *      the queue of the thread that spawned them, and a thread takes *
+         *      its own work from the back, so it stays on the data it just   *
+         *      touched. A thread with nothing to do steals from the front of *
+         *      the other queues, which holds the oldest, and usually the     *
+         *      largest, pieces of work. A thread waiting for a group runs    *
+         *      tasks of that group, and of groups created under them, in the *
+         *      meantime rather than blocking. It never picks up unrelated    *
+         *      work, so a task does not end up running beneath a sibling on  *
+         *      the same stack, holding on to its memory until it returns.    *
+         *      Inside a task, parallel::for_each spawns its items as tasks   *
+         *      of the scheduler instead of starting threads, so everything   *
+         *      built on it (tone mapping, merging, PNG encoding) is stolen   *
+         *      in pieces without any changes.                                *
+         **********************************************************************/
+        struct scheduler {
+
+            /*  A task, and the group that is told when it is done.           */
+            struct task {
+                std::function<void(void)> func;
+                task_group *group;
+            };
+
+            /*  A queue of tasks and the lock protecting it.                  */
+            struct queue {
+                std::mutex lock;
+                std::deque<task> tasks;
+            };
+
+            /*  One queue per thread. The last belongs to whichever thread    *
+             *  called run, the others to the threads of the pool.            */
+            std::vector<queue> queues;
+            std::vector<std::thread> threads;
+
+            /*  Number of tasks in all of the queues, for idle threads.       */
+            std::atomic<unsigned int> queued;
+
+            /*  Set by the destructor to stop the threads.                    */
+            std::atomic<bool> stopping;
+
+            /*  Idle threads sleep here until a task is spawned.              */
+            std::mutex sleep_lock;
+            std::condition_variable wake;
+
+            /*  Constructor, starts count - 1 threads. Zero uses all of them. */
+            scheduler(unsigned int count = 0U);
+
+            /*  Destructor, stops and joins the threads.                      */
+            ~scheduler(void);
+
+            /*  The number of threads, counting the one that calls run.       */
+            inline unsigned int size(void) const;
+
+            /*  Adds a task to a group. Safe to call from any task.           */
+            inline void
+            spawn(task_group &group, std::function<void(void)> func);
+
+            /*  Runs tasks until every task of the group has finished.        */
+            inline void wait(task_group &group);
+
+            /*  Runs func as a task on the calling thread, and its children   *
+             *  on every thread. Returns when they are all done.              */
+            template <typename Tfunc>
+            inline void run(Tfunc func);
+
+            /*  The scheduler running the current task, NULL outside one.     */
+            static inline scheduler *&current(void);
+
+            /*  The queue of the current thread, if current is not NULL.      */
+            static inline unsigned int &current_queue(void);
+
+        private:
+
+            /*  Runs one task, stealing if need be. False if none was found.  *
+             *  If within is not NULL, only its tasks and their children run. */
+            inline bool run_one(unsigned int self, const task_group *within);
+
+            /*  The loop of each thread of the pool.                          */
+            inline void work(unsigned int self);
+
+            /*  The threads point back at the scheduler, it cannot move.      */
+            scheduler(const scheduler &);
+            scheduler &operator = (const scheduler &);
+        };
+
+        /*  Starts the pool. The thread calling run is the last worker.       */
+        inline scheduler::scheduler(unsigned int count)
+            : queues(count == 0U ? number_of_threads() : count),
+              queued(0U), stopping(false)
+        {
+            unsigned int n;
+
+            for (n = 0U; n + 1U < queues.size(); ++n)
+                threads.emplace_back(&scheduler::work, this, n);
+        }
+
+        /*  Wake everyone up so they see the flag, then wait for them.        */
+        inline scheduler::~scheduler(void)
+        {
+            unsigned int n;
+
+            {
+                std::lock_guard<std::mutex> guard(sleep_lock);
+                stopping = true;
+            }
+
+            wake.notify_all();
+
+            for (n = 0U; n < threads.size(); ++n)
+                threads[n].join();
+        }
+
+        inline unsigned int scheduler::size(void) const
+        {
+            return static_cast<unsigned int>(queues.size());
+        }
+
+        /*  Thread-local so that tasks can find the scheduler they are on.    */
+        inline scheduler *&scheduler::current(void)
+        {
+            static thread_local scheduler *pool = NULL;
+            return pool;
+        }
+
+        inline unsigned int &scheduler::current_queue(void)
+        {
+            static thread_local unsigned int index = 0U;
+            return index;
+        }
+
+        /**********************************************************************
+         *  Method:                                                           *
+         *      spawn                                                         *
+         *  Purpose:                                                          *
+         *      Queues a task on the queue of the calling thread.             *
+         *  Arguments:                                                        *
+         *      group (bf::parallel::task_group &):                           *
+         *          The group the task belongs to. It must outlive the task.  *
+         *      func (std::function<void(void)>):                             *
+         *          The task.                                                 *
+         *  Outputs:                                                          *
+         *      None (void).                                                  *
+         *  Notes:                                                            *
+         *      Threads outside the pool use the queue of the caller of run.  *
+         *      The sleep lock is taken after the task is counted, so a       *
+         *      thread deciding to sleep either sees the task or is already   *
+         *      waiting when the notification is sent.                        *
+         **********************************************************************/
+        inline void
+        scheduler::spawn(task_group &group, std::function<void(void)> func)
+        {
+            const unsigned int self = (current() == this ? current_queue() :
+                                       size() - 1U);
+            queue &mine = queues[self];
+
+            group.pending.fetch_add(1U);
+
+            {
+                std::lock_guard<std::mutex> guard(mine.lock);
+                mine.tasks.push_back(task());
+                mine.tasks.back().func.swap(func);
+                mine.tasks.back().group = &group;
+            }
+
+            queued.fetch_add(1U);
+
+            {
+                std::lock_guard<std::mutex> guard(sleep_lock);
+            }
+
+            wake.notify_one();
+        }
+
+        /*  Own queue from the back, then the others from the front. Tasks    *
+         *  outside of within are passed over, they stay where they are.      */
+        inline bool
+        scheduler::run_one(unsigned int self, const task_group *within)
+        {
+            const unsigned int count = size();
+            task_group * const previous = running_group();
+            task item;
+            unsigned int n;
+            bool found = false;
+
+            for (n = 0U; n < count && !found; ++n)
+            {
+                queue &victim = queues[(self + n) % count];
+                std::lock_guard<std::mutex> guard(victim.lock);
+                const std::size_t length = victim.tasks.size();
+                std::size_t k;
+
+                for (k = 0U; k < length && !found; ++k)
+                {
+                    const std::size_t index = (n == 0U ? length - 1U - k : k);
+                    task &candidate = victim.tasks[index];
+
+                    if (within && !candidate.group->descends_from(within))
+                        continue;
+
+                    item.func.swap(candidate.func);
+                    item.group = candidate.group;
+                    victim.tasks.erase(victim.tasks.begin() +
+                                       static_cast<std::ptrdiff_t>(index));
+                    found = true;
+                }
+            }
+
+            if (!found)
+                return false;
+
+            queued.fetch_sub(1U);
+            running_group() = item.group;
+            item.func();
+            running_group() = previous;
+            item.group->pending.fetch_sub(1U, std::memory_order_release);
+            return true;
+        }
+
+        /*  A thread of the pool runs tasks until the scheduler is done.      */
+        inline void scheduler::work(unsigned int self)
+        {
+            current() = this;
+            current_queue() = self;
+
+            while (!stopping)
+            {
+                if (run_one(self, NULL))
+                    continue;
+
+                std::unique_lock<std::mutex> guard(sleep_lock);
+
+                if (queued == 0U && !stopping)
+                    wake.wait(guard);
+            }
+        }
+
+        /*  Help out with the group until it is done. A task only waits for   *
+         *  groups created under it, and the tasks run here are all below the *
+         *  one waiting, so no two threads can end up waiting on each other.  */
+        inline void scheduler::wait(task_group &group)
+        {
+            const unsigned int self = (current() == this ? current_queue() :
+                                       size() - 1U);
+
+            while (group.pending.load(std::memory_order_acquire) != 0U)
+                if (!run_one(self, &group))
+                    std::this_thread::yield();
+        }
+
+        /*  The caller becomes the last worker until func and its children    *
+         *  have finished.                                                    */
+        template <typename Tfunc>
+        inline void scheduler::run(Tfunc func)
+        {
+            scheduler * const previous = current();
+            const unsigned int previous_queue = current_queue();
+            task_group group;
+
+            current() = this;
+            current_queue() = size() - 1U;
+
+            spawn(group, func);
+            wait(group);
+
+            current() = previous;
+            current_queue() = previous_queue;
+        }
+
+        /**********************************************************************
+         *  Function:                                                         *
+         *      for_each                                                      *
+         *  Purpose:                                                          *
+         *      Calls func(n) for every n in [0, count) using a pool of       *
+         *      worker threads. Items are handed out one at a time from a     *
+         *      shared counter, so uneven work loads balance themselves.      *
+         *  Arguments:                                                        *
+         *      count (unsigned int):                                         *
+         *          The number of work items.                                 *
+         *      func (Tfunc):                                                 *
+         *          A callable object taking an unsigned int.                 *
+         *      threads (unsigned int):                                       *
+         *          The maximum number of threads to use. Zero means use all  *
+         *          of the hardware threads.                                  *
+         *  Outputs:                                                          *
+         *      None (void).                                                  *
+         *  Notes:                                                            *
+         *      The calling thread takes part in the work, so a single item,  *
+         *      or a single thread, does not spawn anything.                  *
+         *      Inside a task of a scheduler, the items are spawned as tasks  *
+         *      of that scheduler instead, and any threads limit other than   *
+         *      one is ignored since the scheduler already has its threads.   *
+         **********************************************************************/
+        template <typename Tfunc>
+        inline void
+        for_each(unsigned int count, Tfunc func, unsigned int threads = 0U)
+        {
+            /*  Shared counter for the next work item to be processed.        */
+            std::atomic<unsigned int> next(0U);
+
+            /*  The worker threads, the calling thread is not stored here.    */
+            std::vector<std::thread> pool;
+
+            /*  Index for looping over the threads.                           */
+            unsigned int n;
+
+            /*  The scheduler running this code, if any.                      */
+            scheduler * const tasks = scheduler::current();
+
+            /*  Each worker grabs items until the counter runs out.           */
+            auto worker = [&](void)
+            {
+                unsigned int item = next.fetch_add(1U);
+
+                while (item < count)
+                {
+                    func(item);
+                    item = next.fetch_add(1U);
+                }
+            };
+
+            /*  Leave the threads to the scheduler, items are stolen by it.   */
+            if (tasks && threads != 1U && count > 1U)
+            {
+                task_group group;
+
+                for (n = 0U; n < count; ++n)
+                    tasks->spawn(group, [&func, n](void) {func(n);});
+
+                tasks->wait(group);
+                return;
+            }
+
+            /*  Zero means "use everything the hardware has."                 */
+            if (threads == 0U)
+                threads = number_of_threads();
+
+            /*  There is no point in having more threads than items.          */
+            if (threads > count)
+                threads = count;
+
+            /*  Spawn the helper threads. The caller is the final worker.     */
+            for (n = 1U; n < threads; ++n)
+                pool.emplace_back(worker);
+
+            worker();
+
+            /*  Wait for all of the helpers to finish.                        */
+            for (n = 1U; n < threads; ++n)
+                pool[n - 1U].join();
+        }
+        /*  End of for_each.                                                  */
+    }
+    /*  End of namespace "parallel".                                          */
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,420 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Provides hardware performance counters, via Linux perf_event_open,    *
+ *      for profiling the stages of a render. Counters that the kernel or     *
+ *      the CPU do not provide are reported as unavailable, not as errors.    *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_PERF_HPP
+#define BF_PERF_HPP
+
+/*  Fixed-width integer types, std::uint64_t.                                 */
+#include <cstdint>
+
+/*  FILE data type and std::fprintf found here.                               */
+#include <cstdio>
+
+/*  std::memset and std::strerror found here.                                 */
+#include <cstring>
+
+/*  perf_event_open only exists on Linux. Elsewhere nothing is counted.       */
+#if defined(__linux__)
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  The events that are counted, in the order they are reported.          */
+    enum perf_event_kind {
+        perf_cycles,
+        perf_instructions,
+        perf_branch_misses,
+        perf_l1d_misses,
+        perf_llc_misses,
+        perf_dtlb_misses,
+        number_of_perf_events
+    };
+
+    /*  Names of the events, for the reports.                                 */
+    static const char * const perf_event_names[number_of_perf_events] = {
+        "cycles", "instructions", "branch_misses",
+        "l1d_misses", "llc_misses", "dtlb_misses"
+    };
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      perf_counters                                                     *
+     *  Purpose:                                                              *
+     *      A set of hardware counters for the calling thread.                *
+     *  Notes:                                                                *
+     *      Each event is opened on its own rather than as a group, so one    *
+     *      missing event (virtual machines often lack the cache events)      *
+     *      does not take the others with it. Only user space is counted,     *
+     *      which is allowed with the default perf_event_paranoid of 2. If    *
+     *      the kernel multiplexes the counters, the values are scaled by     *
+     *      the fraction of the time each one was actually running.           *
+     **************************************************************************/
+    struct perf_counters {
+
+        /*  File descriptors for the events, -1 if unavailable.               */
+        int fds[number_of_perf_events];
+
+        /*  errno from the first failed perf_event_open, zero if none.        */
+        int error;
+
+        /*  Constructor, opens the counters, all disabled.                    */
+        perf_counters(void);
+
+        /*  Destructor, closes the counters.                                  */
+        ~perf_counters(void);
+
+        /*  True if at least one event could be opened.                       */
+        inline bool available(void) const;
+
+        /*  Zeroes the counters and starts counting.                          */
+        inline void start(void);
+
+        /*  Stops counting and reads the values. Missing events are zero.     */
+        inline void stop(std::uint64_t *values, bool *valid);
+
+    private:
+
+        /*  Copying would close the descriptors twice.                        */
+        perf_counters(const perf_counters &);
+        perf_counters &operator = (const perf_counters &);
+    };
+
+#if defined(__linux__)
+    /*  There is no glibc wrapper for perf_event_open.                        */
+    inline int
+    open_perf_event(std::uint32_t type, std::uint64_t config)
+    {
+        struct perf_event_attr attr;
+
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = type;
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        return static_cast<int>(
+            syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0)
+        );
+    }
+
+    /*  Config for a hardware cache event, see perf_event_open(2).            */
+    inline std::uint64_t
+    perf_cache_event(std::uint64_t cache, std::uint64_t op,
+                     std::uint64_t result)
+    {
+        return cache | (op << 8) | (result << 16);
+    }
+#endif
+
+    /*  Opens every event that the kernel and the CPU support.                */
+    inline perf_counters::perf_counters(void) : error(0)
+    {
+        unsigned int n;
+
+        for (n = 0U; n < number_of_perf_events; ++n)
+            fds[n] = -1;
+
+#if defined(__linux__)
+        fds[perf_cycles] = open_perf_event(PERF_TYPE_HARDWARE,
+                                           PERF_COUNT_HW_CPU_CYCLES);
+
+        fds[perf_instructions] = open_perf_event(PERF_TYPE_HARDWARE,
+                                                 PERF_COUNT_HW_INSTRUCTIONS);
+
+        fds[perf_branch_misses] = open_perf_event(
+            PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES
+        );
+
+        fds[perf_l1d_misses] = open_perf_event(
+            PERF_TYPE_HW_CACHE,
+            perf_cache_event(PERF_COUNT_HW_CACHE_L1D,
+                             PERF_COUNT_HW_CACHE_OP_READ,
+                             PERF_COUNT_HW_CACHE_RESULT_MISS)
+        );
+
+        fds[perf_llc_misses] = open_perf_event(
+            PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES
+        );
+
+        fds[perf_dtlb_misses] = open_perf_event(
+            PERF_TYPE_HW_CACHE,
+            perf_cache_event(PERF_COUNT_HW_CACHE_DTLB,
+                             PERF_COUNT_HW_CACHE_OP_READ,
+                             PERF_COUNT_HW_CACHE_RESULT_MISS)
+        );
+
+        for (n = 0U; n < number_of_perf_events; ++n)
+            if (fds[n] < 0 && error == 0)
+                error = errno;
+#else
+        error = -1;
+#endif
+    }
+
+    /*  Closes whatever was opened.                                           */
+    inline perf_counters::~perf_counters(void)
+    {
+#if defined(__linux__)
+        unsigned int n;
+
+        for (n = 0U; n < number_of_perf_events; ++n)
+            if (fds[n] >= 0)
+                close(fds[n]);
+#endif
+    }
+
+    /*  Any one event is enough to be useful.                                 */
+    inline bool perf_counters::available(void) const
+    {
+        unsigned int n;
+
+        for (n = 0U; n < number_of_perf_events; ++n)
+            if (fds[n] >= 0)
+                return true;
+
+        return false;
+    }
+
+    /*  Reset and enable each event.                                          */
+    inline void perf_counters::start(void)
+    {
+#if defined(__linux__)
+        unsigned int n;
+
+        for (n = 0U; n < number_of_perf_events; ++n)
+        {
+            if (fds[n] < 0)
+                continue;
+
+            ioctl(fds[n], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds[n], PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      stop                                                              *
+     *  Purpose:                                                              *
+     *      Disables the counters and reads them.                             *
+     *  Arguments:                                                            *
+     *      values (std::uint64_t *):                                         *
+     *          Output, number_of_perf_events counts.                         *
+     *      valid (bool *):                                                   *
+     *          Output, whether each count could be measured.                 *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     **************************************************************************/
+    inline void perf_counters::stop(std::uint64_t *values, bool *valid)
+    {
+        unsigned int n;
+
+        for (n = 0U; n < number_of_perf_events; ++n)
+        {
+            values[n] = 0U;
+            valid[n] = false;
+        }
+
+#if defined(__linux__)
+        for (n = 0U; n < number_of_perf_events; ++n)
+            if (fds[n] >= 0)
+                ioctl(fds[n], PERF_EVENT_IOC_DISABLE, 0);
+
+        for (n = 0U; n < number_of_perf_events; ++n)
+        {
+            /*  The count, the time enabled, and the time running.            */
+            std::uint64_t data[3];
+
+            if (fds[n] < 0)
+                continue;
+
+            if (read(fds[n], data, sizeof(data)) != sizeof(data))
+                continue;
+
+            /*  Never scheduled on the PMU, there is nothing to report.       */
+            if (data[2] == 0U)
+                continue;
+
+            if (data[2] < data[1])
+                data[0] = static_cast<std::uint64_t>(
+                    static_cast<double>(data[0]) *
+                    static_cast<double>(data[1]) /
+                    static_cast<double>(data[2])
+                );
+
+            values[n] = data[0];
+            valid[n] = true;
+        }
+#endif
+    }
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      perf_profile                                                      *
+     *  Purpose:                                                              *
+     *      Hardware counts for each stage of bf::run.                        *
+     **************************************************************************/
+    struct perf_profile {
+
+        /*  The stages, in the order bf::run does them.                       */
+        enum stage {alloc, chaos, tone_map, write, number_of_stages};
+
+        /*  The counters, shared by all of the stages.                        */
+        perf_counters counters;
+
+        /*  The counts for every stage and event, and which are valid.        */
+        std::uint64_t values[number_of_stages][number_of_perf_events];
+        bool valid[number_of_stages][number_of_perf_events];
+
+        /*  Constructor, opens the counters.                                  */
+        perf_profile(void);
+
+        /*  Starts counting for a stage.                                      */
+        inline void start(void);
+
+        /*  Stops counting and saves the counts for the given stage.          */
+        inline void stop(stage s);
+
+        /*  Writes a table of the counts, per iteration and per pixel.        */
+        inline void
+        report(std::FILE *fp, std::uint64_t iterations,
+               std::uint64_t pixels) const;
+    };
+
+    /*  Names of the stages, for the report.                                  */
+    static const char * const perf_stage_names[] = {
+        "alloc", "chaos", "tone_map", "write"
+    };
+
+    /*  Constructor. Nothing has been measured yet.                           */
+    inline perf_profile::perf_profile(void)
+    {
+        std::memset(values, 0, sizeof(values));
+        std::memset(valid, 0, sizeof(valid));
+    }
+
+    inline void perf_profile::start(void)
+    {
+        counters.start();
+    }
+
+    inline void perf_profile::stop(stage s)
+    {
+        counters.stop(values[s], valid[s]);
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      report                                                            *
+     *  Purpose:                                                              *
+     *      Writes the counts, normalized so stages can be compared.          *
+     *  Arguments:                                                            *
+     *      fp (std::FILE *):                                                 *
+     *          The file to write to.                                         *
+     *      iterations (std::uint64_t):                                       *
+     *          The number of points, the chaos game is shown per point.      *
+     *      pixels (std::uint64_t):                                           *
+     *          The number of pixels, the other stages are shown per pixel.   *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Notes:                                                                *
+     *      If no counter could be opened a single line saying why is         *
+     *      written instead, so callers never need to check.                  *
+     **************************************************************************/
+    inline void
+    perf_profile::report(std::FILE *fp, std::uint64_t iterations,
+                         std::uint64_t pixels) const
+    {
+        unsigned int s, n;
+
+        if (!counters.available())
+        {
+#if defined(__linux__)
+            std::fprintf(fp, "perf: hardware counters unavailable (%s).\n",
+                         std::strerror(counters.error));
+
+            /*  ENOENT means there is no PMU, common in virtual machines.     */
+            if (counters.error == EACCES || counters.error == EPERM)
+                std::fprintf(fp, "perf: see "
+                                 "/proc/sys/kernel/perf_event_paranoid.\n");
+#else
+            std::fprintf(fp, "perf: hardware counters need Linux.\n");
+#endif
+            return;
+        }
+
+        std::fprintf(fp, "%-9s %-14s %16s %12s %s\n", "stage", "event",
+                     "count", "per unit", "unit");
+
+        for (s = 0U; s < number_of_stages; ++s)
+        {
+            const double per = static_cast<double>(
+                s == chaos ? iterations : pixels
+            );
+
+            for (n = 0U; n < number_of_perf_events; ++n)
+            {
+                if (!valid[s][n])
+                {
+                    std::fprintf(fp, "%-9s %-14s %16s %12s\n",
+                                 perf_stage_names[s], perf_event_names[n],
+                                 "n/a", "n/a");
+                    continue;
+                }
+
+                std::fprintf(fp, "%-9s %-14s %16llu %12.4f %s\n",
+                             perf_stage_names[s], perf_event_names[n],
+                             static_cast<unsigned long long>(values[s][n]),
+                             static_cast<double>(values[s][n]) / per,
+                             (s == chaos ? "point" : "pixel"));
+            }
+
+            /*  Instructions per cycle, the first thing to look at.           */
+            if (valid[s][perf_cycles] && valid[s][perf_instructions] &&
+                values[s][perf_cycles] != 0U)
+                std::fprintf(fp, "%-9s %-14s %16s %12.4f\n",
+                             perf_stage_names[s], "ipc", "",
+                             static_cast<double>(values[s][perf_instructions]) /
+                             static_cast<double>(values[s][perf_cycles]));
+        }
+    }
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,161 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Provides a struct for writing PFM files, floating point images.       *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/* Include guard to prevent including this file twice.                        */
+#ifndef BF_PFM_HPP
+#define BF_PFM_HPP
+
+/*  File data type found here.                                                */
+#include <cstdio>
+
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Struct for working with PFM files.                                    */
+    struct pfm {
+
+        /*  Like the PPM struct, the "data" of the PFM is a FILE pointer.     */
+        FILE *fp;
+
+        /*  Constructor from a name, the name of the file.                    */
+        pfm(const char *name);
+
+        /*  Method for writing a float image with 1 (gray) or 3 (RGB) values  *
+         *  per pixel. Rows are given top to bottom, like the PPM files.      */
+        inline void
+        write(const float *data, unsigned int x, unsigned int y,
+              unsigned int channels);
+
+        /*  Method for closing the file pointer for the PFM. False if any     *
+         *  write failed, or the data could not be flushed to the file.       */
+        inline bool close(void);
+    };
+
+    /**************************************************************************
+     *  Constructor:                                                          *
+     *      pfm                                                               *
+     *  Purpose:                                                              *
+     *      Creates a PFM file with a given file name.                        *
+     *  Arguments:                                                            *
+     *      name (const char *):                                              *
+     *          The file name of the output PFM (ex. "barnsley_fern.pfm").    *
+     *  Outputs:                                                              *
+     *      PFM (bf::pfm):                                                    *
+     *          A PFM struct whose FILE pointer points to a pfm file that has *
+     *          been given write permissions.                                 *
+     *  Notes:                                                                *
+     *      As with bf::ppm, a warning is printed if fopen fails and it is    *
+     *      the caller's responsibility to inspect the FILE pointer.          *
+     **************************************************************************/
+    pfm::pfm(const char *name)
+    {
+        fp = std::fopen(name, "wb");
+
+        /*  Warn the caller is fopen failed.                                  */
+        if (!fp)
+            std::puts("ERROR: fopen failed and returned NULL.");
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      write                                                             *
+     *  Purpose:                                                              *
+     *      Writes the preamble and the pixels of a PFM file. The preamble is *
+     *      "PF" for color or "Pf" for grayscale, the size, and a scale whose *
+     *      sign gives the byte order, negative meaning little-endian.        *
+     *  Arguments:                                                            *
+     *      data (const float *):                                             *
+     *          The image, rows stored top to bottom.                         *
+     *      x (unsigned int):                                                 *
+     *          The number of pixels in the x axis.                           *
+     *      y (unsigned int):                                                 *
+     *          The number of pixels in the y axis.                           *
+     *      channels (unsigned int):                                          *
+     *          1 for grayscale, 3 for RGB.                                   *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Notes:                                                                *
+     *      PFM stores the rows bottom to top, so they are written in reverse *
+     *      order. The floats are written in the byte order of the machine.   *
+     **************************************************************************/
+    inline void
+    pfm::write(const float *data, unsigned int x, unsigned int y,
+               unsigned int channels)
+    {
+        const std::size_t row = static_cast<std::size_t>(x) * channels;
+        const unsigned int probe = 1U;
+        const bool little = *reinterpret_cast<const unsigned char *>(&probe);
+        unsigned int n;
+
+        if (!fp)
+            return;
+
+        std::fprintf(fp, "%s\n%u %u\n%s\n", (channels == 3U ? "PF" : "Pf"),
+                     x, y, (little ? "-1.0" : "1.0"));
+
+        for (n = y; n > 0U; --n)
+            std::fwrite(data + (n - 1U) * row, sizeof(*data), row, fp);
+    }
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      close                                                             *
+     *  Purpose:                                                              *
+     *      Closes the file pointer in a PFM struct.                          *
+     *  Arguments:                                                            *
+     *      None (void).                                                      *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          True if every write went through and the file was closed.     *
+     *  Notes:                                                                *
+     *      A failed fwrite, like on a full disk, sets the error flag of the  *
+     *      stream. Buffered data is written by fclose, which fails if that   *
+     *      write does. Both are checked here, so a truncated file is never   *
+     *      reported as written.                                              *
+     **************************************************************************/
+    inline bool pfm::close(void)
+    {
+        bool success;
+
+        /*  Ensure the pointer is not NULL before trying to close it.         */
+        if (!fp)
+            return false;
+
+        success = !std::ferror(fp);
+
+        if (std::fclose(fp) != 0)
+            success = false;
+
+        fp = NULL;
+        return success;
+    }
+}
+/*  End of namespace bf.                                                      */
+
+#endif
+/*  End of include guard.                                                     */
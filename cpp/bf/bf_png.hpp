@@ -0,0 +1,421 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Provides a struct for writing compressed PNG files.                   *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/* Include guard to prevent including this file twice.                        */
+#ifndef BF_PNG_HPP
+#define BF_PNG_HPP
+
+/*  File data type found here.                                                */
+#include <cstdio>
+
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::uint32_t.                                 */
+#include <cstdint>
+
+/*  std::vector, used for the compressed pieces of the image.                 */
+#include <vector>
+
+/*  Deflate encoder and the CRC-32 / Adler-32 checksums.                      */
+#include "bf_deflate.hpp"
+
+/*  Threading helpers, used to compress rows in parallel.                     */
+#include "bf_parallel.hpp"
+
+/*  Basic constants for the setup of the experiments given here.              */
+#include "bf_setup.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Struct for working with PNG files.                                    */
+    struct png {
+
+        /*  Like the PPM struct, the "data" of the PNG is a FILE pointer.     */
+        FILE *fp;
+
+        /*  Number of uncompressed bytes each thread works on at a time.      */
+        static const std::size_t chunk_size = 262144U;
+
+        /*  Constructor from a name, the name of the file.                    */
+        png(const char *name);
+
+        /*  Method for writing an RGB image with arbitrary dimensions.        */
+        inline void
+        write(const unsigned char *rgb, unsigned int x, unsigned int y);
+
+        /*  Method for writing an RGB image using the values in "setup".      */
+        inline void write(const unsigned char *rgb);
+
+        /*  Method for closing the file pointer for the PNG. False if any     *
+         *  write failed, or the data could not be flushed to the file.       */
+        inline bool close(void);
+
+        /*  Writes a PNG chunk, length, type, data, and CRC, to the file.     */
+        inline void
+        chunk(const char *type, const unsigned char *data, std::size_t length);
+
+        /*  Filters one row of pixels, choosing the filter per row.           */
+        static inline void
+        filter(const unsigned char *row, const unsigned char *above,
+               std::size_t length, unsigned char *out);
+    };
+
+    /*  Writes a 32-bit integer in big-endian order, as PNG requires.         */
+    inline void png_store32(unsigned char *out, std::uint32_t value)
+    {
+        out[0] = static_cast<unsigned char>(value >> 24U);
+        out[1] = static_cast<unsigned char>(value >> 16U);
+        out[2] = static_cast<unsigned char>(value >> 8U);
+        out[3] = static_cast<unsigned char>(value);
+    }
+
+    /**************************************************************************
+     *  Constructor:                                                          *
+     *      png                                                               *
+     *  Purpose:                                                              *
+     *      Creates a PNG file with a given file name.                        *
+     *  Arguments:                                                            *
+     *      name (const char *):                                              *
+     *          The file name of the output PNG (ex. "barnsley_fern.png").    *
+     *  Outputs:                                                              *
+     *      PNG (bf::png):                                                    *
+     *          A PNG struct whose FILE pointer points to a png file that has *
+     *          been given write permissions.                                 *
+     *  Notes:                                                                *
+     *      PNG is a binary format, so the file is opened with "wb". As with  *
+     *      bf::ppm, a warning is printed if fopen fails and it is the        *
+     *      caller's responsibility to inspect the FILE pointer.              *
+     **************************************************************************/
+    png::png(const char *name)
+    {
+        fp = std::fopen(name, "wb");
+
+        /*  Warn the caller is fopen failed.                                  */
+        if (!fp)
+            std::puts("ERROR: fopen failed and returned NULL.");
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      chunk                                                             *
+     *  Purpose:                                                              *
+     *      Writes a single PNG chunk. A chunk is the length of the data as a *
+     *      big-endian 32-bit integer, a four letter type, the data, and the  *
+     *      CRC-32 of the type and data.                                      *
+     *  Arguments:                                                            *
+     *      type (const char *):                                              *
+     *          The four letter chunk type, like "IHDR" or "IDAT".            *
+     *      data (const unsigned char *):                                     *
+     *          The contents of the chunk.                                    *
+     *      length (std::size_t):                                             *
+     *          The number of bytes in data.                                  *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     **************************************************************************/
+    inline void
+    png::chunk(const char *type, const unsigned char *data, std::size_t length)
+    {
+        unsigned char word[4];
+        const unsigned char * const tag =
+            reinterpret_cast<const unsigned char *>(type);
+
+        std::uint32_t crc = deflate::crc32(0U, tag, 4U);
+
+        crc = deflate::crc32(crc, data, length);
+
+        png_store32(word, static_cast<std::uint32_t>(length));
+        std::fwrite(word, 1U, 4U, fp);
+        std::fwrite(tag, 1U, 4U, fp);
+
+        if (length > 0U)
+            std::fwrite(data, 1U, length, fp);
+
+        png_store32(word, crc);
+        std::fwrite(word, 1U, 4U, fp);
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      filter                                                            *
+     *  Purpose:                                                              *
+     *      Applies a PNG row filter. Filters replace bytes by differences    *
+     *      with their neighbors, turning the flat background of the fern     *
+     *      into runs of zeros that deflate compresses very well.             *
+     *  Arguments:                                                            *
+     *      row (const unsigned char *):                                      *
+     *          The row of RGB pixels being filtered.                         *
+     *      above (const unsigned char *):                                    *
+     *          The previous row, or NULL for the first row of the image.     *
+     *      length (std::size_t):                                             *
+     *          The number of bytes in a row.                                 *
+     *      out (unsigned char *):                                            *
+     *          Output buffer with room for length + 1 bytes. The first byte  *
+     *          is the filter type.                                           *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Method:                                                               *
+     *      Use the usual heuristic from the PNG specification. Compute the   *
+     *      sum of the absolute values of the filtered bytes, treating them   *
+     *      as signed, for the None, Sub, and Up filters and pick the         *
+     *      smallest. Avg and Paeth are skipped since they are slower and     *
+     *      buy very little on images with large flat regions.                *
+     **************************************************************************/
+    inline void
+    png::filter(const unsigned char *row, const unsigned char *above,
+                std::size_t length, unsigned char *out)
+    {
+        std::size_t n;
+        std::size_t sum_none = 0U, sum_sub = 0U, sum_up = 0U;
+
+        for (n = 0U; n < length; ++n)
+        {
+            const unsigned char left = (n < 3U ? 0U : row[n - 3U]);
+            const unsigned char up = (above ? above[n] : 0U);
+            const signed char none = static_cast<signed char>(row[n]);
+            const signed char sub = static_cast<signed char>(row[n] - left);
+            const signed char upd = static_cast<signed char>(row[n] - up);
+
+            sum_none += static_cast<std::size_t>(none < 0 ? -none : none);
+            sum_sub += static_cast<std::size_t>(sub < 0 ? -sub : sub);
+            sum_up += static_cast<std::size_t>(upd < 0 ? -upd : upd);
+        }
+
+        /*  Sub filter, each byte minus the byte one pixel to the left.       */
+        if (sum_sub <= sum_none && sum_sub <= sum_up)
+        {
+            out[0] = 1U;
+
+            for (n = 0U; n < length; ++n)
+                out[n + 1U] = static_cast<unsigned char>(
+                    row[n] - (n < 3U ? 0U : row[n - 3U])
+                );
+        }
+
+        /*  Up filter, each byte minus the byte directly above it.            */
+        else if (above && sum_up <= sum_none)
+        {
+            out[0] = 2U;
+
+            for (n = 0U; n < length; ++n)
+                out[n + 1U] = static_cast<unsigned char>(row[n] - above[n]);
+        }
+
+        /*  No filter, copy the row.                                          */
+        else
+        {
+            out[0] = 0U;
+
+            for (n = 0U; n < length; ++n)
+                out[n + 1U] = row[n];
+        }
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      write                                                             *
+     *  Purpose:                                                              *
+     *      Writes an entire RGB image to the PNG file.                       *
+     *  Arguments:                                                            *
+     *      rgb (const unsigned char *):                                      *
+     *          The image, 3 bytes per pixel, rows stored top to bottom.      *
+     *      x (unsigned int):                                                 *
+     *          The number of pixels in the x axis.                           *
+     *      y (unsigned int):                                                 *
+     *          The number of pixels in the y axis.                           *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Method:                                                               *
+     *      The rows are split into bands of about chunk_size bytes. Each     *
+     *      band is filtered, checksummed, and compressed on its own thread   *
+     *      with bf::deflate::compress. The compressed bands are written out  *
+     *      in order as IDAT chunks, the zlib header is put in front of the   *
+     *      first one, and the Adler-32 values of the bands are combined to   *
+     *      produce the checksum for the end of the zlib stream.              *
+     **************************************************************************/
+    inline void
+    png::write(const unsigned char *rgb, unsigned int x, unsigned int y)
+    {
+        /*  Every PNG starts with this eight byte signature.                  */
+        static const unsigned char signature[8] = {
+            0x89U, 0x50U, 0x4EU, 0x47U, 0x0DU, 0x0AU, 0x1AU, 0x0AU
+        };
+
+        /*  Size of a row of pixels, and a filtered row with its type byte.   */
+        const std::size_t row_size = 3U * static_cast<std::size_t>(x);
+        const std::size_t line_size = row_size + 1U;
+
+        /*  Number of rows compressed at a time, at least one.                */
+        const std::size_t band_rows =
+            (chunk_size > line_size ? chunk_size / line_size : 1U);
+
+        const unsigned int number_of_bands = static_cast<unsigned int>(
+            (static_cast<std::size_t>(y) + band_rows - 1U) / band_rows
+        );
+
+        /*  Compressed output and Adler-32 checksum for each band.            */
+        std::vector< std::vector<unsigned char> > bands(number_of_bands);
+        std::vector<std::uint32_t> adlers(number_of_bands);
+
+        /*  Header data: width, height, bit depth 8, color type 2 (RGB), the  *
+         *  default compression and filter methods, and no interlacing.       */
+        unsigned char header[13];
+        unsigned char trailer[4];
+        std::uint32_t adler = 1U;
+        unsigned int n;
+
+        /*  Avoid writing to a NULL file, or an image PNG can not represent.  */
+        if (!fp)
+            return;
+
+        if (x == 0U || y == 0U)
+        {
+            std::puts("ERROR: PNG images must be at least 1x1 pixels.");
+            return;
+        }
+
+        /*  Filter and compress the bands in parallel.                        */
+        parallel::for_each(number_of_bands, [&](unsigned int band)
+        {
+            const std::size_t first = band * band_rows;
+            const std::size_t rows = (first + band_rows > y ?
+                                      y - first : band_rows);
+
+            std::vector<unsigned char> filtered(rows * line_size);
+            std::size_t row;
+
+            for (row = 0U; row < rows; ++row)
+            {
+                const std::size_t index = first + row;
+                const unsigned char *above =
+                    (index == 0U ? NULL : rgb + (index - 1U) * row_size);
+
+                filter(rgb + index * row_size, above, row_size,
+                       filtered.data() + row * line_size);
+            }
+
+            adlers[band] = deflate::adler32(1U, filtered.data(),
+                                            filtered.size());
+
+            /*  The zlib header, deflate with a 32 KiB window, goes first.    */
+            if (band == 0U)
+            {
+                bands[band].push_back(0x78U);
+                bands[band].push_back(0x01U);
+            }
+
+            deflate::compress(filtered.data(), filtered.size(),
+                              band + 1U == number_of_bands, bands[band]);
+        });
+
+        png_store32(header, x);
+        png_store32(header + 4U, y);
+        header[8] = 8U;
+        header[9] = 2U;
+        header[10] = 0U;
+        header[11] = 0U;
+        header[12] = 0U;
+
+        std::fwrite(signature, 1U, 8U, fp);
+        chunk("IHDR", header, 13U);
+
+        /*  Combine the checksums. Only the last band can be short.           */
+        for (n = 0U; n < number_of_bands; ++n)
+        {
+            const std::size_t rows = (n + 1U == number_of_bands ?
+                                      y - n * band_rows : band_rows);
+
+            adler = deflate::adler32_combine(adler, adlers[n],
+                                             rows * line_size);
+        }
+
+        /*  The zlib stream ends with the big-endian Adler-32 checksum.       */
+        png_store32(trailer, adler);
+        bands[number_of_bands - 1U].insert(
+            bands[number_of_bands - 1U].end(), trailer, trailer + 4U
+        );
+
+        for (n = 0U; n < number_of_bands; ++n)
+            chunk("IDAT", bands[n].data(), bands[n].size());
+
+        chunk("IEND", NULL, 0U);
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      write                                                             *
+     *  Purpose:                                                              *
+     *      Writes an RGB image using the values in "setup".                  *
+     *  Arguments:                                                            *
+     *      rgb (const unsigned char *):                                      *
+     *          The image, 3 bytes per pixel, rows stored top to bottom.      *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Method:                                                               *
+     *      Pass the default parameters to the other write function.          *
+     **************************************************************************/
+    inline void png::write(const unsigned char *rgb)
+    {
+        write(rgb, setup::xsize, setup::ysize);
+    }
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      close                                                             *
+     *  Purpose:                                                              *
+     *      Closes the file pointer in a PNG struct.                          *
+     *  Arguments:                                                            *
+     *      None (void).                                                      *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          True if every write went through and the file was closed.     *
+     *  Notes:                                                                *
+     *      A failed fwrite, like on a full disk, sets the error flag of the  *
+     *      stream. Buffered data is written by fclose, which fails if that   *
+     *      write does. Both are checked here, so a truncated file is never   *
+     *      reported as written.                                              *
+     **************************************************************************/
+    inline bool png::close(void)
+    {
+        bool success;
+
+        /*  Ensure the pointer is not NULL before trying to close it.         */
+        if (!fp)
+            return false;
+
+        success = !std::ferror(fp);
+
+        if (std::fclose(fp) != 0)
+            success = false;
+
+        fp = NULL;
+        return success;
+    }
+}
+/*  End of namespace bf.                                                      */
+
+#endif
+/*  End of include guard.                                                     */
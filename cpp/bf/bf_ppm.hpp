@@ -30,6 +30,9 @@
 /*  File data type found here.                                                */
 #include <cstdio>
 
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
 /*  Basic constants for the setup of the experiments given here.              */
 #include "bf_setup.hpp"
 
@@ -51,8 +54,13 @@ namespace bf {
         /*  Method for initializing the PPM using the values in "setup".      */
         inline void init(void);
 
-        /*  Method for closing the file pointer for the PPM.                  */
-        inline void close(void);
+        /*  Method for writing a whole RGB image after the preamble.          */
+        inline void
+        write(const unsigned char *rgb, unsigned int x, unsigned int y);
+
+        /*  Method for closing the file pointer for the PPM. False if any     *
+         *  write failed, or the data could not be flushed to the file.       */
+        inline bool close(void);
     };
 
     /**************************************************************************
@@ -141,6 +149,32 @@ namespace bf {
         init(setup::xsize, setup::ysize, 6);
     }
 
+    /**************************************************************************
+     *  Method:                                                               *
+     *      write                                                             *
+     *  Purpose:                                                              *
+     *      Writes a P6 preamble and an entire RGB image with one fwrite,     *
+     *      rather than pixel by pixel.                                       *
+     *  Arguments:                                                            *
+     *      rgb (const unsigned char *):                                      *
+     *          The image, 3 bytes per pixel, rows stored top to bottom.      *
+     *      x (unsigned int):                                                 *
+     *          The number of pixels in the x axis.                           *
+     *      y (unsigned int):                                                 *
+     *          The number of pixels in the y axis.                           *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     **************************************************************************/
+    inline void
+    ppm::write(const unsigned char *rgb, unsigned int x, unsigned int y)
+    {
+        if (!fp)
+            return;
+
+        init(x, y, 6);
+        std::fwrite(rgb, 3U, static_cast<std::size_t>(x) * y, fp);
+    }
+
     /**************************************************************************
      *  Function:                                                             *
      *      close                                                             *
@@ -149,15 +183,29 @@ namespace bf {
      *  Arguments:                                                            *
      *      None (void).                                                      *
      *  Outputs:                                                              *
-     *      None (void).                                                      *
+     *      success (bool):                                                   *
+     *          True if every write went through and the file was closed.     *
+     *  Notes:                                                                *
+     *      A failed fwrite, like on a full disk, sets the error flag of the  *
+     *      stream. Buffered data is written by fclose, which fails if that   *
+     *      write does. Both are checked here, so a truncated file is never   *
+     *      reported as written.                                              *
      **************************************************************************/
-    inline void ppm::close(void)
+    inline bool ppm::close(void)
     {
+        bool success;
+
         /*  Ensure the pointer is not NULL before trying to close it.         */
         if (!fp)
-            return;
+            return false;
+
+        success = !std::ferror(fp);
+
+        if (std::fclose(fp) != 0)
+            success = false;
 
-        std::fclose(fp);
+        fp = NULL;
+        return success;
     }
 }
 /*  End of namespace bf.                                                      */
@@ -0,0 +1,414 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Fern kernels templated on the real type, single and mixed precision,  *
+ *      and a mode that checks them against the double kernel.                *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_PRECISION_HPP
+#define BF_PRECISION_HPP
+
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::uint32_t and std::uint64_t.               */
+#include <cstdint>
+
+/*  std::vector, for the histograms compared by validate_precision.           */
+#include <vector>
+
+/*  The grayscale colorer, for comparing the images.                          */
+#include "bf_color.hpp"
+
+/*  Affine maps and iterated function systems.                                */
+#include "bf_ifs.hpp"
+
+/*  Threading helpers, the streams of a validation run in parallel.           */
+#include "bf_parallel.hpp"
+
+/*  xoshiro256** generator, one per stream.                                   */
+#include "bf_rng.hpp"
+
+/*  atomic_counter, the streams count into shared histograms.                 */
+#include "bf_shared.hpp"
+
+/*  View struct, the image size and the point-to-pixel conversion.            */
+#include "bf_view.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Affine transformation with a given real type, see bf::affine.         */
+    template <typename Treal>
+    struct real_affine {
+        Treal xx, xy, yx, yy;
+        Treal x_shift, y_shift;
+
+        inline void transform(Treal &x, Treal &y) const
+        {
+            const Treal x_old = x;
+            const Treal y_old = y;
+            x = xx*x_old + xy*y_old + x_shift;
+            y = yx*x_old + yy*y_old + y_shift;
+        }
+    };
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      real_ifs                                                          *
+     *  Purpose:                                                              *
+     *      An IFS with its maps rounded to a given real type.                *
+     *  Notes:                                                                *
+     *      The cutoffs stay double, and the map is picked from the same      *
+     *      number in [0, 100) as bf::ifs::select would use, so kernels of    *
+     *      different precisions given the same generator pick the same maps. *
+     *      Only the arithmetic on the point differs.                         *
+     **************************************************************************/
+    template <typename Treal>
+    struct real_ifs {
+        unsigned int number_of_maps;
+        double cutoff[max_maps];
+        real_affine<Treal> transform[max_maps];
+        Treal xstart, ystart;
+
+        explicit real_ifs(const ifs &fern);
+
+        inline unsigned int select(double random_value) const
+        {
+            unsigned int n = 0U;
+
+            while (n + 1U < number_of_maps && random_value >= cutoff[n])
+                ++n;
+
+            return n;
+        }
+    };
+
+    /*  Rounds every coefficient once, rather than on every iteration.        */
+    template <typename Treal>
+    inline real_ifs<Treal>::real_ifs(const ifs &fern)
+    {
+        unsigned int n;
+
+        number_of_maps = fern.number_of_maps;
+
+        for (n = 0U; n < max_maps; ++n)
+        {
+            const affine &T = fern.transform[n];
+
+            cutoff[n] = fern.cutoff[n];
+            transform[n].xx = static_cast<Treal>(T.xx);
+            transform[n].xy = static_cast<Treal>(T.xy);
+            transform[n].yx = static_cast<Treal>(T.yx);
+            transform[n].yy = static_cast<Treal>(T.yy);
+            transform[n].x_shift = static_cast<Treal>(T.x_shift);
+            transform[n].y_shift = static_cast<Treal>(T.y_shift);
+        }
+
+        xstart = static_cast<Treal>(fern.xstart);
+        ystart = static_cast<Treal>(fern.ystart);
+    }
+
+    /*  View with a given real type, see bf::view::point_to_pixel.            */
+    template <typename Treal>
+    struct real_view {
+        unsigned int xsize, ysize;
+        Treal xscale, yscale, xshift, yshift;
+
+        explicit real_view(const view &v)
+            : xsize(v.xsize), ysize(v.ysize),
+              xscale(static_cast<Treal>(v.xscale)),
+              yscale(static_cast<Treal>(v.yscale)),
+              xshift(static_cast<Treal>(v.xshift)),
+              yshift(static_cast<Treal>(v.yshift))
+        {
+            return;
+        }
+
+        inline bool
+        point_to_pixel(Treal xpt, Treal ypt, std::size_t &index) const
+        {
+            const Treal xpx = xshift + xscale*xpt;
+            const Treal ypx = yshift + yscale*ypt;
+
+            if (!(xpx >= Treal(0) && xpx < static_cast<Treal>(xsize)))
+                return false;
+
+            if (!(ypx >= Treal(0) && ypx < static_cast<Treal>(ysize)))
+                return false;
+
+            index = static_cast<std::size_t>(xpx) +
+                    static_cast<std::size_t>(ypx) * xsize;
+
+            return true;
+        }
+    };
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      count_points_real                                                 *
+     *  Purpose:                                                              *
+     *      The chaos game of count_points, with the point kept in Tpoint and *
+     *      the conversion to a pixel done in Tpixel.                         *
+     *  Arguments:                                                            *
+     *      counter (Tcounter &):                                             *
+     *          Told about every hit with add(index), like bf::plain_counter. *
+     *      fern (const bf::ifs &):                                           *
+     *          The maps and probabilities, rounded to Tpoint.                *
+     *      v (const bf::view &):                                             *
+     *          The image size and the conversion, rounded to Tpixel.         *
+     *      iterations (std::uint64_t):                                       *
+     *          The number of points to compute.                              *
+     *      x_pt (Tpoint &):                                                  *
+     *          The x coordinate of the current point. Updated on return.     *
+     *      y_pt (Tpoint &):                                                  *
+     *          The y coordinate of the current point. Updated on return.     *
+     *      gen (Trng &):                                                     *
+     *          The generator, like bf::rng.                                  *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Notes:                                                                *
+     *      float, float is the single-precision kernel, and float, double    *
+     *      the mixed one, which keeps the point in float but places it on    *
+     *      very large images in double. With double, double the counts are   *
+     *      the same as from count_points. On x86-64 the float kernel is      *
+     *      about as fast as the double one, since the loop is bound by the   *
+     *      generator, picking the map, and adding the hit, not by the two    *
+     *      multiply-adds on the point. Running several walkers side by side  *
+     *      in SIMD lanes, where float has twice as many, was tried and was   *
+     *      slower, as none of those three vectorize. float pays off where    *
+     *      double arithmetic is slow, and validate_precision says when the   *
+     *      image does not change.                                            *
+     **************************************************************************/
+    template <typename Tpoint, typename Tpixel, typename Tcounter,
+              typename Trng>
+    inline void
+    count_points_real(Tcounter &counter, const ifs &fern, const view &v,
+                      std::uint64_t iterations, Tpoint &x_pt, Tpoint &y_pt,
+                      Trng &gen)
+    {
+        const real_ifs<Tpoint> maps(fern);
+        const real_view<Tpixel> pixels(v);
+        Tpoint x_val = x_pt;
+        Tpoint y_val = y_pt;
+        std::uint64_t n;
+        std::size_t index;
+
+        for (n = 0U; n < iterations; ++n)
+        {
+            maps.transform[maps.select(gen.percent())].transform(x_val, y_val);
+
+            if (pixels.point_to_pixel(x_val, y_val, index))
+                counter.add(index);
+        }
+
+        x_pt = x_val;
+        y_pt = y_val;
+    }
+    /*  End of count_points_real.                                             */
+
+    /*  count_points_real as a function object, with the point in double.     */
+    template <typename Tpoint, typename Tpixel>
+    struct real_kernel {
+        template <typename Tcounter, typename Trng>
+        inline void
+        operator () (Tcounter &counter, const ifs &fern, const view &v,
+                     std::uint64_t iterations, double &x_pt, double &y_pt,
+                     Trng &gen) const
+        {
+            Tpoint x_val = static_cast<Tpoint>(x_pt);
+            Tpoint y_val = static_cast<Tpoint>(y_pt);
+
+            count_points_real<Tpoint, Tpixel>(counter, fern, v, iterations,
+                                              x_val, y_val, gen);
+
+            x_pt = static_cast<double>(x_val);
+            y_pt = static_cast<double>(y_val);
+        }
+    };
+
+    /*  How a lower precision kernel compares with the double one.            */
+    struct precision_report {
+
+        /*  The number of points each kernel computed.                        */
+        std::uint64_t points;
+
+        /*  Pixels whose counts differ, and the largest difference.           */
+        std::size_t pixels_differing;
+        std::uint32_t max_difference;
+
+        /*  Sum of the differences, each misplaced point counts twice.        */
+        std::uint64_t total_difference;
+
+        /*  Pixels whose color differs after the linear tone mapping, and     *
+         *  the largest difference in levels of 0 to 255.                     */
+        std::size_t colors_differing;
+        unsigned int max_color_difference;
+
+        /*  True if no color is more than tolerance levels off. The default   *
+         *  asks for the same image, byte for byte.                           */
+        inline bool indistinguishable(unsigned int tolerance = 0U) const
+        {
+            return max_color_difference <= tolerance;
+        }
+    };
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      validate_kernel                                                   *
+     *  Purpose:                                                              *
+     *      Renders a fern with the double kernel and with a lower precision  *
+     *      one, using the same random numbers, and compares the results.     *
+     *  Arguments:                                                            *
+     *      kernel (const Tkernel &):                                         *
+     *          The kernel to check, like bf::real_kernel<float, float>.      *
+     *          It is called like count_points_real, with a double point.     *
+     *      fern (const bf::ifs &):                                           *
+     *          The maps and probabilities.                                   *
+     *      v (const bf::view &):                                             *
+     *          The image size.                                               *
+     *      iterations (std::uint64_t):                                       *
+     *          The number of points each kernel computes.                    *
+     *      seed (std::uint64_t):                                             *
+     *          Seed for the generators.                                      *
+     *      scale_factor (double):                                            *
+     *          Scale of the linear tone mapping, as for bf::tone_map.        *
+     *  Outputs:                                                              *
+     *      report (bf::precision_report):                                    *
+     *          How far apart the two histograms and images are.              *
+     *  Method:                                                               *
+     *      The points are split into streams of 2^22, each with its own      *
+     *      generator, a burn-in of 16 points, and both kernels, so the maps  *
+     *      picked are the same and only rounding differs. The streams run    *
+     *      in parallel and count into two shared histograms. The images are  *
+     *      compared with the grayscale colorer, through its bytes: a lower   *
+     *      precision is safe at this size if no pixel changes color.         *
+     *  Notes:                                                                *
+     *      Every map of a fern is a contraction, so rounding errors do not   *
+     *      grow along a walk. A point only moves pixel when it lands within  *
+     *      about one rounding error of a pixel edge, which happens more as   *
+     *      the image grows. Run this at the size that will be rendered.      *
+     **************************************************************************/
+    template <typename Tkernel>
+    inline precision_report
+    validate_kernel(const Tkernel &kernel, const ifs &fern, const view &v,
+                    std::uint64_t iterations, std::uint64_t seed,
+                    double scale_factor = 1.0 / 256.0)
+    {
+        const std::uint64_t stream_points = 4194304U;
+        const unsigned int burn_in = 16U;
+        const std::uint64_t streams =
+            (iterations + stream_points - 1U) / stream_points;
+        const std::size_t pixels = v.number_of_pixels();
+        std::vector<std::uint32_t> reference(pixels, 0U);
+        std::vector<std::uint32_t> rounded(pixels, 0U);
+        precision_report report = precision_report();
+        std::size_t n;
+
+        report.points = iterations;
+
+        parallel::for_each(static_cast<unsigned int>(streams),
+                           [&](unsigned int stream)
+        {
+            const std::uint64_t first = stream * stream_points;
+            const std::uint64_t count =
+                (iterations - first < stream_points ?
+                 iterations - first : stream_points);
+            const real_ifs<double> maps(fern);
+            atomic_counter exact(&reference[0]);
+            atomic_counter close(&rounded[0]);
+            double x_val = fern.xstart, y_val = fern.ystart;
+            double x_low, y_low;
+            rng gen(seed, stream);
+            unsigned int k;
+
+            for (k = 0U; k < burn_in; ++k)
+                maps.transform[maps.select(gen.percent())].transform(
+                    x_val, y_val
+                );
+
+            x_low = x_val;
+            y_low = y_val;
+            count_points_real<double, double>(exact, fern, v, count,
+                                              x_val, y_val, gen);
+
+            /*  The same numbers again, for the second kernel.                */
+            gen = rng(seed, stream);
+
+            for (k = 0U; k < burn_in; ++k)
+                gen.percent();
+
+            kernel(close, fern, v, count, x_low, y_low, gen);
+        });
+
+        for (n = 0U; n < pixels; ++n)
+        {
+            const std::uint32_t a = reference[n];
+            const std::uint32_t b = rounded[n];
+            const std::uint32_t difference = (a > b ? a - b : b - a);
+            int red_a, red_b;
+            unsigned int levels;
+
+            if (difference == 0U)
+                continue;
+
+            ++report.pixels_differing;
+            report.total_difference += difference;
+
+            if (difference > report.max_difference)
+                report.max_difference = difference;
+
+            red_a = colorer::grayscale(1.0 - scale_factor*a).red;
+            red_b = colorer::grayscale(1.0 - scale_factor*b).red;
+            levels = static_cast<unsigned int>(
+                red_a > red_b ? red_a - red_b : red_b - red_a
+            );
+
+            if (levels == 0U)
+                continue;
+
+            ++report.colors_differing;
+
+            if (levels > report.max_color_difference)
+                report.max_color_difference = levels;
+        }
+
+        return report;
+    }
+    /*  End of validate_kernel.                                               */
+
+    /*  validate_kernel for count_points_real with the given types.           */
+    template <typename Tpoint, typename Tpixel>
+    inline precision_report
+    validate_precision(const ifs &fern, const view &v,
+                       std::uint64_t iterations, std::uint64_t seed,
+                       double scale_factor = 1.0 / 256.0)
+    {
+        return validate_kernel(real_kernel<Tpoint, Tpixel>(), fern, v,
+                               iterations, seed, scale_factor);
+    }
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,298 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Renders a histogram with forked worker processes that count into      *
+ *      shared memory, which the parent sums and keeps.                       *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_PROCESS_HPP
+#define BF_PROCESS_HPP
+
+/*  errno and EINTR, waitpid may be interrupted by a signal.                  */
+#include <cerrno>
+
+/*  Fixed-width integer types, std::uint32_t and std::uint64_t.               */
+#include <cstdint>
+
+/*  std::fflush, std::fprintf, and std::puts found here.                      */
+#include <cstdio>
+
+/*  std::memset, for clearing the region of a failed worker.                  */
+#include <cstring>
+
+/*  std::vector, for the process IDs of the workers.                          */
+#include <vector>
+
+/*  mmap and munmap, the histogram is shared with the workers.                */
+#include <sys/mman.h>
+
+/*  waitpid and the macros for reading its status.                            */
+#include <sys/wait.h>
+
+/*  fork, _exit, and sysconf.                                                 */
+#include <unistd.h>
+
+/*  The groups of the batch runner and batch::render_stream.                  */
+#include "bf_batch.hpp"
+
+/*  Histograms. The result is a mapped histogram, see release.                */
+#include "bf_histogram.hpp"
+
+/*  add_counts and merge_tile, for summing the regions of the workers.        */
+#include "bf_merge.hpp"
+
+/*  Threading helpers, the regions are summed in parallel.                    */
+#include "bf_parallel.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  How many times a worker that crashed is started again.                */
+    static const unsigned int process_retries = 2U;
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      start_worker                                                      *
+     *  Purpose:                                                              *
+     *      Forks a process that renders every workers-th stream of a group.  *
+     *  Arguments:                                                            *
+     *      group (const bf::batch_group &):                                  *
+     *          The group being rendered.                                     *
+     *      fern (const bf::ifs &):                                           *
+     *          The IFS of the group, from get_ifs.                           *
+     *      counts (std::uint32_t *):                                         *
+     *          The region of the shared mapping the worker counts into.      *
+     *      worker (unsigned int):                                            *
+     *          The index of the worker, which is also its first stream.      *
+     *      workers (unsigned int):                                           *
+     *          The total number of workers.                                  *
+     *  Outputs:                                                              *
+     *      pid (pid_t):                                                      *
+     *          The process ID of the worker, or -1 if fork failed.           *
+     *  Notes:                                                                *
+     *      The child only runs the chaos game, which neither allocates nor   *
+     *      takes locks, so it is safe even if the parent has other threads.  *
+     *      It leaves with _exit so that the buffers of stdio and the         *
+     *      destructors of the parent are not run twice.                      *
+     **************************************************************************/
+    inline pid_t
+    start_worker(const batch_group &group, const ifs &fern,
+                 std::uint32_t *counts, unsigned int worker,
+                 unsigned int workers)
+    {
+        const pid_t pid = fork();
+        std::uint64_t stream;
+
+        if (pid != 0)
+            return pid;
+
+        for (stream = worker; stream < group.number_of_streams();
+             stream += workers)
+            batch::render_stream(group, fern, counts, stream);
+
+        _exit(0);
+    }
+    /*  End of start_worker.                                                  */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      render_processes                                                  *
+     *  Purpose:                                                              *
+     *      Renders the histogram of a group with forked worker processes     *
+     *      that count into shared memory.                                    *
+     *  Arguments:                                                            *
+     *      group (const bf::batch_group &):                                  *
+     *          The group to render.                                          *
+     *      hist (bf::histogram &):                                           *
+     *          Output, the histogram. Any previous data is released.         *
+     *      workers (unsigned int):                                           *
+     *          The number of processes. Zero uses one per hardware thread.   *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if memory could not be mapped or a worker kept failing. *
+     *  Method:                                                               *
+     *      One anonymous shared mapping holds a region of counts for each    *
+     *      worker, each a whole number of pages. Worker w renders streams    *
+     *      w, w + workers, ..., exactly like lane w of batch::render, so the *
+     *      counts are the same as the batch runner's. The parent waits for   *
+     *      the workers, then adds the regions into the first one in tiles,   *
+     *      with threads, and unmaps the rest. The histogram then points      *
+     *      into the mapping, and nothing is copied through pipes or files.   *
+     *  Notes:                                                                *
+     *      A worker killed by a signal or exiting with an error has its      *
+     *      region cleared and is started again, up to process_retries        *
+     *      times. Its streams are rendered from scratch, so the result is    *
+     *      unchanged. A crash in a worker cannot corrupt the parent.         *
+     **************************************************************************/
+    inline bool
+    render_processes(const batch_group &group, histogram &hist,
+                     unsigned int workers)
+    {
+        const ifs fern = group.get_ifs();
+        const std::size_t pixels = group.v.number_of_pixels();
+        const std::size_t page =
+            static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+        const std::size_t bytes = pixels * sizeof(*hist.counts);
+        const std::size_t region = (bytes + page - 1U) / page * page;
+        const std::uint64_t streams = group.number_of_streams();
+        const std::size_t stride = region / sizeof(*hist.counts);
+        const std::size_t spare = 1U + batch_lane_memory / region;
+        const unsigned int tiles =
+            static_cast<unsigned int>((pixels + merge_tile - 1U) / merge_tile);
+        std::vector<pid_t> pids;
+        std::vector<unsigned int> tries;
+        std::uint32_t *counts;
+        unsigned int running = 0U;
+        bool failed = false;
+        unsigned int n;
+        void *mapping;
+
+        if (workers == 0U)
+            workers = parallel::number_of_threads();
+
+        if (workers > streams)
+            workers = static_cast<unsigned int>(streams);
+
+        if (workers > spare)
+            workers = static_cast<unsigned int>(spare);
+
+        if (workers == 0U)
+            workers = 1U;
+
+        hist.release();
+
+        /*  Anonymous shared memory is zeroed, and inherited by the children. */
+        mapping = mmap(NULL, workers * region, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+        if (mapping == MAP_FAILED)
+        {
+            std::puts("ERROR: mmap failed for the shared histogram.");
+            return false;
+        }
+
+        counts = static_cast<std::uint32_t *>(mapping);
+        pids.resize(workers, -1);
+        tries.resize(workers, 0U);
+
+        /*  Anything still buffered would otherwise be written by each child. */
+        std::fflush(NULL);
+
+        for (n = 0U; n < workers; ++n)
+        {
+            pids[n] = start_worker(group, fern, counts + n * stride,
+                                   n, workers);
+
+            if (pids[n] < 0)
+                failed = true;
+            else
+                ++running;
+        }
+
+        /*  Each worker is waited for by its pid, so children started by the  *
+         *  rest of the program are left for it to reap.                      */
+        for (n = 0U; n < workers; ++n)
+        {
+            while (pids[n] >= 0)
+            {
+                int status;
+
+                if (waitpid(pids[n], &status, 0) < 0)
+                {
+                    if (errno == EINTR)
+                        continue;
+
+                    /*  The child is gone and its counts cannot be trusted.   */
+                    failed = true;
+                    pids[n] = -1;
+                    --running;
+                    break;
+                }
+
+                --running;
+                pids[n] = -1;
+
+                if (WIFEXITED(status) && WEXITSTATUS(status) == 0)
+                    break;
+
+                std::fprintf(stderr, "ERROR: worker %u failed.\n", n);
+
+                if (failed || tries[n] == process_retries)
+                {
+                    failed = true;
+                    break;
+                }
+
+                ++tries[n];
+                std::memset(counts + n * stride, 0, bytes);
+                std::fflush(NULL);
+                pids[n] = start_worker(group, fern, counts + n * stride,
+                                       n, workers);
+
+                if (pids[n] < 0)
+                    failed = true;
+                else
+                    ++running;
+            }
+        }
+
+        if (failed || running > 0U)
+        {
+            munmap(mapping, workers * region);
+            return false;
+        }
+
+        if (workers > 1U)
+        {
+            parallel::for_each(tiles, [&](unsigned int tile)
+            {
+                const std::size_t start = tile * merge_tile;
+                const std::size_t length = (start + merge_tile > pixels ?
+                                            pixels - start : merge_tile);
+                unsigned int worker;
+
+                for (worker = 1U; worker < workers; ++worker)
+                    add_counts(counts + start,
+                               counts + worker * stride + start, length);
+            });
+
+            /*  Only the first region is still needed.                        */
+            munmap(static_cast<char *>(mapping) + region,
+                   (workers - 1U) * region);
+        }
+
+        hist.set_header(fern, group.v);
+        hist.header.rng = histogram_rng_xoshiro;
+        hist.header.seed = group.seed;
+        hist.header.iterations = group.iterations;
+        hist.counts = counts;
+        hist.mapping = mapping;
+        hist.mapping_size = region;
+        return true;
+    }
+    /*  End of render_processes.                                              */
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,375 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Provides a renderer that owns its buffers, so a service drawing many  *
+ *      ferns allocates once and reuses the memory for every render.          *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_RENDERER_HPP
+#define BF_RENDERER_HPP
+
+/*  std::size_t given here.                                                   */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::uint32_t and std::uint64_t.               */
+#include <cstdint>
+
+/*  std::memset found here.                                                   */
+#include <cstring>
+
+/*  std::vector, for the image and the color table.                           */
+#include <vector>
+
+/*  Basic color struct and the colorers.                                      */
+#include "bf_color.hpp"
+
+/*  The chaos game for an arbitrary IFS.                                      */
+#include "bf_fern.hpp"
+
+/*  Histogram struct, the counts are kept in one of these.                    */
+#include "bf_histogram.hpp"
+
+/*  IFS struct, the maps being drawn.                                         */
+#include "bf_ifs.hpp"
+
+/*  save_image, for writing PPM or PNG files by name.                         */
+#include "bf_image.hpp"
+
+/*  Thread pool, used for clearing and coloring.                              */
+#include "bf_parallel.hpp"
+
+/*  xoshiro256** generator, the renderer keeps its state between calls.       */
+#include "bf_rng.hpp"
+
+/*  View struct, the image size and the point-to-pixel conversion.            */
+#include "bf_view.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      renderer                                                          *
+     *  Purpose:                                                              *
+     *      Owns everything a render needs: the histogram, the generator and  *
+     *      the current point, a table of colors, and the RGB image. The      *
+     *      steps of bf::run are separate methods so they can be combined     *
+     *      freely, for example rendering once and coloring many times.       *
+     *  Notes:                                                                *
+     *      Nothing is allocated after the first render of a given size.      *
+     *      clear zeros the counts on every thread instead of freeing them,   *
+     *      so the pages stay mapped and are touched by the threads that      *
+     *      will later read them.                                             *
+     **************************************************************************/
+    struct renderer {
+
+        /*  Colorers are plain functions, like bf::colorer::grayscale.        */
+        typedef color (*colorer_type)(double);
+
+        /*  The maps and the view, and the histogram they fill.               */
+        ifs fern;
+        view v;
+        histogram hist;
+
+        /*  The generator and the current point, kept between renders.        */
+        rng gen;
+        double x_val, y_val;
+
+        /*  The maximum number of threads, zero for all of them.              */
+        unsigned int threads;
+
+        /*  The image, 3 * number_of_pixels bytes.                            */
+        std::vector<unsigned char> rgb;
+
+        /*  Colors for the small counts, and what they were computed for.     */
+        std::vector<color> table;
+        colorer_type table_color;
+        double table_scale;
+
+        /*  Constructor, allocates the buffers for an IFS and a view.         */
+        renderer(const ifs &fern = ifs::barnsley(), const view &v = view(),
+                 std::uint64_t seed = 1U, unsigned int threads = 0U);
+
+        /*  New maps or a new image size, reusing memory where possible.      */
+        inline bool reset(const ifs &fern, const view &v);
+
+        /*  Zeros the counts and restarts the chaos game from the start.      */
+        inline void clear(void);
+
+        /*  Restarts the generator, as if the renderer had just been made.    */
+        inline void reseed(std::uint64_t seed);
+
+        /*  Adds points to the histogram.                                     */
+        inline void render(std::uint64_t iterations);
+
+        /*  Colors the histogram into the RGB image.                          */
+        inline void
+        tone_map(colorer_type color, double scale_factor = 1.0 / 256.0);
+
+        /*  Writes the RGB image, see save_image. False if it failed.         */
+        inline bool write(const char *name) const;
+
+        /*  All three steps, from a cleared histogram. False if the write     *
+         *  failed or the renderer is not valid.                              */
+        inline bool
+        run(colorer_type color, const char *name,
+            std::uint64_t iterations = setup::total);
+
+        /*  False if an allocation failed. Everything else is then a no-op.   */
+        inline bool valid(void) const;
+
+    private:
+
+        /*  Copying would free the counts twice.                              */
+        renderer(const renderer &);
+        renderer &operator = (const renderer &);
+    };
+
+    /**************************************************************************
+     *  Constructor:                                                          *
+     *      renderer                                                          *
+     *  Purpose:                                                              *
+     *      Creates a renderer with empty counts and the image allocated.     *
+     *  Arguments:                                                            *
+     *      fern (const bf::ifs &):                                           *
+     *          The maps and probabilities to be drawn.                       *
+     *      v (const bf::view &):                                             *
+     *          The image size and the point-to-pixel conversion.             *
+     *      seed (std::uint64_t):                                             *
+     *          Seed for the generator.                                       *
+     *      threads (unsigned int):                                           *
+     *          The maximum number of threads. Zero uses all of them.         *
+     *  Notes:                                                                *
+     *      On allocation failure a message is printed and valid returns      *
+     *      false.                                                            *
+     **************************************************************************/
+    inline renderer::renderer(const ifs &fern, const view &v,
+                              std::uint64_t seed, unsigned int threads)
+        : fern(fern), v(v), hist(fern, v), gen(seed),
+          x_val(fern.xstart), y_val(fern.ystart), threads(threads),
+          rgb(3U * v.number_of_pixels()), table_color(NULL), table_scale(0.0)
+    {
+        hist.header.rng = histogram_rng_xoshiro;
+        hist.header.seed = seed;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      reset                                                             *
+     *  Purpose:                                                              *
+     *      Switches to a new IFS and view and clears the counts.             *
+     *  Arguments:                                                            *
+     *      fern (const bf::ifs &):                                           *
+     *          The maps and probabilities to be drawn.                       *
+     *      v (const bf::view &):                                             *
+     *          The image size and the point-to-pixel conversion.             *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if memory for the new size could not be found.          *
+     *  Notes:                                                                *
+     *      If the size is unchanged no memory is allocated, and the counts   *
+     *      are cleared in parallel. The generator is not reseeded.           *
+     **************************************************************************/
+    inline bool renderer::reset(const ifs &new_fern, const view &new_v)
+    {
+        const std::uint64_t seed = hist.header.seed;
+        const bool same_size = (hist.counts && new_v.xsize == v.xsize &&
+                                new_v.ysize == v.ysize);
+
+        fern = new_fern;
+        v = new_v;
+
+        /*  Just the header, clear does the counts with all of the threads.   */
+        if (same_size)
+            hist.set_header(fern, v);
+
+        else
+        {
+            if (!hist.reset(fern, v))
+                return false;
+
+            rgb.resize(3U * v.number_of_pixels());
+        }
+
+        hist.header.rng = histogram_rng_xoshiro;
+        hist.header.seed = seed;
+
+        if (same_size)
+            clear();
+
+        else
+        {
+            x_val = fern.xstart;
+            y_val = fern.ystart;
+        }
+
+        return true;
+    }
+
+    /*  Zeros the counts in bands, one band per work item.                    */
+    inline void renderer::clear(void)
+    {
+        /*  Bands of 1 MiB, large enough that memset runs at full speed.      */
+        const std::size_t band = (std::size_t(1) << 20) / sizeof(*hist.counts);
+        const std::size_t size = hist.number_of_pixels();
+        const unsigned int bands = static_cast<unsigned int>(
+            (size + band - 1U) / band
+        );
+        std::uint32_t * const counts = hist.counts;
+
+        if (!counts)
+            return;
+
+        parallel::for_each(bands, [&](unsigned int n)
+        {
+            const std::size_t first = static_cast<std::size_t>(n) * band;
+            const std::size_t length = (size - first < band ?
+                                        size - first : band);
+            std::memset(counts + first, 0, length * sizeof(*counts));
+        }, threads);
+
+        hist.header.iterations = 0U;
+        x_val = fern.xstart;
+        y_val = fern.ystart;
+    }
+
+    /*  A new seed gives a new sequence of points from the start point.       */
+    inline void renderer::reseed(std::uint64_t seed)
+    {
+        gen = rng(seed);
+        hist.header.seed = seed;
+        x_val = fern.xstart;
+        y_val = fern.ystart;
+    }
+
+    /*  Continues the chaos game from wherever the last render stopped.       */
+    inline void renderer::render(std::uint64_t iterations)
+    {
+        if (!hist.counts)
+            return;
+
+        create_fern(hist.counts, fern, v, iterations, x_val, y_val, gen);
+        hist.header.iterations += iterations;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      tone_map                                                          *
+     *  Purpose:                                                              *
+     *      Colors the histogram into the RGB image.                          *
+     *  Arguments:                                                            *
+     *      color (colorer_type):                                             *
+     *          The colorer, like bf::colorer::grayscale.                     *
+     *      scale_factor (double):                                            *
+     *          Scale factor for the intensity, as for bf::tone_map.          *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Method:                                                               *
+     *      Nearly every pixel has a small count, so the colors of the        *
+     *      counts below 1 / scale_factor (capped at 65536) are computed once *
+     *      and looked up. Larger counts call the colorer. The image is the   *
+     *      same as the one bf::tone_map makes.                               *
+     **************************************************************************/
+    inline void renderer::tone_map(colorer_type color, double scale_factor)
+    {
+        /*  Number of rows colored at a time by one thread.                   */
+        const unsigned int band_rows = 64U;
+        const unsigned int width = v.xsize;
+        const unsigned int height = v.ysize;
+        const unsigned int bands = (height + band_rows - 1U) / band_rows;
+
+        if (!hist.counts)
+            return;
+
+        /*  Rebuild the table only if the colorer or the scale changed.       */
+        if (color != table_color || scale_factor != table_scale)
+        {
+            const double limit = (scale_factor > 0.0 ?
+                                  1.0 / scale_factor + 2.0 : 65536.0);
+            const std::size_t size = (limit < 65536.0 ?
+                                      static_cast<std::size_t>(limit) :
+                                      65536U);
+            std::size_t n;
+
+            table.resize(size);
+
+            for (n = 0U; n < size; ++n)
+                table[n] = color(1.0 - scale_factor*static_cast<double>(n));
+
+            table_color = color;
+            table_scale = scale_factor;
+        }
+
+        parallel::for_each(bands, [&](unsigned int band)
+        {
+            const std::size_t first = static_cast<std::size_t>(band) *
+                                      band_rows * width;
+            const unsigned int rows = (band + 1U == bands ?
+                                       height - band*band_rows : band_rows);
+            const std::size_t last = first +
+                                     static_cast<std::size_t>(rows) * width;
+            const std::size_t size = table.size();
+            unsigned char * const out = rgb.data();
+            std::size_t index;
+
+            for (index = first; index < last; ++index)
+            {
+                const std::uint32_t count = hist.counts[index];
+                const bf::color c = (count < size ? table[count] :
+                                     color(1.0 - scale_factor*count));
+
+                out[3U*index] = c.red;
+                out[3U*index + 1U] = c.green;
+                out[3U*index + 2U] = c.blue;
+            }
+        }, threads);
+    }
+
+    inline bool renderer::write(const char *name) const
+    {
+        if (!hist.counts)
+            return false;
+
+        return save_image(rgb.data(), v.xsize, v.ysize, name);
+    }
+
+    /*  The whole of bf::run, without allocating anything.                    */
+    inline bool
+    renderer::run(colorer_type color, const char *name,
+                  std::uint64_t iterations)
+    {
+        clear();
+        render(iterations);
+        tone_map(color);
+        return write(name);
+    }
+
+    inline bool renderer::valid(void) const
+    {
+        return hist.counts != NULL;
+    }
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,134 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Provides a small, fast random number generator. Each instance has     *
+ *      its own state, so threads can draw numbers without locks.             *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_RNG_HPP
+#define BF_RNG_HPP
+
+/*  Fixed-width integer types, std::uint64_t.                                 */
+#include <cstdint>
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      splitmix64                                                        *
+     *  Purpose:                                                              *
+     *      Advances a 64-bit state and returns a well mixed hash of it.      *
+     *  Arguments:                                                            *
+     *      state (std::uint64_t &):                                          *
+     *          The state, updated on return.                                 *
+     *  Outputs:                                                              *
+     *      z (std::uint64_t):                                                *
+     *          The next output of the SplitMix64 generator.                  *
+     *  Notes:                                                                *
+     *      Used only for seeding. Nearby seeds, like 1, 2, 3, ..., give      *
+     *      unrelated outputs, so frame numbers can be used as seeds.         *
+     **************************************************************************/
+    inline std::uint64_t splitmix64(std::uint64_t &state)
+    {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /*  The xoshiro256** generator of Blackman and Vigna.                     */
+    struct rng {
+
+        /*  The 256 bits of state. Never all zero.                            */
+        std::uint64_t state[4];
+
+        /*  Constructor from a seed and a stream number.                      */
+        rng(std::uint64_t seed, std::uint64_t stream = 0U);
+
+        /*  Returns the next 64 random bits.                                  */
+        inline std::uint64_t next(void);
+
+        /*  Returns a random number in [0, 100), same range as the cutoffs.   */
+        inline double percent(void);
+    };
+
+    /**************************************************************************
+     *  Constructor:                                                          *
+     *      rng                                                               *
+     *  Purpose:                                                              *
+     *      Seeds the generator.                                              *
+     *  Arguments:                                                            *
+     *      seed (std::uint64_t):                                             *
+     *          The seed, stored in histogram headers.                        *
+     *      stream (std::uint64_t):                                           *
+     *          Selects one of many independent sequences for the same seed,  *
+     *          for example one per frame or one per thread.                  *
+     *  Outputs:                                                              *
+     *      gen (bf::rng):                                                    *
+     *          A generator ready for use.                                    *
+     **************************************************************************/
+    inline rng::rng(std::uint64_t seed, std::uint64_t stream)
+    {
+        std::uint64_t mix = stream;
+        std::uint64_t s = seed ^ splitmix64(mix);
+
+        state[0] = splitmix64(s);
+        state[1] = splitmix64(s);
+        state[2] = splitmix64(s);
+        state[3] = splitmix64(s);
+    }
+
+    /*  Rotates the bits of x to the left by k, 0 < k < 64.                   */
+    inline std::uint64_t rotate_left(std::uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    /*  xoshiro256** step. See https://prng.di.unimi.it/ for details.         */
+    inline std::uint64_t rng::next(void)
+    {
+        const std::uint64_t result = rotate_left(state[1] * 5U, 7) * 9U;
+        const std::uint64_t t = state[1] << 17;
+
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotate_left(state[3], 45);
+
+        return result;
+    }
+
+    /*  The top 53 bits give a double in [0, 1), which is scaled to 100.      */
+    inline double rng::percent(void)
+    {
+        const double scale_factor = 100.0 / 9007199254740992.0;
+        return static_cast<double>(next() >> 11) * scale_factor;
+    }
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,614 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Provides a render server on a Unix domain socket, with a cache of     *
+ *      histograms and images on disk keyed by a hash of the parameters.      *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_SERVER_HPP
+#define BF_SERVER_HPP
+
+/*  std::atomic, the flag set by "quit".                                      */
+#include <atomic>
+
+/*  std::condition_variable, serve waits on one for the connections to end.   */
+#include <condition_variable>
+
+/*  Fixed-width integer types, std::uint64_t.                                 */
+#include <cstdint>
+
+/*  FILE data type, std::fopen, std::snprintf, and std::rename found here.    */
+#include <cstdio>
+
+/*  std::strcmp, std::strncmp, and std::strlen found here.                    */
+#include <cstring>
+
+/*  std::mutex, renders take turns with the warm buffers.                     */
+#include <mutex>
+
+/*  std::string, for the file names in the cache.                             */
+#include <string>
+
+/*  std::thread, each connection is answered on its own thread.               */
+#include <thread>
+
+/*  signal and SIGPIPE, a client hanging up must not kill the server.         */
+#include <signal.h>
+
+/*  socket, bind, listen, accept, and the sockaddr_un struct.                 */
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+
+/*  read, write, close, unlink, and getpid.                                   */
+#include <unistd.h>
+
+/*  Animation buffers, reused here as the warm buffers of the server.         */
+#include "bf_animation.hpp"
+
+/*  The manifest parser and the batch renderer, shared with the server.       */
+#include "bf_batch.hpp"
+
+/*  Histograms, saving and loading them.                                      */
+#include "bf_histogram.hpp"
+
+/*  save_image and save_density, for writing image files.                     */
+#include "bf_image.hpp"
+
+/*  Work-stealing scheduler, kept running between requests.                   */
+#include "bf_parallel.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Seconds a client may take to send its request or read the reply.      */
+    static const long server_timeout = 10L;
+
+    /*  Connections answered at once. Past this, new ones are turned away.    */
+    static const unsigned int server_max_connections = 64U;
+
+    /*  64-bit FNV-1a hash of a string, for the names of the cache files.     */
+    inline std::uint64_t fnv1a(const char *text)
+    {
+        std::uint64_t hash = 0xCBF29CE484222325U;
+
+        while (*text)
+        {
+            hash ^= static_cast<unsigned char>(*text);
+            hash *= 0x100000001B3U;
+            ++text;
+        }
+
+        return hash;
+    }
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      server                                                            *
+     *  Purpose:                                                              *
+     *      A render server listening on a Unix domain socket.                *
+     *  Notes:                                                                *
+     *      A request is one line of a batch manifest with out= replaced by   *
+     *      format=png, ppm, pfm, or hist (png if not given), for example:    *
+     *          growth=0.85 size=512x512 color=greenscale format=png          *
+     *      The reply is a line "OK <bytes> <hit|miss>" followed by the       *
+     *      file, or a line "ERROR <message>". The line "quit" stops the      *
+     *      server. Each connection carries one request.                      *
+     *      Every connection is answered on its own thread, and a client has  *
+     *      server_timeout seconds to send its request, so a slow or silent   *
+     *      client holds up no one else. Cached files are sent straight away, *
+     *      even while a render is running. Renders take turns, since each    *
+     *      one already uses every thread of the scheduler.                   *
+     *      Histograms are cached as <hash>.hist and images as <hash>.png     *
+     *      and so on, where the hash covers every parameter that changes     *
+     *      the file. Recoloring a cached histogram skips the chaos game,     *
+     *      and a repeated request just reads the file back. Files are        *
+     *      written under a temporary name and renamed only once every write  *
+     *      and the close went through, so a failed or interrupted write      *
+     *      never leaves a bad entry. Nothing is ever evicted, delete         *
+     *      files from the directory to make room.                            *
+     *      The scheduler and one set of buffers live as long as the          *
+     *      server, so requests of the same size reuse memory that is         *
+     *      already mapped and threads that are already running.              *
+     **************************************************************************/
+    struct server {
+
+        /*  The socket file and the listening socket, -1 until opened.        */
+        std::string socket_path;
+        int listener;
+
+        /*  The directory the cache files go in. It must already exist.       */
+        std::string cache_dir;
+
+        /*  Warm threads and buffers, kept between requests.                  */
+        parallel::scheduler pool;
+        frame_buffers warm;
+
+        /*  Held while rendering, the pool and warm buffers are shared.       */
+        std::mutex render_lock;
+
+        /*  The number of connections being answered, and a signal for when   *
+         *  one finishes.                                                     */
+        std::mutex connection_lock;
+        std::condition_variable connection_done;
+        unsigned int connections;
+
+        /*  Set by "quit".                                                    */
+        std::atomic<bool> stopping;
+
+        /*  Constructor, nothing is opened until open is called.              */
+        server(const char *socket_path, const char *cache_dir,
+               unsigned int threads = 0U);
+
+        /*  Destructor, closes and removes the socket.                        */
+        ~server(void);
+
+        /*  Creates the socket and starts listening.                          */
+        inline bool open(void);
+
+        /*  Answers requests until one of them is "quit".                     */
+        inline void serve(void);
+
+        /*  Answers one connection, then closes it. Run on its own thread.    */
+        inline void answer(int fd);
+
+        /*  Answers the request on one connection. False for "quit".          */
+        inline bool handle(int fd);
+
+        /*  Creates the file for a request unless it is cached already.       */
+        inline bool
+        produce(const batch_group &group, const batch_job &job,
+                const char *format, std::string &path, bool &hit);
+    };
+
+    /*  Writes all of a buffer to a socket or file.                           */
+    inline bool write_all(int fd, const void *data, std::size_t length)
+    {
+        const char *bytes = static_cast<const char *>(data);
+
+        while (length > 0U)
+        {
+            const ssize_t written = write(fd, bytes, length);
+
+            if (written <= 0)
+                return false;
+
+            bytes += written;
+            length -= static_cast<std::size_t>(written);
+        }
+
+        return true;
+    }
+
+    /*  Sends "ERROR <message>" and returns, the connection is then closed.   */
+    inline void send_error(int fd, const char *message)
+    {
+        char reply[512];
+        const int length = std::snprintf(reply, sizeof(reply), "ERROR %s\n",
+                                         message);
+
+        if (length > 0)
+            write_all(fd, reply, static_cast<std::size_t>(length));
+    }
+
+    /*  Sends "OK <bytes> <status>" followed by the file.                     */
+    inline bool send_file(int fd, const char *name, const char *status)
+    {
+        std::FILE * const fp = std::fopen(name, "rb");
+        char buffer[65536];
+        char header[128];
+        struct stat info;
+        std::size_t length;
+        int header_length;
+
+        if (!fp || fstat(fileno(fp), &info) != 0)
+        {
+            if (fp)
+                std::fclose(fp);
+
+            send_error(fd, "could not read the cached file");
+            return false;
+        }
+
+        header_length = std::snprintf(header, sizeof(header), "OK %llu %s\n",
+            static_cast<unsigned long long>(info.st_size), status);
+
+        if (!write_all(fd, header, static_cast<std::size_t>(header_length)))
+        {
+            std::fclose(fp);
+            return false;
+        }
+
+        while ((length = std::fread(buffer, 1U, sizeof(buffer), fp)) > 0U)
+        {
+            if (!write_all(fd, buffer, length))
+                break;
+        }
+
+        std::fclose(fp);
+        return true;
+    }
+
+    inline server::server(const char *socket_path, const char *cache_dir,
+                          unsigned int threads)
+        : socket_path(socket_path), listener(-1), cache_dir(cache_dir),
+          pool(threads), connections(0U), stopping(false)
+    {
+        return;
+    }
+
+    inline server::~server(void)
+    {
+        if (listener >= 0)
+        {
+            close(listener);
+            unlink(socket_path.c_str());
+        }
+    }
+
+    /*  A stale socket file from a crashed server is removed first.           */
+    inline bool server::open(void)
+    {
+        struct sockaddr_un address;
+
+        if (socket_path.size() >= sizeof(address.sun_path))
+        {
+            std::fprintf(stderr, "ERROR: socket path is too long.\n");
+            return false;
+        }
+
+        /*  Writing to a client that hung up raises SIGPIPE.                  */
+        signal(SIGPIPE, SIG_IGN);
+
+        std::memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, socket_path.c_str(),
+                    socket_path.size() + 1U);
+
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+
+        if (listener < 0)
+        {
+            std::perror("ERROR: socket");
+            return false;
+        }
+
+        unlink(socket_path.c_str());
+
+        if (bind(listener, reinterpret_cast<struct sockaddr *>(&address),
+                 sizeof(address)) != 0 || listen(listener, 16) != 0)
+        {
+            std::perror("ERROR: bind");
+            close(listener);
+            listener = -1;
+            return false;
+        }
+
+        return true;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      serve                                                             *
+     *  Purpose:                                                              *
+     *      Accepts connections and answers each on a thread of its own,      *
+     *      until a request is "quit".                                        *
+     *  Arguments:                                                            *
+     *      None (void).                                                      *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Notes:                                                                *
+     *      "quit" shuts the listening socket down, which wakes accept. The   *
+     *      connections still open are answered before serve returns.         *
+     **************************************************************************/
+    inline void server::serve(void)
+    {
+        struct timeval timeout;
+
+        timeout.tv_sec = server_timeout;
+        timeout.tv_usec = 0;
+
+        while (!stopping)
+        {
+            const int fd = accept(listener, NULL, NULL);
+            bool busy;
+
+            if (fd < 0)
+                continue;
+
+            /*  A client that stops sending or reading times out.             */
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+            {
+                std::lock_guard<std::mutex> guard(connection_lock);
+                busy = (connections >= server_max_connections);
+
+                if (!busy)
+                    ++connections;
+            }
+
+            if (busy)
+            {
+                send_error(fd, "too many connections");
+                close(fd);
+                continue;
+            }
+
+            std::thread(&server::answer, this, fd).detach();
+        }
+
+        {
+            std::unique_lock<std::mutex> guard(connection_lock);
+
+            while (connections > 0U)
+                connection_done.wait(guard);
+        }
+    }
+
+    /*  Answers, closes, and tells serve. "quit" also stops the accept loop.  */
+    inline void server::answer(int fd)
+    {
+        if (!handle(fd))
+        {
+            stopping = true;
+            shutdown(listener, SHUT_RDWR);
+        }
+
+        close(fd);
+
+        /*  Notified under the lock, serve may destroy the server as soon as  *
+         *  it sees the count reach zero.                                     */
+        {
+            std::lock_guard<std::mutex> guard(connection_lock);
+            --connections;
+            connection_done.notify_all();
+        }
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      handle                                                            *
+     *  Purpose:                                                              *
+     *      Reads a request from a connection and sends the reply.            *
+     *  Arguments:                                                            *
+     *      fd (int):                                                         *
+     *          The connection.                                               *
+     *  Outputs:                                                              *
+     *      running (bool):                                                   *
+     *          False if the request was "quit".                              *
+     **************************************************************************/
+    inline bool server::handle(int fd)
+    {
+        char text[4096];
+        std::size_t length = 0U;
+        std::string format = "png", settings, path;
+        batch_group group;
+        batch_job job;
+        char *rest = text, *token;
+        bool hit = false;
+
+        /*  The request ends at the first newline, or when the client         *
+         *  stops writing. A failed read is the timeout running out.          */
+        while (length + 1U < sizeof(text))
+        {
+            const ssize_t got = read(fd, text + length, 1U);
+
+            if (got < 0)
+            {
+                send_error(fd, "timed out waiting for the request");
+                return true;
+            }
+
+            if (got == 0 || text[length] == '\n')
+                break;
+
+            ++length;
+        }
+
+        text[length] = '\0';
+
+        if (std::strcmp(text, "quit") == 0)
+        {
+            write_all(fd, "OK 0 quit\n", 10U);
+            return false;
+        }
+
+        /*  Take out format=, the rest is a line of a manifest.               */
+        for (token = next_token(&rest, " \t\r"); token;
+             token = next_token(&rest, " \t\r"))
+        {
+            if (std::strncmp(token, "format=", 7U) == 0)
+                format = token + 7;
+
+            else
+            {
+                settings += token;
+                settings += ' ';
+            }
+        }
+
+        if (format != "png" && format != "ppm" &&
+            format != "pfm" && format != "hist")
+            send_error(fd, "format must be png, ppm, pfm, or hist");
+
+        else if (!batch::read_job(&settings[0], 1U, group, job))
+            send_error(fd, "bad request");
+
+        else if (!job.output.empty())
+            send_error(fd, "out= is not allowed, use format=");
+
+        else if (!produce(group, job, format.c_str(), path, hit))
+            send_error(fd, "the render failed");
+
+        else
+            send_file(fd, path.c_str(), hit ? "hit" : "miss");
+
+        return true;
+    }
+
+    /*  True if the file exists.                                              */
+    inline bool file_exists(const std::string &name)
+    {
+        struct stat info;
+        return stat(name.c_str(), &info) == 0;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      produce                                                           *
+     *  Purpose:                                                              *
+     *      Finds the file for a request in the cache, creating it if need    *
+     *      be. The histogram is taken from the cache if possible too.        *
+     *  Arguments:                                                            *
+     *      group (const bf::batch_group &):                                  *
+     *          The settings of the histogram.                                *
+     *      job (const bf::batch_job &):                                      *
+     *          The settings of the image.                                    *
+     *      format (const char *):                                            *
+     *          png, ppm, pfm, or hist.                                       *
+     *      path (std::string &):                                             *
+     *          Output, the cached file.                                      *
+     *      hit (bool &):                                                     *
+     *          Output, true if the file was already in the cache.            *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if the file could not be created.                       *
+     *  Notes:                                                                *
+     *      The hashed text spells out every parameter, and starts with a     *
+     *      version number to be bumped whenever the renders change.          *
+     *      The cache is checked before taking the render lock, so a hit      *
+     *      never waits for a render. It is checked again once the lock is    *
+     *      held, in case the render just before made the same file.          *
+     **************************************************************************/
+    inline bool
+    server::produce(const batch_group &group, const batch_job &job,
+                    const char *format, std::string &path, bool &hit)
+    {
+        const bool want_hist = (std::strcmp(format, "hist") == 0);
+        const bool want_pfm = (std::strcmp(format, "pfm") == 0);
+        char text[512], name[64];
+        std::uint64_t hist_key, image_key;
+        std::string hist_path, temporary;
+        histogram loaded;
+        const histogram *hist = &warm.hist;
+        std::unique_lock<std::mutex> guard(render_lock, std::defer_lock);
+        bool success = true;
+
+        std::snprintf(text, sizeof(text), "bf-hist 1 %s %.17g %u %u %llu %llu",
+                      group.preset.c_str(), group.growth, group.v.xsize,
+                      group.v.ysize,
+                      static_cast<unsigned long long>(group.iterations),
+                      static_cast<unsigned long long>(group.seed));
+
+        hist_key = fnv1a(text);
+
+        std::snprintf(text, sizeof(text), "bf-image 1 %016llx %s %s %.17g "
+                      "%.17g %.17g %s",
+                      static_cast<unsigned long long>(hist_key),
+                      (job.colorer == colorer::greenscale ?
+                       "greenscale" : "grayscale"),
+                      (job.log ? "log" : "linear"), job.params.exposure,
+                      job.params.gamma, job.params.white_point, format);
+
+        /*  A density only depends on the histogram.                          */
+        if (want_pfm)
+            std::snprintf(text, sizeof(text), "bf-density 1 %016llx",
+                          static_cast<unsigned long long>(hist_key));
+
+        image_key = fnv1a(text);
+
+        std::snprintf(name, sizeof(name), "/%016llx.hist",
+                      static_cast<unsigned long long>(hist_key));
+        hist_path = cache_dir + name;
+
+        std::snprintf(name, sizeof(name), "/%016llx.%s",
+                      static_cast<unsigned long long>(image_key), format);
+        path = (want_hist ? hist_path : cache_dir + name);
+
+        /*  The extension is kept, save_image picks the format from it.       */
+        std::snprintf(name, sizeof(name), "/tmp.%ld.%s",
+                      static_cast<long>(getpid()), format);
+        temporary = cache_dir + name;
+
+        hit = file_exists(path);
+
+        if (hit)
+            return true;
+
+        guard.lock();
+        hit = file_exists(path);
+
+        if (hit)
+            return true;
+
+        pool.run([&](void)
+        {
+            if (file_exists(hist_path) && loaded.load(hist_path.c_str()))
+                hist = &loaded;
+
+            else
+            {
+                success = batch::render(group, warm.hist, pool.size()) &&
+                          warm.hist.save(temporary.c_str()) &&
+                          std::rename(temporary.c_str(),
+                                      hist_path.c_str()) == 0;
+
+                if (!success || want_hist)
+                    return;
+            }
+
+            if (want_pfm)
+                success = save_density(*hist, temporary.c_str());
+
+            else
+            {
+                warm.rgb.resize(3U * hist->number_of_pixels());
+
+                if (job.log)
+                    tone_map(job.colorer, *hist, warm.rgb.data(), job.params);
+                else
+                    tone_map(job.colorer, *hist, warm.rgb.data(),
+                             group.linear_scale());
+
+                success = save_image(warm.rgb.data(), group.v.xsize,
+                                     group.v.ysize, temporary.c_str());
+            }
+
+            success = success &&
+                      std::rename(temporary.c_str(), path.c_str()) == 0;
+        });
+
+        /*  Whatever was written of a failed file is thrown away.             */
+        if (!success)
+            unlink(temporary.c_str());
+
+        return success;
+    }
+    /*  End of produce.                                                       */
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
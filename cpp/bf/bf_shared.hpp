@@ -0,0 +1,256 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Counting the points of one render into a histogram shared between     *
+ *      threads, and picking between this and a histogram per thread.         *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_SHARED_HPP
+#define BF_SHARED_HPP
+
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::uint32_t.                                 */
+#include <cstdint>
+
+/*  std::strcmp, for reading the name of a strategy.                          */
+#include <cstring>
+
+/*  std::vector, for the tiles of the caches.                                 */
+#include <vector>
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  How the threads of one render count their points.                     */
+    enum histogram_strategy {
+
+        /*  Pick one of the others with choose_strategy.                      */
+        strategy_auto,
+
+        /*  A histogram per thread, summed at the end.                        */
+        strategy_private,
+
+        /*  One histogram, every hit an atomic add.                           */
+        strategy_shared,
+
+        /*  One histogram, hits gathered in small caches per thread first.    */
+        strategy_cached
+    };
+
+    /*  Names of the strategies, in the order of the enum.                    */
+    static const char * const histogram_strategy_names[4] = {
+        "auto", "private", "shared", "cached"
+    };
+
+    /*  Reads a strategy from its name. Returns false for unknown names.      */
+    inline bool
+    parse_strategy(const char *name, histogram_strategy &strategy)
+    {
+        unsigned int n;
+
+        for (n = 0U; n < 4U; ++n)
+        {
+            if (std::strcmp(name, histogram_strategy_names[n]) == 0)
+            {
+                strategy = static_cast<histogram_strategy>(n);
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      choose_strategy                                                   *
+     *  Purpose:                                                              *
+     *      Picks how the threads of a render should count their points.      *
+     *  Arguments:                                                            *
+     *      pixels (std::size_t):                                             *
+     *          The number of pixels in the image.                            *
+     *      threads (unsigned int):                                           *
+     *          The number of threads counting at once.                       *
+     *      budget (std::size_t):                                             *
+     *          Bytes that may be spent on counts besides the histogram.      *
+     *  Outputs:                                                              *
+     *      strategy (bf::histogram_strategy):                                *
+     *          strategy_private or strategy_shared.                          *
+     *  Notes:                                                                *
+     *      Private histograms need no atomic operations, so they are used    *
+     *      whenever the extra threads - 1 of them fit in the budget. Past    *
+     *      that, for large images or many threads, every thread adds to the  *
+     *      one histogram atomically. The cached strategy is not picked. The  *
+     *      hits of a fern are spread thinly, so only about 8% of them find   *
+     *      their tile in the cache at 1024x1024, and 2% at 4096x4096, and    *
+     *      the evictions cost more than the atomic adds they save.           *
+     **************************************************************************/
+    inline histogram_strategy
+    choose_strategy(std::size_t pixels, unsigned int threads,
+                    std::size_t budget)
+    {
+        const std::size_t bytes = pixels * sizeof(std::uint32_t);
+
+        if (threads <= 1U || bytes == 0U)
+            return strategy_private;
+
+        if (threads - 1U <= budget / bytes)
+            return strategy_private;
+
+        return strategy_shared;
+    }
+    /*  End of choose_strategy.                                               */
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      atomic_counter                                                    *
+     *  Purpose:                                                              *
+     *      Counts hits into a histogram shared between threads.              *
+     *  Notes:                                                                *
+     *      Relaxed ordering is enough, since nothing reads the counts until  *
+     *      the threads have been joined. The GCC builtins are used rather    *
+     *      than std::atomic so the histogram keeps its plain uint32 layout.  *
+     **************************************************************************/
+    struct atomic_counter {
+        std::uint32_t *counts;
+
+        explicit atomic_counter(std::uint32_t *data) : counts(data) {}
+
+        inline void add(std::size_t index)
+        {
+            __atomic_fetch_add(counts + index, 1U, __ATOMIC_RELAXED);
+        }
+
+        /*  Nothing is held back, for the same interface as cached_counter.   */
+        inline void flush(void) {}
+    };
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      cached_counter                                                    *
+     *  Purpose:                                                              *
+     *      Counts hits into a shared histogram through a small cache of hot  *
+     *      tiles, owned by one thread.                                       *
+     *  Notes:                                                                *
+     *      A tile is the 16 counts of one 64-byte cache line of the          *
+     *      histogram, which bf::histogram aligns to a cache line (see        *
+     *      allocate_counts). The cache has 2^slot_bits slots, each holding   *
+     *      one tile, picked by a hash of the tile number. A hit on a cached  *
+     *      tile is an ordinary add. When another tile needs the slot, the    *
+     *      counts that were hit are added to the histogram atomically, in    *
+     *      one batch, so threads hand the line back and forth less often.    *
+     *      The cache is about 38 KiB, the size of an L1 data cache.          *
+     *      flush must be called before the counts are read.                  *
+     **************************************************************************/
+    struct cached_counter {
+
+        /*  Counts per tile, and the cache has 2^slot_bits tiles.             */
+        static const std::size_t tile_size = 16U;
+        static const unsigned int slot_bits = 9U;
+        static const std::size_t tiles =
+            static_cast<std::size_t>(1U) << slot_bits;
+
+        /*  The shared histogram.                                             */
+        std::uint32_t *counts;
+
+        /*  Tile number plus one for each slot, zero for an empty slot.       */
+        std::vector<std::size_t> tags;
+
+        /*  Bit n is set if count n of the slot's tile was hit.               */
+        std::vector<std::uint32_t> masks;
+
+        /*  The counts held back, tile_size per slot.                         */
+        std::vector<std::uint32_t> hits;
+
+        explicit cached_counter(std::uint32_t *data)
+            : counts(data), tags(tiles, 0U), masks(tiles, 0U),
+              hits(tiles * tile_size, 0U)
+        {
+            return;
+        }
+
+        inline void add(std::size_t index)
+        {
+            const std::size_t tile = index / tile_size;
+            const std::size_t offset = index % tile_size;
+
+            /*  Fibonacci hashing, so rows below each other do not collide.   */
+            const std::size_t slot = static_cast<std::size_t>(
+                (static_cast<std::uint64_t>(tile) * 0x9E3779B97F4A7C15U) >>
+                (64U - slot_bits)
+            );
+
+            if (tags[slot] != tile + 1U)
+            {
+                evict(slot);
+                tags[slot] = tile + 1U;
+            }
+
+            ++hits[slot * tile_size + offset];
+            masks[slot] |= 1U << offset;
+        }
+
+        /*  Adds the counts of a slot to the histogram and empties it.        */
+        inline void evict(std::size_t slot)
+        {
+            std::uint32_t * const held = &hits[slot * tile_size];
+            std::uint32_t mask = masks[slot];
+            std::size_t first;
+
+            if (mask == 0U)
+                return;
+
+            first = (tags[slot] - 1U) * tile_size;
+
+            /*  Only the counts that were hit, lowest bit first.              */
+            while (mask)
+            {
+                const unsigned int n = static_cast<unsigned int>(
+                    __builtin_ctz(mask)
+                );
+
+                __atomic_fetch_add(counts + first + n, held[n],
+                                   __ATOMIC_RELAXED);
+                held[n] = 0U;
+                mask &= mask - 1U;
+            }
+
+            masks[slot] = 0U;
+            tags[slot] = 0U;
+        }
+
+        /*  Writes every held count to the histogram.                         */
+        inline void flush(void)
+        {
+            std::size_t slot;
+
+            for (slot = 0U; slot < tiles; ++slot)
+                evict(slot);
+        }
+    };
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,411 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Sparse histograms, square tiles of counts allocated on the first hit, *
+ *      and a tone mapper that fills the empty tiles in bulk.                 *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_SPARSE_HPP
+#define BF_SPARSE_HPP
+
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::uint32_t and std::uint64_t.               */
+#include <cstdint>
+
+/*  std::fwrite, std::ferror, and std::printf found here.                     */
+#include <cstdio>
+
+/*  std::calloc and std::free, for the tiles.                                 */
+#include <cstdlib>
+
+/*  std::memcpy, for filling empty tiles with the background.                 */
+#include <cstring>
+
+/*  std::vector, for the tile directory and the rows of a band.               */
+#include <vector>
+
+/*  Basic color struct, the tone mapper returns these.                        */
+#include "bf_color.hpp"
+
+/*  Affine maps and iterated function systems.                                */
+#include "bf_ifs.hpp"
+
+/*  Threading helpers, tiles are colored in parallel.                         */
+#include "bf_parallel.hpp"
+
+/*  PPM struct, the image is written to it a band at a time.                  */
+#include "bf_ppm.hpp"
+
+/*  View struct, the image size and the point-to-pixel conversion.            */
+#include "bf_view.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Tiles are 2^sparse_tile_bits pixels on a side, 16 KiB of counts.      */
+    static const unsigned int sparse_tile_bits = 6U;
+    static const unsigned int sparse_tile_size = 1U << sparse_tile_bits;
+    static const std::size_t sparse_tile_pixels =
+        static_cast<std::size_t>(sparse_tile_size) * sparse_tile_size;
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      sparse_histogram                                                  *
+     *  Purpose:                                                              *
+     *      Hit counts stored as square tiles, each allocated the first time  *
+     *      a point lands in it.                                              *
+     *  Notes:                                                                *
+     *      The fern covers a small part of its bounding rectangle, and a     *
+     *      dense histogram pays for all of it. Here the memory grows with    *
+     *      the area of the attractor instead: a directory of one pointer     *
+     *      per tile, NULL for a tile with no hits, plus 16 KiB for every     *
+     *      tile that was hit. Within a tile the counts are stored by rows.   *
+     **************************************************************************/
+    struct sparse_histogram {
+
+        /*  The image size and the map from the plane to the pixels.          */
+        view v;
+
+        /*  The number of tiles in each direction, partial ones included.     */
+        unsigned int tiles_x, tiles_y;
+
+        /*  One entry per tile, by rows of tiles. NULL if never hit.          */
+        std::vector<std::uint32_t *> directory;
+
+        /*  The number of tiles allocated.                                    */
+        std::size_t tiles_used;
+
+        /*  True if a tile could not be allocated and hits were lost.         */
+        bool failed;
+
+        /*  Constructor from a view. No tiles are allocated.                  */
+        explicit sparse_histogram(const view &new_view = view());
+
+        /*  Destructor, frees every tile.                                     */
+        ~sparse_histogram(void);
+
+        /*  Frees every tile and starts over with a new view.                 */
+        inline void reset(const view &new_view);
+
+        /*  Frees every tile, keeping the view.                               */
+        inline void release(void);
+
+        /*  Adds a hit to the pixel (col, row), allocating its tile.          */
+        inline void add(unsigned int col, unsigned int row);
+
+        /*  Runs the chaos game, as create_fern does for dense counts.        */
+        template <typename Trng>
+        inline void
+        render(const ifs &fern, std::uint64_t iterations,
+               double &x_pt, double &y_pt, Trng &gen);
+
+        /*  Bytes used by the directory and the tiles.                        */
+        inline std::size_t bytes(void) const;
+
+    private:
+
+        /*  Copying would free the tiles twice.                               */
+        sparse_histogram(const sparse_histogram &);
+        sparse_histogram &operator = (const sparse_histogram &);
+    };
+
+    /*  Constructor from a view. Every tile starts out unallocated.           */
+    inline sparse_histogram::sparse_histogram(const view &new_view)
+    {
+        tiles_used = 0U;
+        reset(new_view);
+    }
+
+    /*  Destructor, the tiles were allocated with calloc.                     */
+    inline sparse_histogram::~sparse_histogram(void)
+    {
+        release();
+    }
+
+    /*  The directory is sized for the new view, with every entry NULL.       */
+    inline void sparse_histogram::reset(const view &new_view)
+    {
+        release();
+        v = new_view;
+        tiles_x = (v.xsize + sparse_tile_size - 1U) >> sparse_tile_bits;
+        tiles_y = (v.ysize + sparse_tile_size - 1U) >> sparse_tile_bits;
+        directory.assign(static_cast<std::size_t>(tiles_x) * tiles_y, NULL);
+    }
+
+    /*  Frees the tiles, leaving every entry of the directory NULL.           */
+    inline void sparse_histogram::release(void)
+    {
+        std::size_t n;
+
+        for (n = 0U; n < directory.size(); ++n)
+        {
+            std::free(directory[n]);
+            directory[n] = NULL;
+        }
+
+        tiles_used = 0U;
+        failed = false;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      add                                                               *
+     *  Purpose:                                                              *
+     *      Adds one hit to a pixel.                                          *
+     *  Arguments:                                                            *
+     *      col (unsigned int):                                               *
+     *          The column of the pixel, less than v.xsize.                   *
+     *      row (unsigned int):                                               *
+     *          The row of the pixel, less than v.ysize.                      *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Notes:                                                                *
+     *      The tile and the place in it come from shifts and masks, so there *
+     *      is no division. If the tile cannot be allocated the hit is lost   *
+     *      and failed is set.                                                *
+     **************************************************************************/
+    inline void sparse_histogram::add(unsigned int col, unsigned int row)
+    {
+        const unsigned int mask = sparse_tile_size - 1U;
+        const std::size_t tile =
+            static_cast<std::size_t>(row >> sparse_tile_bits) * tiles_x +
+            (col >> sparse_tile_bits);
+        const std::size_t offset = ((row & mask) << sparse_tile_bits) |
+                                   (col & mask);
+        std::uint32_t *counts = directory[tile];
+
+        if (!counts)
+        {
+            counts = static_cast<std::uint32_t *>(
+                std::calloc(sparse_tile_pixels, sizeof(*counts))
+            );
+
+            if (!counts)
+            {
+                failed = true;
+                return;
+            }
+
+            directory[tile] = counts;
+            ++tiles_used;
+        }
+
+        ++counts[offset];
+    }
+    /*  End of add.                                                           */
+
+    /*  Same loop as create_fern, with the pixel as a column and a row.       */
+    template <typename Trng>
+    inline void
+    sparse_histogram::render(const ifs &fern, std::uint64_t iterations,
+                             double &x_pt, double &y_pt, Trng &gen)
+    {
+        double x_val = x_pt;
+        double y_val = y_pt;
+        unsigned int col, row;
+        std::uint64_t n;
+
+        for (n = 0U; n < iterations; ++n)
+        {
+            fern.transform[fern.select(gen.percent())].transform(x_val, y_val);
+
+            if (v.point_to_cell(x_val, y_val, col, row))
+                add(col, row);
+        }
+
+        x_pt = x_val;
+        y_pt = y_val;
+    }
+
+    /*  The directory is counted too, it is small but not free.               */
+    inline std::size_t sparse_histogram::bytes(void) const
+    {
+        return directory.size() * sizeof(directory[0]) +
+               tiles_used * sparse_tile_pixels * sizeof(std::uint32_t);
+    }
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      tone_map_band                                                     *
+     *  Purpose:                                                              *
+     *      Colors one row of tiles of a sparse histogram.                    *
+     *  Arguments:                                                            *
+     *      color (Tcolorer):                                                 *
+     *          The colorer, like bf::colorer::grayscale.                     *
+     *      hist (const bf::sparse_histogram &):                              *
+     *          The histogram.                                                *
+     *      band (unsigned int):                                              *
+     *          The row of tiles, less than hist.tiles_y.                     *
+     *      rgb (unsigned char *):                                            *
+     *          Output, room for 3 * xsize * sparse_tile_size bytes. Row r of *
+     *          the band is image row band * sparse_tile_size + r.            *
+     *      scale_factor (double):                                            *
+     *          Scale factor for the intensity, as for bf::tone_map.          *
+     *      threads (unsigned int):                                           *
+     *          The maximum number of threads. Zero uses all of them.         *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Method:                                                               *
+     *      The tiles of the band are colored in parallel. A tile with no     *
+     *      hits is all background, color(1.0), which is white for            *
+     *      greenscale. It is computed once and copied in, a row of the tile  *
+     *      at a time, without calling the colorer or reading any counts.     *
+     *      Hit tiles use the formula of bf::tone_map, so the image is the    *
+     *      same as for the dense histogram.                                  *
+     **************************************************************************/
+    template <typename Tcolorer>
+    inline void
+    tone_map_band(Tcolorer color, const sparse_histogram &hist,
+                  unsigned int band, unsigned char *rgb,
+                  double scale_factor = 1.0 / 256.0, unsigned int threads = 0U)
+    {
+        const unsigned int width = hist.v.xsize;
+        const unsigned int rows =
+            (band + 1U == hist.tiles_y ?
+             hist.v.ysize - band * sparse_tile_size : sparse_tile_size);
+        const bf::color background = color(1.0);
+        unsigned char fill[3U * sparse_tile_size];
+        unsigned int n;
+
+        for (n = 0U; n < sparse_tile_size; ++n)
+        {
+            fill[3U*n] = background.red;
+            fill[3U*n + 1U] = background.green;
+            fill[3U*n + 2U] = background.blue;
+        }
+
+        parallel::for_each(hist.tiles_x, [&](unsigned int tile_x)
+        {
+            const std::uint32_t * const counts =
+                hist.directory[static_cast<std::size_t>(band) * hist.tiles_x +
+                               tile_x];
+            const unsigned int first = tile_x * sparse_tile_size;
+            const unsigned int cols =
+                (tile_x + 1U == hist.tiles_x ?
+                 width - first : sparse_tile_size);
+            unsigned int row, col;
+
+            for (row = 0U; row < rows; ++row)
+            {
+                unsigned char * const out =
+                    rgb + 3U * (static_cast<std::size_t>(row) * width + first);
+
+                if (!counts)
+                {
+                    std::memcpy(out, fill, 3U * cols);
+                    continue;
+                }
+
+                for (col = 0U; col < cols; ++col)
+                {
+                    const std::uint32_t count =
+                        counts[(row << sparse_tile_bits) | col];
+                    const double val = 1.0 - scale_factor*count;
+                    const bf::color c = color(val);
+
+                    out[3U*col] = c.red;
+                    out[3U*col + 1U] = c.green;
+                    out[3U*col + 2U] = c.blue;
+                }
+            }
+        }, threads);
+    }
+    /*  End of tone_map_band.                                                 */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      write_sparse                                                      *
+     *  Purpose:                                                              *
+     *      Colors a sparse histogram and writes it to a PPM file.            *
+     *  Arguments:                                                            *
+     *      color (Tcolorer):                                                 *
+     *          The colorer, like bf::colorer::grayscale.                     *
+     *      hist (const bf::sparse_histogram &):                              *
+     *          The histogram.                                                *
+     *      name (const char *):                                              *
+     *          The name of the PPM file.                                     *
+     *      scale_factor (double):                                            *
+     *          Scale factor for the intensity, as for bf::tone_map.          *
+     *      threads (unsigned int):                                           *
+     *          The maximum number of threads. Zero uses all of them.         *
+     *  Outputs:                                                              *
+     *      success (bool):                                                   *
+     *          False if the file could not be written.                       *
+     *  Notes:                                                                *
+     *      The image is colored and written one band of tiles at a time,     *
+     *      so only one band of RGB is ever in memory, not the whole image.   *
+     **************************************************************************/
+    template <typename Tcolorer>
+    inline bool
+    write_sparse(Tcolorer color, const sparse_histogram &hist,
+                 const char *name, double scale_factor = 1.0 / 256.0,
+                 unsigned int threads = 0U)
+    {
+        const std::size_t band_pixels =
+            static_cast<std::size_t>(hist.v.xsize) * sparse_tile_size;
+        std::vector<unsigned char> rgb(3U * band_pixels);
+        struct ppm PPM = ppm(name);
+        bool success = true;
+        unsigned int band;
+
+        /*  The constructor has already printed an error.                     */
+        if (!PPM.fp)
+            return false;
+
+        PPM.init(hist.v.xsize, hist.v.ysize, 6);
+
+        for (band = 0U; band < hist.tiles_y; ++band)
+        {
+            const unsigned int rows =
+                (band + 1U == hist.tiles_y ?
+                 hist.v.ysize - band * sparse_tile_size : sparse_tile_size);
+            const std::size_t pixels =
+                static_cast<std::size_t>(hist.v.xsize) * rows;
+
+            tone_map_band(color, hist, band, &rgb[0], scale_factor, threads);
+
+            if (std::fwrite(&rgb[0], 3U, pixels, PPM.fp) != pixels)
+            {
+                success = false;
+                break;
+            }
+        }
+
+        if (std::ferror(PPM.fp))
+            success = false;
+
+        success = PPM.close() && success;
+
+        if (!success)
+            std::printf("ERROR: could not write %s.\n", name);
+
+        return success;
+    }
+    /*  End of write_sparse.                                                  */
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,306 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Provides opt-in instrumentation for renders: timings for each         *
+ *      phase, how often each map was chosen, points that missed the          *
+ *      image, histogram occupancy, and peak memory, as JSON or logfmt.       *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_STATS_HPP
+#define BF_STATS_HPP
+
+/*  std::size_t given here.                                                   */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::uint32_t and std::uint64_t.               */
+#include <cstdint>
+
+/*  FILE data type and std::fprintf found here.                               */
+#include <cstdio>
+
+/*  std::memset found here.                                                   */
+#include <cstring>
+
+/*  std::chrono::steady_clock, used for timing the phases.                    */
+#include <chrono>
+
+/*  getrusage, for the peak memory use of the process.                        */
+#include <sys/resource.h>
+
+/*  Affine maps and iterated function systems, for max_maps.                  */
+#include "bf_ifs.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Probe for create_fern that counts map choices and missed points.      */
+    struct map_probe {
+
+        /*  Number of times each map was chosen.                              */
+        std::uint64_t selections[max_maps];
+
+        /*  Number of points that fell off of the image.                      */
+        std::uint64_t rejections;
+
+        /*  Empty constructor, all counts zero.                               */
+        map_probe(void) : rejections(0U)
+        {
+            std::memset(selections, 0, sizeof(selections));
+        }
+
+        inline void selected(unsigned int map)
+        {
+            ++selections[map];
+        }
+
+        inline void rejected(void)
+        {
+            ++rejections;
+        }
+    };
+
+    /*  Measures the time since it was created or last restarted.             */
+    struct stopwatch {
+        std::chrono::steady_clock::time_point start;
+
+        stopwatch(void) : start(std::chrono::steady_clock::now())
+        {
+            return;
+        }
+
+        /*  Returns the seconds since the start, and starts over.             */
+        inline double lap(void)
+        {
+            const std::chrono::steady_clock::time_point now =
+                std::chrono::steady_clock::now();
+
+            const double seconds =
+                std::chrono::duration<double>(now - start).count();
+
+            start = now;
+            return seconds;
+        }
+    };
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      peak_memory                                                       *
+     *  Purpose:                                                              *
+     *      Returns the largest resident set size of the process so far.      *
+     *  Arguments:                                                            *
+     *      None (void).                                                      *
+     *  Outputs:                                                              *
+     *      bytes (std::uint64_t):                                            *
+     *          The peak memory use in bytes, or zero if unknown.             *
+     *  Notes:                                                                *
+     *      Linux reports ru_maxrss in kilobytes, macOS in bytes.             *
+     **************************************************************************/
+    inline std::uint64_t peak_memory(void)
+    {
+        struct rusage usage;
+
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0U;
+
+#if defined(__APPLE__)
+        return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+        return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024U;
+#endif
+    }
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      render_stats                                                      *
+     *  Purpose:                                                              *
+     *      Everything measured during an instrumented render.                *
+     *  Notes:                                                                *
+     *      Only the functions that take one of these do any measuring. The   *
+     *      plain versions are untouched, so there is no cost unless asked.   *
+     **************************************************************************/
+    struct render_stats {
+
+        /*  Number of points computed, and the number of maps in the IFS.     */
+        std::uint64_t iterations;
+        unsigned int number_of_maps;
+
+        /*  Time, in seconds, for each phase of the render.                   */
+        double alloc_time, chaos_time, tone_map_time, write_time;
+
+        /*  Map choices and points that missed the image.                     */
+        map_probe probe;
+
+        /*  Pixels with at least one hit, the number of pixels, and the most  *
+         *  hits on any one pixel.                                            */
+        std::uint64_t occupied, pixels, max_count;
+
+        /*  Peak resident memory in bytes, measured at the end.               */
+        std::uint64_t peak_memory;
+
+        /*  Empty constructor, everything zero.                               */
+        render_stats(void);
+
+        /*  Total time of all phases.                                         */
+        inline double total_time(void) const;
+
+        /*  Speed of the chaos game.                                          */
+        inline double iterations_per_second(void) const;
+
+        /*  Records occupancy and the largest count of a histogram.           */
+        inline void count_pixels(const std::uint32_t *counts, std::size_t n);
+
+        /*  Writes the statistics as a JSON object.                           */
+        inline void write_json(std::FILE *fp) const;
+
+        /*  Writes the statistics as one logfmt line, key=value pairs.        */
+        inline void write_logfmt(std::FILE *fp) const;
+    };
+
+    /*  Empty constructor.                                                    */
+    inline render_stats::render_stats(void)
+        : iterations(0U), number_of_maps(0U), alloc_time(0.0),
+          chaos_time(0.0), tone_map_time(0.0), write_time(0.0), probe(),
+          occupied(0U), pixels(0U), max_count(0U), peak_memory(0U)
+    {
+        return;
+    }
+
+    /*  Sum of the phases.                                                    */
+    inline double render_stats::total_time(void) const
+    {
+        return alloc_time + chaos_time + tone_map_time + write_time;
+    }
+
+    /*  Zero if nothing was timed, rather than dividing by zero.              */
+    inline double render_stats::iterations_per_second(void) const
+    {
+        if (chaos_time <= 0.0)
+            return 0.0;
+
+        return static_cast<double>(iterations) / chaos_time;
+    }
+
+    /*  One pass over the counts.                                             */
+    inline void
+    render_stats::count_pixels(const std::uint32_t *counts, std::size_t n)
+    {
+        std::size_t index;
+
+        pixels = n;
+        occupied = 0U;
+        max_count = 0U;
+
+        for (index = 0U; index < n; ++index)
+        {
+            occupied += (counts[index] != 0U);
+
+            if (counts[index] > max_count)
+                max_count = counts[index];
+        }
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      write_json                                                        *
+     *  Purpose:                                                              *
+     *      Writes the statistics as a JSON object followed by a new line.    *
+     *  Arguments:                                                            *
+     *      fp (std::FILE *):                                                 *
+     *          The file to write to.                                         *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     **************************************************************************/
+    inline void render_stats::write_json(std::FILE *fp) const
+    {
+        unsigned int n;
+
+        std::fprintf(fp, "{\"iterations\": %llu, ",
+                     static_cast<unsigned long long>(iterations));
+        std::fprintf(fp, "\"iterations_per_second\": %.6g, ",
+                     iterations_per_second());
+        std::fprintf(fp, "\"seconds\": {\"alloc\": %.6g, \"chaos\": %.6g, "
+                         "\"tone_map\": %.6g, \"write\": %.6g, "
+                         "\"total\": %.6g}, ",
+                     alloc_time, chaos_time, tone_map_time, write_time,
+                     total_time());
+        std::fprintf(fp, "\"map_selections\": [");
+
+        for (n = 0U; n < number_of_maps; ++n)
+            std::fprintf(fp, "%s%llu", (n == 0U ? "" : ", "),
+                         static_cast<unsigned long long>(
+                             probe.selections[n]
+                         ));
+
+        std::fprintf(fp, "], \"out_of_bounds\": %llu, ",
+                     static_cast<unsigned long long>(probe.rejections));
+        std::fprintf(fp, "\"pixels\": %llu, \"occupied\": %llu, "
+                         "\"max_count\": %llu, \"peak_memory\": %llu}\n",
+                     static_cast<unsigned long long>(pixels),
+                     static_cast<unsigned long long>(occupied),
+                     static_cast<unsigned long long>(max_count),
+                     static_cast<unsigned long long>(peak_memory));
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      write_logfmt                                                      *
+     *  Purpose:                                                              *
+     *      Writes the statistics as a single logfmt line, the format many    *
+     *      log collectors parse, like "iterations=67108864 chaos_s=0.41".    *
+     *  Arguments:                                                            *
+     *      fp (std::FILE *):                                                 *
+     *          The file to write to.                                         *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     **************************************************************************/
+    inline void render_stats::write_logfmt(std::FILE *fp) const
+    {
+        unsigned int n;
+
+        std::fprintf(fp, "iterations=%llu iterations_per_second=%.6g ",
+                     static_cast<unsigned long long>(iterations),
+                     iterations_per_second());
+        std::fprintf(fp, "alloc_s=%.6g chaos_s=%.6g tone_map_s=%.6g "
+                         "write_s=%.6g total_s=%.6g ",
+                     alloc_time, chaos_time, tone_map_time, write_time,
+                     total_time());
+
+        for (n = 0U; n < number_of_maps; ++n)
+            std::fprintf(fp, "map%u=%llu ", n,
+                         static_cast<unsigned long long>(
+                             probe.selections[n]
+                         ));
+
+        std::fprintf(fp, "out_of_bounds=%llu pixels=%llu occupied=%llu "
+                         "max_count=%llu peak_memory=%llu\n",
+                     static_cast<unsigned long long>(probe.rejections),
+                     static_cast<unsigned long long>(pixels),
+                     static_cast<unsigned long long>(occupied),
+                     static_cast<unsigned long long>(max_count),
+                     static_cast<unsigned long long>(peak_memory));
+    }
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
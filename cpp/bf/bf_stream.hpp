@@ -0,0 +1,418 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Provides a struct for streaming frames to a pipe or file descriptor.  *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/* Include guard to prevent including this file twice.                        */
+#ifndef BF_STREAM_HPP
+#define BF_STREAM_HPP
+
+/*  std::snprintf and std::puts found here.                                   */
+#include <cstdio>
+
+/*  std::copy, used for writing the headers into the buffers.                 */
+#include <algorithm>
+
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
+/*  errno and EINTR, for retrying interrupted writes.                         */
+#include <cerrno>
+
+/*  Mutex and condition variable for handing frames to the writer thread.     */
+#include <condition_variable>
+#include <mutex>
+
+/*  std::thread, the frames are written on a background thread.               */
+#include <thread>
+
+/*  std::vector, used for the frame buffers.                                  */
+#include <vector>
+
+/*  POSIX write and fcntl. F_SETPIPE_SZ is Linux specific.                    */
+#include <fcntl.h>
+#include <unistd.h>
+
+/*  Basic constants for the setup of the experiments given here.              */
+#include "bf_setup.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Struct for writing a sequence of frames to a file descriptor.         */
+    struct stream {
+
+        /*  Frames are either bare RGB bytes, or each one is a full PPM.      */
+        enum format {
+            raw,
+            ppm
+        };
+
+        /*  Number of frame buffers. One is written while the next is drawn,  *
+         *  the third absorbs jitter between the two threads.                 */
+        static const unsigned int depth = 3U;
+
+        /*  The file descriptor being written to, 1 for stdout.               */
+        int fd;
+
+        /*  Size of the frames in pixels, and in bytes including the header.  */
+        unsigned int width, height;
+        std::size_t header_size, frame_size;
+
+        /*  The ring of frame buffers. Each one starts with the PPM header,   *
+         *  if any, so that a whole frame is sent with a single write call.   */
+        std::vector< std::vector<unsigned char> > buffers;
+
+        /*  Ring indices. Frames in [tail, tail + queued) wait to be written, *
+         *  "drawing" is true while the caller holds the buffer at "head".    */
+        unsigned int head, tail, queued;
+        bool drawing, closing, failed;
+
+        /*  Synchronization between the caller and the writer thread.         */
+        std::mutex lock;
+        std::condition_variable has_room, has_frame;
+        std::thread writer;
+
+        /*  Constructor from a file descriptor, frame size, and format.       */
+        stream(int descriptor, unsigned int x, unsigned int y, format type);
+
+        /*  Constructor using the values in "setup".                          */
+        stream(int descriptor, format type);
+
+        /*  Destructor, finishes writing any queued frames.                   */
+        ~stream(void);
+
+        /*  Returns a buffer for the next frame, waiting if all are in use.   */
+        inline unsigned char *acquire(void);
+
+        /*  Queues the buffer returned by acquire to be written.              */
+        inline void submit(void);
+
+        /*  Writes any remaining frames and stops the writer thread.          */
+        inline void close(void);
+
+        /*  Sets everything up, shared by the constructors.                   */
+        inline void init(int descriptor, unsigned int x, unsigned int y,
+                         format type);
+
+        /*  Enlarges the pipe buffer, if fd is a pipe, to hold a full frame.  */
+        inline void tune_pipe(void);
+
+        /*  Main loop for the writer thread.                                  */
+        inline void write_frames(void);
+    };
+
+    /**************************************************************************
+     *  Constructor:                                                          *
+     *      stream                                                            *
+     *  Purpose:                                                              *
+     *      Creates a frame stream writing to a file descriptor.              *
+     *  Arguments:                                                            *
+     *      descriptor (int):                                                 *
+     *          The file descriptor, usually 1 (stdout) or one end of a pipe. *
+     *      x (unsigned int):                                                 *
+     *          The number of pixels in the x axis.                           *
+     *      y (unsigned int):                                                 *
+     *          The number of pixels in the y axis.                           *
+     *      type (bf::stream::format):                                        *
+     *          Either bf::stream::raw or bf::stream::ppm.                    *
+     *  Outputs:                                                              *
+     *      s (bf::stream):                                                   *
+     *          A stream with its writer thread running.                      *
+     *  Notes:                                                                *
+     *      Raw frames suit encoders that are told the size up front, such    *
+     *      as "ffmpeg -f rawvideo -pix_fmt rgb24 -s 1024x1024 -i -". PPM     *
+     *      frames carry their own size, for "ffmpeg -f image2pipe -i -".     *
+     **************************************************************************/
+    stream::stream(int descriptor, unsigned int x, unsigned int y, format type)
+    {
+        init(descriptor, x, y, type);
+    }
+
+    /**************************************************************************
+     *  Constructor:                                                          *
+     *      stream                                                            *
+     *  Purpose:                                                              *
+     *      Creates a frame stream using the frame size in "setup".           *
+     *  Arguments:                                                            *
+     *      descriptor (int):                                                 *
+     *          The file descriptor, usually 1 (stdout) or one end of a pipe. *
+     *      type (bf::stream::format):                                        *
+     *          Either bf::stream::raw or bf::stream::ppm.                    *
+     *  Outputs:                                                              *
+     *      s (bf::stream):                                                   *
+     *          A stream with its writer thread running.                      *
+     **************************************************************************/
+    stream::stream(int descriptor, format type)
+    {
+        init(descriptor, setup::xsize, setup::ysize, type);
+    }
+
+    /*  Destructor, same as close. Calling close twice is harmless.           */
+    stream::~stream(void)
+    {
+        close();
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      init                                                              *
+     *  Purpose:                                                              *
+     *      Allocates the frame buffers, writes the PPM headers into them,    *
+     *      and starts the writer thread.                                     *
+     *  Arguments:                                                            *
+     *      Same as the constructor.                                          *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     **************************************************************************/
+    inline void
+    stream::init(int descriptor, unsigned int x, unsigned int y, format type)
+    {
+        /*  Long enough for "P6\n", two 10 digit numbers, and "255\n".        */
+        char header[32];
+        unsigned int n;
+
+        fd = descriptor;
+        width = x;
+        height = y;
+        head = tail = queued = 0U;
+        drawing = closing = failed = false;
+        header_size = 0U;
+
+        if (type == ppm)
+        {
+            const int size = std::snprintf(header, sizeof(header),
+                                           "P6\n%u %u\n255\n", x, y);
+            header_size = static_cast<std::size_t>(size);
+        }
+
+        frame_size = header_size + 3U * static_cast<std::size_t>(x) * y;
+        buffers.resize(depth);
+
+        /*  Every frame has the same header, so write it in once.             */
+        for (n = 0U; n < depth; ++n)
+        {
+            buffers[n].resize(frame_size);
+
+            if (header_size > 0U)
+                std::copy(header, header + header_size, buffers[n].begin());
+        }
+
+        tune_pipe();
+        writer = std::thread(&stream::write_frames, this);
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      tune_pipe                                                         *
+     *  Purpose:                                                              *
+     *      Grows the kernel pipe buffer so that a full frame fits in it.     *
+     *  Arguments:                                                            *
+     *      None (void).                                                      *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Method:                                                               *
+     *      The default pipe on Linux holds 64 KiB, so a 3 MB frame takes     *
+     *      dozens of round trips between the writer and the reader. Ask for  *
+     *      the frame size, falling back on the system limit found in         *
+     *      /proc/sys/fs/pipe-max-size. Errors are ignored, since fd may not  *
+     *      be a pipe at all, and this is only a speed-up.                    *
+     **************************************************************************/
+    inline void stream::tune_pipe(void)
+    {
+#ifdef F_SETPIPE_SZ
+        long request = static_cast<long>(frame_size);
+        long limit = 0L;
+        FILE * const fp = std::fopen("/proc/sys/fs/pipe-max-size", "r");
+
+        if (fp)
+        {
+            if (std::fscanf(fp, "%ld", &limit) != 1)
+                limit = 0L;
+
+            std::fclose(fp);
+        }
+
+        if (limit > 0L && request > limit)
+            request = limit;
+
+        /*  The kernel rounds this up to a power of two number of pages.      */
+        fcntl(fd, F_SETPIPE_SZ, static_cast<int>(request));
+#endif
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      acquire                                                           *
+     *  Purpose:                                                              *
+     *      Returns the buffer the next frame should be drawn into.           *
+     *  Arguments:                                                            *
+     *      None (void).                                                      *
+     *  Outputs:                                                              *
+     *      rgb (unsigned char *):                                            *
+     *          Room for width x height RGB pixels, rows top to bottom. NULL  *
+     *          if a previous write failed, for example if the reader closed  *
+     *          the pipe.                                                     *
+     *  Notes:                                                                *
+     *      This blocks while all of the buffers are waiting to be written.   *
+     *      That is the backpressure, a slow reader slows the renderer down   *
+     *      rather than frames piling up in memory.                           *
+     **************************************************************************/
+    inline unsigned char *stream::acquire(void)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+
+        /*  The buffer at "head" is free once fewer than "depth" are queued.  */
+        while (queued == depth && !failed)
+            has_room.wait(guard);
+
+        if (failed)
+            return NULL;
+
+        drawing = true;
+        return buffers[head].data() + header_size;
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      submit                                                            *
+     *  Purpose:                                                              *
+     *      Hands the frame obtained from acquire over to the writer thread.  *
+     *  Arguments:                                                            *
+     *      None (void).                                                      *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     **************************************************************************/
+    inline void stream::submit(void)
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+
+            if (!drawing)
+                return;
+
+            drawing = false;
+            head = (head + 1U) % depth;
+            ++queued;
+        }
+
+        has_frame.notify_one();
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      write_frames                                                      *
+     *  Purpose:                                                              *
+     *      Writer thread. Sends queued frames to fd in order until closed.   *
+     *  Arguments:                                                            *
+     *      None (void).                                                      *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Method:                                                               *
+     *      The lock is only held to update the ring indices, never during    *
+     *      the write itself, so the caller can draw the next frame at the    *
+     *      same time. write may send fewer bytes than asked, so loop.        *
+     *      Errors go to stderr since stdout is likely the stream itself. If  *
+     *      the reader goes away the process gets SIGPIPE, as any other       *
+     *      program in a pipeline would, unless the caller ignores it.        *
+     **************************************************************************/
+    inline void stream::write_frames(void)
+    {
+        for (;;)
+        {
+            const unsigned char *frame;
+            std::size_t left = frame_size;
+
+            {
+                std::unique_lock<std::mutex> guard(lock);
+
+                while (queued == 0U && !closing)
+                    has_frame.wait(guard);
+
+                if (queued == 0U)
+                    return;
+
+                frame = buffers[tail].data();
+            }
+
+            while (left > 0U && !failed)
+            {
+                const ssize_t sent = ::write(fd, frame, left);
+
+                /*  Interrupted by a signal, try again.                       */
+                if (sent < 0 && errno == EINTR)
+                    continue;
+
+                if (sent <= 0)
+                {
+                    std::lock_guard<std::mutex> guard(lock);
+                    std::fputs("ERROR: write failed. Stopping the stream.\n",
+                               stderr);
+                    failed = true;
+                    break;
+                }
+
+                frame += sent;
+                left -= static_cast<std::size_t>(sent);
+            }
+
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                tail = (tail + 1U) % depth;
+                --queued;
+            }
+
+            has_room.notify_one();
+        }
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      close                                                             *
+     *  Purpose:                                                              *
+     *      Waits for the queued frames to be written and stops the writer.   *
+     *  Arguments:                                                            *
+     *      None (void).                                                      *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Notes:                                                                *
+     *      The file descriptor is not closed, it belongs to the caller.      *
+     **************************************************************************/
+    inline void stream::close(void)
+    {
+        if (!writer.joinable())
+            return;
+
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            closing = true;
+        }
+
+        has_frame.notify_one();
+        writer.join();
+    }
+}
+/*  End of namespace bf.                                                      */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,358 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Histogram statistics and a log-density tone mapper, so that a single  *
+ *      render can be exposed in many different ways.                         *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_TONEMAP_HPP
+#define BF_TONEMAP_HPP
+
+/*  std::log1p, std::log2, std::pow, and std::exp2 are found here.            */
+#include <cmath>
+
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
+/*  Fixed-width integer types, std::uint32_t and std::uint64_t.               */
+#include <cstdint>
+
+/*  std::mutex, used to combine the per-thread statistics.                    */
+#include <mutex>
+
+/*  std::vector, used for the bins of the statistics.                         */
+#include <vector>
+
+/*  Basic color struct, the tone mapper returns these.                        */
+#include "bf_color.hpp"
+
+/*  Histograms of hit counts.                                                 */
+#include "bf_histogram.hpp"
+
+/*  Threading helpers, both passes run in parallel.                           */
+#include "bf_parallel.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  Number of bins per doubling of the count in the statistics.           */
+    static const unsigned int bins_per_octave = 16U;
+
+    /*  Largest table of colors the log-density tone mapper builds.           */
+    static const std::uint32_t table_limit = 1048576U;
+
+    /*  Counts are 32-bit, so this many bins covers all of them.              */
+    static const unsigned int number_of_bins = 32U * bins_per_octave + 1U;
+
+    /*  Summary of the distribution of counts in a histogram.                 */
+    struct statistics {
+
+        /*  Largest count, sum of the counts, and number of non-zero counts.  */
+        std::uint32_t max_count;
+        std::uint64_t total;
+        std::size_t occupied;
+
+        /*  How many non-zero counts fall in each logarithmic bin. Bin n      *
+         *  holds counts c with floor(bins_per_octave * log2(c)) = n.         */
+        std::vector<std::uint64_t> bins;
+
+        /*  Constructor, computes the statistics of a histogram.              */
+        statistics(const histogram &hist, unsigned int threads = 0U);
+
+        /*  The count below which a fraction p of the non-zero counts lie.    */
+        inline double percentile(double p) const;
+    };
+
+    /**************************************************************************
+     *  Constructor:                                                          *
+     *      statistics                                                        *
+     *  Purpose:                                                              *
+     *      Computes the statistics of a histogram in one parallel pass.      *
+     *  Arguments:                                                            *
+     *      hist (const bf::histogram &):                                     *
+     *          The histogram.                                                *
+     *      threads (unsigned int):                                           *
+     *          The maximum number of threads. Zero uses all of them.         *
+     *  Outputs:                                                              *
+     *      stats (bf::statistics):                                           *
+     *          The statistics.                                               *
+     *  Method:                                                               *
+     *      Each thread fills in its own copy for a band of rows, and these   *
+     *      are added up under a lock at the end of the band. Percentiles     *
+     *      come from logarithmic bins rather than sorting, which takes no    *
+     *      extra memory and is accurate to 1 / bins_per_octave of a stop.    *
+     **************************************************************************/
+    inline statistics::statistics(const histogram &hist, unsigned int threads)
+        : max_count(0U), total(0U), occupied(0U), bins(number_of_bins, 0U)
+    {
+        /*  Number of counts summarized at a time by one thread.              */
+        const std::size_t band = 262144U;
+        const std::size_t pixels = hist.number_of_pixels();
+        const unsigned int bands =
+            static_cast<unsigned int>((pixels + band - 1U) / band);
+
+        std::mutex lock;
+
+        if (!hist.counts)
+            return;
+
+        parallel::for_each(bands, [&](unsigned int n)
+        {
+            const std::size_t first = static_cast<std::size_t>(n) * band;
+            const std::size_t last = (first + band > pixels ?
+                                      pixels : first + band);
+            std::vector<std::uint64_t> local(number_of_bins, 0U);
+            std::uint32_t local_max = 0U;
+            std::uint64_t local_total = 0U;
+            std::size_t local_occupied = 0U, index;
+            unsigned int k;
+
+            for (index = first; index < last; ++index)
+            {
+                const std::uint32_t count = hist.counts[index];
+
+                if (count == 0U)
+                    continue;
+
+                local_total += count;
+                ++local_occupied;
+
+                if (count > local_max)
+                    local_max = count;
+
+                ++local[static_cast<unsigned int>(
+                    bins_per_octave * std::log2(static_cast<double>(count))
+                )];
+            }
+
+            std::lock_guard<std::mutex> guard(lock);
+
+            for (k = 0U; k < number_of_bins; ++k)
+                bins[k] += local[k];
+
+            total += local_total;
+            occupied += local_occupied;
+
+            if (local_max > max_count)
+                max_count = local_max;
+        }, threads);
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      percentile                                                        *
+     *  Purpose:                                                              *
+     *      Estimates the count below which a fraction of the occupied pixels *
+     *      lie. percentile(0.5) is the median hit count of the fern.         *
+     *  Arguments:                                                            *
+     *      p (double):                                                       *
+     *          The fraction, between 0 and 1.                                *
+     *  Outputs:                                                              *
+     *      count (double):                                                   *
+     *          The estimated count, zero for an empty histogram.             *
+     **************************************************************************/
+    inline double statistics::percentile(double p) const
+    {
+        const double target = p * static_cast<double>(occupied);
+        double seen = 0.0;
+        unsigned int n;
+
+        if (occupied == 0U)
+            return 0.0;
+
+        for (n = 0U; n < number_of_bins; ++n)
+        {
+            seen += static_cast<double>(bins[n]);
+
+            /*  Use the upper edge of the bin, but never more than the max.   */
+            if (seen >= target)
+            {
+                const double edge = std::exp2((n + 1.0) / bins_per_octave);
+                return (edge < max_count ? edge : max_count);
+            }
+        }
+
+        return max_count;
+    }
+
+    /**************************************************************************
+     *  Struct:                                                               *
+     *      log_density                                                       *
+     *  Purpose:                                                              *
+     *      Parameters for the log-density tone mapper.                       *
+     *  Notes:                                                                *
+     *      The linear scale 1 / 256 of bf::run saturates the stem and leaves *
+     *      the sparse tips of the leaves nearly invisible, and it depends on *
+     *      the number of iterations. Here intensity grows with the log of    *
+     *      the count, and the scale is set by the histogram itself.          *
+     **************************************************************************/
+    struct log_density {
+
+        /*  Exposure in stops. Each stop up doubles the apparent density.     */
+        double exposure;
+
+        /*  Display gamma applied after the log. Larger lifts faint areas.    *
+         *  The colorers raise their input to high powers, so values below 1  *
+         *  are needed to keep the dense regions from washing out.            */
+        double gamma;
+
+        /*  Fraction of the occupied pixels that are not clipped. The rest,   *
+         *  the densest part of the stem, saturate.                           */
+        double white_point;
+
+        /*  Empty constructor, neutral exposure with a gamma of 0.4.          */
+        log_density(void) : exposure(0.0), gamma(0.4), white_point(0.995)
+        {
+            return;
+        }
+    };
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      tone_map                                                          *
+     *  Purpose:                                                              *
+     *      Colors a histogram with the log-density tone mapper.              *
+     *  Arguments:                                                            *
+     *      color (Tcolorer):                                                 *
+     *          The colorer, like bf::colorer::grayscale.                     *
+     *      hist (const bf::histogram &):                                     *
+     *          The histogram.                                                *
+     *      rgb (unsigned char *):                                            *
+     *          Output, room for 3 * xsize * ysize bytes.                     *
+     *      params (const bf::log_density &):                                 *
+     *          Exposure, gamma, and white point.                             *
+     *      threads (unsigned int):                                           *
+     *          The maximum number of threads. Zero uses all of them.         *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Method:                                                               *
+     *      Let w be the white point count, divided by 2^exposure. A count c  *
+     *      has intensity (log(1 + c) / log(1 + w))^(1 / gamma), clipped to   *
+     *      1. The colorers expect 1 for the background and 0 or less for     *
+     *      the densest points, so they are passed 1 minus the intensity.     *
+     *      The intensity only depends on the count, so it is computed once   *
+     *      for every count up to w and then looked up.                       *
+     **************************************************************************/
+    template <typename Tcolorer>
+    inline void
+    tone_map(Tcolorer color, const histogram &hist, unsigned char *rgb,
+             const log_density &params, unsigned int threads = 0U)
+    {
+        const statistics stats(hist, threads);
+        const double white = stats.percentile(params.white_point) *
+                             std::exp2(-params.exposure);
+        const double norm = 1.0 / std::log1p(white > 0.0 ? white : 1.0);
+        const double inverse_gamma = 1.0 / params.gamma;
+
+        /*  Counts at or above the white point all saturate. The table does   *
+         *  not need to go past this, or past table_limit to save memory.     */
+        const double saturated =
+            std::ceil(white < stats.max_count ? white : stats.max_count);
+        const std::uint32_t entries = (saturated < table_limit ?
+            static_cast<std::uint32_t>(saturated) : table_limit);
+
+        const std::size_t pixels = hist.number_of_pixels();
+        const std::size_t band = 65536U;
+        const unsigned int bands =
+            static_cast<unsigned int>((pixels + band - 1U) / band);
+
+        std::vector<bf::color> table(entries + 1U);
+        std::uint32_t n;
+
+        /*  The color for a single count.                                     */
+        auto shade = [&](std::uint32_t count)
+        {
+            const double level = std::log1p(static_cast<double>(count)) * norm;
+            const double intensity = (level < 1.0 ? level : 1.0);
+            return color(1.0 - std::pow(intensity, inverse_gamma));
+        };
+
+        /*  The lookup table of colors, by count.                             */
+        for (n = 0U; n <= entries; ++n)
+            table[n] = shade(n);
+
+        parallel::for_each(bands, [&](unsigned int k)
+        {
+            const std::size_t first = static_cast<std::size_t>(k) * band;
+            const std::size_t last = (first + band > pixels ?
+                                      pixels : first + band);
+            std::size_t index;
+
+            for (index = first; index < last; ++index)
+            {
+                const std::uint32_t count = hist.counts[index];
+                const bf::color c = (count <= entries ?
+                                     table[count] : shade(count));
+
+                rgb[3U*index] = c.red;
+                rgb[3U*index + 1U] = c.green;
+                rgb[3U*index + 2U] = c.blue;
+            }
+        }, threads);
+    }
+    /*  End of tone_map.                                                      */
+
+    /**************************************************************************
+     *  Function:                                                             *
+     *      density                                                           *
+     *  Purpose:                                                              *
+     *      Converts the counts to floating point densities, normalized so    *
+     *      the values do not depend on the number of iterations.             *
+     *  Arguments:                                                            *
+     *      hist (const bf::histogram &):                                     *
+     *          The histogram.                                                *
+     *      out (float *):                                                    *
+     *          Output, room for xsize * ysize floats.                        *
+     *  Outputs:                                                              *
+     *      None (void).                                                      *
+     *  Notes:                                                                *
+     *      The density is count * pixels / iterations, so a value of 1 is    *
+     *      the average over the image. This is meant for writing PFM files   *
+     *      to be graded in other tools, where it keeps the full range.       *
+     **************************************************************************/
+    inline void density(const histogram &hist, float *out)
+    {
+        const std::size_t pixels = hist.number_of_pixels();
+        const std::size_t band = 65536U;
+        const unsigned int bands =
+            static_cast<unsigned int>((pixels + band - 1U) / band);
+        const double scale = (hist.header.iterations == 0U ? 0.0 :
+            static_cast<double>(pixels) /
+            static_cast<double>(hist.header.iterations));
+
+        parallel::for_each(bands, [&](unsigned int k)
+        {
+            const std::size_t first = static_cast<std::size_t>(k) * band;
+            const std::size_t last = (first + band > pixels ?
+                                      pixels : first + band);
+            std::size_t index;
+
+            for (index = first; index < last; ++index)
+                out[index] = static_cast<float>(scale * hist.counts[index]);
+        });
+    }
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */
@@ -0,0 +1,171 @@
+/******************************************************************************
+ *                                  LICENSE                                   *
+ ******************************************************************************
+ *  This file is part of barnsley_fern.                                       *
+ *                                                                            *
+ *  barnsley_fern is free software: you can redistribute it and/or modify     *
+ *  it under the terms of the GNU General Public License as published by      *
+ *  the Free Software Foundation, either version 3 of the License, or         *
+ *  (at your option) any later version.                                       *
+ *                                                                            *
+ *  barnsley_fern is distributed in the hope that it will be useful,          *
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of            *
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the             *
+ *  GNU General Public License for more details.                              *
+ *                                                                            *
+ *  You should have received a copy of the GNU General Public License         *
+ *  along with barnsley_fern.  If not, see <https://www.gnu.org/licenses/>.   *
+ ******************************************************************************
+ *  Purpose:                                                                  *
+ *      Provides a struct for the window in the plane that is drawn, and the  *
+ *      conversion from points in the plane to pixels.                        *
+ ******************************************************************************
+ *  Author: Ryan Maguire                                                      *
+ *  Date:   2026/10/18                                                        *
+ ******************************************************************************/
+
+/*  Include guard to prevent including this file twice.                       */
+#ifndef BF_VIEW_HPP
+#define BF_VIEW_HPP
+
+/*  std::size_t is found here.                                                */
+#include <cstddef>
+
+/*  Default image size and scale factors are found here.                      */
+#include "bf_setup.hpp"
+
+/*  Namespace for the mini-project. "Barnsley Fractal."                       */
+namespace bf {
+
+    /*  The image size and the map from the plane to the pixels.              */
+    struct view {
+
+        /*  Number of pixels in the x and y axes.                             */
+        unsigned int xsize, ysize;
+
+        /*  Scale and shift factors, pixel = shift + scale * point.           */
+        double xscale, yscale, xshift, yshift;
+
+        /*  Empty constructor, uses the values in "setup".                    */
+        view(void);
+
+        /*  Constructor from an image size, same framing as "setup".          */
+        view(unsigned int x, unsigned int y);
+
+        /*  The total number of pixels in the image.                          */
+        inline std::size_t number_of_pixels(void) const;
+
+        /*  Converts a point to a pixel index, false if off the image.        */
+        inline bool
+        point_to_pixel(double xpt, double ypt, std::size_t &index) const;
+
+        /*  Converts a point to a column and row, false if off the image.     */
+        inline bool
+        point_to_cell(double xpt, double ypt,
+                      unsigned int &col, unsigned int &row) const;
+    };
+
+    /*  Empty constructor, the same view that bf::run draws.                  */
+    inline view::view(void)
+    {
+        xsize = setup::xsize;
+        ysize = setup::ysize;
+        xscale = setup::xscale;
+        yscale = setup::yscale;
+        xshift = setup::xshift;
+        yshift = setup::yshift;
+    }
+
+    /**************************************************************************
+     *  Constructor:                                                          *
+     *      view                                                              *
+     *  Purpose:                                                              *
+     *      Creates a view of the given size framing the same region of the   *
+     *      plane as the values in "setup".                                   *
+     *  Arguments:                                                            *
+     *      x (unsigned int):                                                 *
+     *          The number of pixels in the x axis.                           *
+     *      y (unsigned int):                                                 *
+     *          The number of pixels in the y axis.                           *
+     *  Outputs:                                                              *
+     *      v (bf::view):                                                     *
+     *          The view.                                                     *
+     **************************************************************************/
+    inline view::view(unsigned int x, unsigned int y)
+    {
+        xsize = x;
+        ysize = y;
+        xscale = +0.195*static_cast<double>(x);
+        yscale = -0.090*static_cast<double>(y);
+        xshift = +0.450*static_cast<double>(x);
+        yshift = +1.000*static_cast<double>(y);
+    }
+
+    /*  The total number of pixels, as a size_t since large images overflow.  */
+    inline std::size_t view::number_of_pixels(void) const
+    {
+        return static_cast<std::size_t>(xsize) *
+               static_cast<std::size_t>(ysize);
+    }
+
+    /**************************************************************************
+     *  Method:                                                               *
+     *      point_to_pixel                                                    *
+     *  Purpose:                                                              *
+     *      Converts a point in the plane to the corresponding pixel.         *
+     *  Arguments:                                                            *
+     *      xpt (double):                                                     *
+     *          The x-coordinate of the input point.                          *
+     *      ypt (double):                                                     *
+     *          The y-coordinate of the input point.                          *
+     *      index (std::size_t &):                                            *
+     *          Output, the integer x + y*width for the pixel (x, y).         *
+     *  Outputs:                                                              *
+     *      inside (bool):                                                    *
+     *          True if the point lands on the image, false otherwise.        *
+     *  Notes:                                                                *
+     *      Unlike setup::point_to_pixel this checks the bounds, since an     *
+     *      arbitrary IFS may wander outside of the image. The comparisons    *
+     *      are written so that NaN is also rejected.                         *
+     **************************************************************************/
+    inline bool
+    view::point_to_pixel(double xpt, double ypt, std::size_t &index) const
+    {
+        const double xpx = xshift + xscale*xpt;
+        const double ypx = yshift + yscale*ypt;
+
+        if (!(xpx >= 0.0 && xpx < static_cast<double>(xsize)))
+            return false;
+
+        if (!(ypx >= 0.0 && ypx < static_cast<double>(ysize)))
+            return false;
+
+        index = static_cast<std::size_t>(xpx) +
+                static_cast<std::size_t>(ypx) * xsize;
+
+        return true;
+    }
+
+    /*  Same as point_to_pixel, for callers that split the image into tiles.  */
+    inline bool
+    view::point_to_cell(double xpt, double ypt,
+                        unsigned int &col, unsigned int &row) const
+    {
+        const double xpx = xshift + xscale*xpt;
+        const double ypx = yshift + yscale*ypt;
+
+        if (!(xpx >= 0.0 && xpx < static_cast<double>(xsize)))
+            return false;
+
+        if (!(ypx >= 0.0 && ypx < static_cast<double>(ysize)))
+            return false;
+
+        col = static_cast<unsigned int>(xpx);
+        row = static_cast<unsigned int>(ypx);
+        return true;
+    }
+}
+/*  End of namespace "bf".                                                    */
+
+#endif
+/*  End of include guard.                                                     */